@@ -0,0 +1,323 @@
+#include "modulo.h"
+#include <time.h>
+
+// ================================================ BENCHMARK ==========================================================
+
+// Compilar:
+// gcc benchmark.c impressao.c input.c interface.c memoria.c movimento.c paralelo.c historico.c previsao.c eventos.c simulacao.c lote.c metricas.c identificadores.c trajetorias.c estado.c saida.c -O2 -Wall -Wextra -g -Wvla -Wpedantic -Wdeclaration-after-statement -lm -lpthread -o benchmark
+
+// Exemplo
+// ./benchmark --barcos=2000 --densidade=0.02 --frames=1000 --historico=delta
+
+#define REPETICOES_MAXIMAS 64  // Número máximo de repetições de cada medição
+
+static const char nomesBarcos[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+
+/**
+ * @brief Devolve o número seguinte do gerador pseudo-aleatório (xorshift64*).
+ *
+ * O gerador é próprio para que o mesmo cenário seja gerado em qualquer sistema.
+ *
+ * @param estado Estado do gerador (não pode ser 0).
+ * @return Número pseudo-aleatório de 32 bits.
+ */
+static unsigned int aleatorio(unsigned long long *estado) {
+    *estado ^= *estado >> 12;
+    *estado ^= *estado << 25;
+    *estado ^= *estado >> 27;
+    return (unsigned int) ((*estado * 2685821657736338717ULL) >> 32);
+}
+
+/**
+ * @brief Devolve o instante atual em milissegundos (relógio monotónico).
+ */
+static double agoraMs(void) {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000.0 + t.tv_nsec / 1000000.0;
+}
+
+/**
+ * @brief Compara dois tempos (usada com qsort).
+ */
+static int compararTempos(const void *a, const void *b) {
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Ordena os tempos das repetições e devolve a mediana.
+ *
+ * @param tempos Tempos medidos, em milissegundos (ficam ordenados).
+ * @param n Número de tempos.
+ * @return Mediana dos tempos.
+ */
+static double medianaTempos(double *tempos, int n) {
+    qsort(tempos, (size_t) n, sizeof(double), compararTempos);
+    return n % 2 ? tempos[n / 2] : (tempos[n / 2 - 1] + tempos[n / 2]) / 2.0;
+}
+
+/**
+ * @brief Interpreta a distribuição de tipos "tipo:peso,tipo:peso,...".
+ *
+ * Os tipos que não aparecem ficam com peso 0.
+ *
+ * @param valor Texto da opção.
+ * @param cenario Cenário cujos pesos são preenchidos.
+ */
+static void lerPesosTipos(const char *valor, ConfigCenario *cenario) {
+    int tipo, peso, lidos;
+    int total = 0;
+
+    memset(cenario->pesosTipos, 0, sizeof(cenario->pesosTipos));
+    while (sscanf(valor, "%d:%d%n", &tipo, &peso, &lidos) == 2) {
+        if (tipo < 1 || tipo > 13 || peso < 0) {
+            fprintf(stderr, "Distribuição de tipos inválida: tipos de 1 a 13 e pesos >= 0\n");
+            exit(1);
+        }
+        cenario->pesosTipos[tipo] = peso;
+        total += peso;
+        valor += lidos;
+        if (*valor == ',')
+            valor++;
+    }
+
+    if (*valor != '\0' || total == 0) {
+        fprintf(stderr, "Distribuição de tipos inválida: deve ser no formato tipo:peso,tipo:peso,...\n");
+        exit(1);
+    }
+}
+
+/**
+ * @brief Gera um cenário sintético e escreve-o no formato do ficheiro de entrada (antes.txt).
+ *
+ * Cada barco tem um tipo sorteado com os pesos do cenário, uma posição livre da grelha, um ângulo
+ * múltiplo de 45 e uma velocidade uniforme entre a mínima e a máxima. Os primeiros barcos têm
+ * indicativos de uma letra, como nos ficheiros de exemplo, e os seguintes "N<número>", para que
+ * todos os indicativos sejam diferentes. Se as dimensões da grelha não forem dadas, a grelha é
+ * quadrada e com o lado necessário para a densidade pedida.
+ *
+ * @param ficheiro Caminho do ficheiro a escrever.
+ * @param cenario Parâmetros do cenário (as dimensões calculadas são guardadas aqui).
+ */
+static void gerarCenario(const char *ficheiro, ConfigCenario *cenario) {
+    unsigned long long estado = cenario->semente * 0x9E3779B97F4A7C15ULL + 1;
+    unsigned char *ocupada;
+    int pesoTotal = 0;
+    FILE *fp;
+
+    if (cenario->linhas <= 0 || cenario->colunas <= 0) {
+        int lado = (int) ceil(sqrt(cenario->barcos / cenario->densidade));
+        cenario->linhas = lado > 0 ? lado : 1;
+        cenario->colunas = cenario->linhas;
+    }
+    if ((long long) cenario->linhas * cenario->colunas < cenario->barcos) {
+        fprintf(stderr, "A grelha %dx%d não tem espaço para %d barcos\n", cenario->linhas, cenario->colunas,
+                cenario->barcos);
+        exit(1);
+    }
+
+    for (int t = 1; t <= 13; t++)
+        pesoTotal += cenario->pesosTipos[t];
+
+    ocupada = calloc((size_t) cenario->linhas * cenario->colunas, 1);
+    fp = fopen(ficheiro, "w");
+    if (ocupada == NULL || fp == NULL) {
+        perror("Erro ao gerar o cenário");
+        exit(1);
+    }
+
+    for (int i = 0; i < cenario->barcos; i++) {
+        int sorteio = (int) (aleatorio(&estado) % (unsigned int) pesoTotal);
+        int amplitude = cenario->velocidadeMaxima - cenario->velocidadeMinima + 1;
+        int tipo = 1;
+        int lat, lon, angulo, velocidade;
+
+        // Tipo segundo os pesos
+        while (sorteio >= cenario->pesosTipos[tipo]) {
+            sorteio -= cenario->pesosTipos[tipo];
+            tipo++;
+        }
+
+        // Posição ainda não ocupada
+        do {
+            lat = (int) (aleatorio(&estado) % (unsigned int) cenario->linhas);
+            lon = (int) (aleatorio(&estado) % (unsigned int) cenario->colunas);
+        } while (ocupada[(size_t) lat * cenario->colunas + lon]);
+        ocupada[(size_t) lat * cenario->colunas + lon] = 1;
+
+        angulo = 45 * (int) (aleatorio(&estado) % 8);
+        velocidade = cenario->velocidadeMinima + (int) (aleatorio(&estado) % (unsigned int) amplitude);
+
+        if (i < (int) sizeof(nomesBarcos) - 1)
+            fprintf(fp, "%c", nomesBarcos[i]);
+        else
+            fprintf(fp, "N%d", i);
+        fprintf(fp, " %d %d %d %d %d\n", lat, lon, angulo, velocidade, tipo);
+    }
+
+    fclose(fp);
+    free(ocupada);
+}
+
+/**
+ * @brief Programa de medição do desempenho do simulador com cenários sintéticos.
+ *
+ * Gera um cenário (ver gerarCenario), e em cada repetição carrega-o tal como o programa principal
+ * e mede:
+ * - ler: lerFicheiroInicial do cenário gerado;
+ * - prever: previsaoDeColisoes a partir do frame inicial;
+ * - avancar: avancarFrame de uma só vez até ao número de frames pedido;
+ * - passo: avancarFrame de 1 frame, repetido várias vezes (sem saltos diretos);
+ * - recuar: rewindFrames de um número de frames.
+ *
+ * Os resultados são escritos um por linha, sempre pela mesma ordem, no formato "medida chave=valor ...":
+ * primeiro os valores que não dependem do tempo (frames atingidos, barcos e colisões), que devem ser
+ * iguais entre versões, e no fim a menor e a mediana dos tempos das repetições.
+ *
+ * Opções (--nome=valor): barcos, grelha (LxC), densidade (barcos por casa), tipos (tipo:peso,...),
+ * velocidade (MIN-MAX), semente, frames, passos, recuo, repeticoes, cenario (ficheiro gerado) e as
+ * opções do histórico do programa principal.
+ *
+ * @param argc Número de argumentos recebidos na linha de comandos.
+ * @param argv Vetor de strings com os argumentos da linha de comandos.
+ * @return int Código de saída (0 em caso de sucesso).
+ */
+int main(int argc, char *argv[]) {
+    ConfigCenario cenario = {.barcos = 500, .densidade = 0.01, .velocidadeMinima = 0, .velocidadeMaxima = 3,
+                             .semente = 1};
+    ConfigHistorico historico;
+    const char *ficheiro = "cenario.txt";
+    const char *nomesHistorico[] = {"completo", "delta", "checkpoint", "anel"};
+    int frames = 1000, passos = 100, recuo = -1, repeticoes = 3;
+    double tempos[5][REPETICOES_MAXIMAS], mediana[5];
+    int frameAvanco = 0, barcosAvanco = 0, colisoes = 0, frameRecuo = 0;
+
+    for (int t = 1; t <= 13; t++)
+        cenario.pesosTipos[t] = 1;
+    iniciarConfigHistorico(&historico);
+
+    for (int i = 1; i < argc; i++) {
+        const char *valor;
+
+        if (lerOpcaoHistorico(argv[i], &historico)) {
+            // Opção do histórico, já interpretada
+        } else if ((valor = valorOpcao(argv[i], "barcos")) != NULL) {
+            cenario.barcos = atoi(valor);
+        } else if ((valor = valorOpcao(argv[i], "grelha")) != NULL) {
+            if (sscanf(valor, "%dx%d", &cenario.linhas, &cenario.colunas) != 2 ||
+                cenario.linhas <= 0 || cenario.colunas <= 0) {
+                fprintf(stderr, "Grelha inválida: deve ser no formato <linhas>x<colunas>\n");
+                exit(1);
+            }
+        } else if ((valor = valorOpcao(argv[i], "densidade")) != NULL) {
+            cenario.densidade = atof(valor);
+        } else if ((valor = valorOpcao(argv[i], "tipos")) != NULL) {
+            lerPesosTipos(valor, &cenario);
+        } else if ((valor = valorOpcao(argv[i], "velocidade")) != NULL) {
+            int lidos = sscanf(valor, "%d-%d", &cenario.velocidadeMinima, &cenario.velocidadeMaxima);
+            if (lidos == 1)
+                cenario.velocidadeMaxima = cenario.velocidadeMinima;
+            if (lidos < 1 || cenario.velocidadeMinima < 0 || cenario.velocidadeMaxima < cenario.velocidadeMinima) {
+                fprintf(stderr, "Velocidade inválida: deve ser no formato <minima>-<maxima>\n");
+                exit(1);
+            }
+        } else if ((valor = valorOpcao(argv[i], "semente")) != NULL) {
+            cenario.semente = strtoull(valor, NULL, 10);
+        } else if ((valor = valorOpcao(argv[i], "frames")) != NULL) {
+            frames = atoi(valor);
+        } else if ((valor = valorOpcao(argv[i], "passos")) != NULL) {
+            passos = atoi(valor);
+        } else if ((valor = valorOpcao(argv[i], "recuo")) != NULL) {
+            recuo = atoi(valor);
+        } else if ((valor = valorOpcao(argv[i], "repeticoes")) != NULL) {
+            repeticoes = atoi(valor);
+        } else if ((valor = valorOpcao(argv[i], "cenario")) != NULL) {
+            ficheiro = valor;
+        } else {
+            fprintf(stderr, "Opção desconhecida: %s\n", argv[i]);
+            exit(1);
+        }
+    }
+
+    if (cenario.barcos <= 0 || cenario.densidade <= 0 || frames < 0 || passos < 0 ||
+        repeticoes < 1 || repeticoes > REPETICOES_MAXIMAS) {
+        fprintf(stderr, "Parâmetros inválidos: barcos > 0, densidade > 0, frames >= 0, passos >= 0 e "
+                        "1 <= repeticoes <= %d\n", REPETICOES_MAXIMAS);
+        exit(1);
+    }
+    if (recuo < 0)
+        recuo = (frames + passos) / 2;
+
+    gerarCenario(ficheiro, &cenario);
+
+    printf("cenario barcos=%d grelha=%dx%d velocidade=%d-%d semente=%llu tipos=", cenario.barcos,
+           cenario.linhas, cenario.colunas, cenario.velocidadeMinima, cenario.velocidadeMaxima, cenario.semente);
+    for (int t = 1, primeiro = 1; t <= 13; t++) {
+        if (cenario.pesosTipos[t] > 0) {
+            printf("%s%d:%d", primeiro ? "" : ",", t, cenario.pesosTipos[t]);
+            primeiro = 0;
+        }
+    }
+    printf(" historico=%s repeticoes=%d\n", nomesHistorico[historico.modo], repeticoes);
+
+    for (int r = 0; r < repeticoes; r++) {
+        RegistoNavios registoNavios = {0};
+        BaseDados frameInicial = {.frame_atual_num = 0, .registo = &registoNavios};
+        ListaFrames listaFrames = {0};
+        BaseDados *frameAtual = &frameInicial;
+        double inicio;
+
+        listaFrames.config = historico;
+
+        inicio = agoraMs();
+        lerFicheiroInicial(ficheiro, &frameInicial);
+        tempos[4][r] = agoraMs() - inicio;
+        iniciarHistorico(&listaFrames, &frameInicial, cenario.linhas, cenario.colunas);
+
+        inicio = agoraMs();
+        colisoes = previsaoDeColisoes(frameAtual, cenario.linhas, cenario.colunas, SAIDA_NENHUMA);
+        tempos[2][r] = agoraMs() - inicio;
+
+        inicio = agoraMs();
+        avancarFrame(&frameAtual, &listaFrames, frames, cenario.linhas, cenario.colunas, 0);
+        tempos[0][r] = agoraMs() - inicio;
+        frameAvanco = frameAtual->frame_atual_num;
+        barcosAvanco = frameAtual->barcos.total;
+
+        inicio = agoraMs();
+        for (int p = 0; p < passos; p++)
+            avancarFrame(&frameAtual, &listaFrames, 1, cenario.linhas, cenario.colunas, 0);
+        tempos[1][r] = agoraMs() - inicio;
+
+        inicio = agoraMs();
+        rewindFrames(&frameAtual, &listaFrames, recuo, 0);
+        tempos[3][r] = agoraMs() - inicio;
+        frameRecuo = frameAtual->frame_atual_num;
+
+        // Liberta tudo como no fim do programa principal
+        rewindFrames(&frameAtual, &listaFrames, frameAtual->frame_atual_num, 0);
+        libertarHistorico(&listaFrames);
+        limparFrameInicial(&frameInicial);
+    }
+
+    // Tempos ordenados: o primeiro é o menor
+    for (int m = 0; m < 5; m++)
+        mediana[m] = medianaTempos(tempos[m], repeticoes);
+
+    printf("ler barcos=%d min_ms=%.3f mediana_ms=%.3f\n", cenario.barcos, tempos[4][0], mediana[4]);
+    printf("prever colisoes=%d min_ms=%.3f mediana_ms=%.3f\n", colisoes, tempos[2][0], mediana[2]);
+    printf("avancar frames=%d frame_final=%d barcos_final=%d min_ms=%.3f mediana_ms=%.3f frames_s=%.1f\n",
+           frames, frameAvanco, barcosAvanco, tempos[0][0], mediana[0], frames * 1000.0 / (tempos[0][0] + 1e-9));
+    printf("passo frames=%d min_ms=%.3f mediana_ms=%.3f frames_s=%.1f\n",
+           passos, tempos[1][0], mediana[1], passos * 1000.0 / (tempos[1][0] + 1e-9));
+    printf("recuar frames=%d frame_final=%d min_ms=%.3f mediana_ms=%.3f\n",
+           recuo, frameRecuo, tempos[3][0], mediana[3]);
+
+    terminarThreads();
+    libertarArenas();
+
+    return 0;
+}
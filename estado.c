@@ -0,0 +1,362 @@
+#include "modulo.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ================================================ ESTADO =============================================================
+
+/*
+ * Ficheiros de estado: o registo de navios, os frames e o índice de trajetórias em binário, tal
+ * como estão em memória (inteiros com a ordem de bytes da máquina). Todas as secções têm tamanho
+ * múltiplo de 4 bytes, para que os arrays possam ser lidos diretamente do ficheiro mapeado.
+ */
+
+/**
+ * @brief Escreve um array no ficheiro de estado; um array vazio pode não ter sido alocado.
+ *
+ * @param dados Início do array (pode ser NULL se 'n' for 0).
+ * @param tamanho Tamanho de cada elemento.
+ * @param n Número de elementos.
+ * @param fp Ficheiro de estado.
+ */
+static void escreverArray(const void *dados, size_t tamanho, size_t n, FILE *fp) {
+    if (n > 0)
+        fwrite(dados, tamanho, n, fp);
+}
+
+/**
+ * @brief Escreve um frame no ficheiro de estado: o cabeçalho e os arrays das entidades.
+ *
+ * É usada diretamente e como VisitaFrame (ver percorrerHistorico).
+ *
+ * @param frame Frame a escrever.
+ * @param contexto EscritaEstado do ficheiro.
+ */
+static void escreverFrameEstado(BaseDados *frame, void *contexto) {
+    EscritaEstado *escrita = contexto;
+    EntidadesIED *barcos = &frame->barcos;
+    CabecalhoFrameEstado cabecalho = {frame->frame_atual_num, barcos->total, frame->alterado, 0};
+    size_t bytes = (size_t) barcos->total * sizeof(int);
+    static const unsigned char zeros[4] = {0};
+
+    fwrite(&cabecalho, sizeof(cabecalho), 1, escrita->fp);
+    escreverArray(barcos->posX, 1, bytes, escrita->fp);
+    escreverArray(barcos->posY, 1, bytes, escrita->fp);
+    escreverArray(barcos->velX, 1, bytes, escrita->fp);
+    escreverArray(barcos->velY, 1, bytes, escrita->fp);
+    escreverArray(barcos->navio, 1, bytes, escrita->fp);
+    escreverArray(barcos->flags, 1, (size_t) barcos->total, escrita->fp);
+    escreverArray(zeros, 1, (size_t) (-barcos->total & 3), escrita->fp);
+    escrita->numFrames++;
+}
+
+/**
+ * @brief Guarda o estado da simulação num ficheiro binário, para ser retomado com carregarEstado.
+ *
+ * O ficheiro tem as dimensões da grelha, a configuração do histórico, o registo de navios (identidades
+ * e navios), os frames e o índice de trajetórias. As entidades são guardadas sem conversões, pelo que
+ * as velocidades e a visibilidade dos submarinos se mantêm exatas.
+ *
+ * Com 'comHistorico', são guardados todos os frames do histórico, para que seja possível recuar depois
+ * de carregar o estado: no modo completo os frames guardados em memória, nos modos delta e de pontos
+ * de controlo todos os frames (reconstruídos um a um) e no modo anel o frame 0 e os frames do anel.
+ * Sem histórico são guardados apenas o frame 0 e o frame atual.
+ *
+ * @param ficheiro Caminho do ficheiro a escrever (é substituído).
+ * @param listaFrames Histórico de frames (o frame atual é o último).
+ * @param comHistorico 1 para guardar todos os frames do histórico, 0 para guardar só o frame 0 e o atual.
+ * @return 1 se o estado foi guardado, 0 em caso de erro (indicado no stderr).
+ */
+int guardarEstado(const char *ficheiro, ListaFrames *listaFrames, int comHistorico) {
+    RegistoNavios *registo = listaFrames->head->registo;
+    IndiceTrajetorias *trajetorias = &listaFrames->trajetorias;
+    CabecalhoEstado cabecalho;
+    EscritaEstado escrita;
+    int erro;
+
+    escrita.fp = fopen(ficheiro, "wb");
+    escrita.numFrames = 0;
+    if (escrita.fp == NULL) {
+        perror("Erro ao abrir o ficheiro do estado");
+        return 0;
+    }
+
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.assinatura, ASSINATURA_ESTADO, sizeof(cabecalho.assinatura));
+    cabecalho.versao = VERSAO_ESTADO;
+    cabecalho.ordem = ORDEM_ESTADO;
+    cabecalho.opcoes = comHistorico ? ESTADO_COM_HISTORICO : 0;
+    cabecalho.latitudeMax = listaFrames->latitudeMax;
+    cabecalho.longitudeMax = listaFrames->longitudeMax;
+    cabecalho.modo = listaFrames->config.modo;
+    cabecalho.intervalo = listaFrames->config.intervalo;
+    cabecalho.profundidade = listaFrames->config.profundidade;
+    cabecalho.memoriaMaxima = listaFrames->config.memoriaMaxima;
+    cabecalho.totalIds = registo->totalIds;
+    cabecalho.totalNavios = registo->total;
+    cabecalho.idsTrajetorias = trajetorias->capacidadeIds;
+    cabecalho.numSegmentos = trajetorias->numSegmentos;
+    cabecalho.segmentoLivre = trajetorias->livre;
+    cabecalho.ultimoFrameTrajetorias = trajetorias->ultimoFrame;
+
+    // O número de frames só é conhecido no fim: o cabeçalho volta a ser escrito
+    fwrite(&cabecalho, sizeof(cabecalho), 1, escrita.fp);
+    escreverArray(registo->identidades, sizeof(IdentidadeNavio), registo->totalIds, escrita.fp);
+    escreverArray(registo->navios, sizeof(NoVessel), (size_t) registo->total, escrita.fp);
+
+    if (!comHistorico) {
+        escreverFrameEstado(listaFrames->head, &escrita);
+        if (listaFrames->tail != listaFrames->head)
+            escreverFrameEstado(listaFrames->tail, &escrita);
+    } else if (listaFrames->config.modo == HISTORICO_COMPLETO) {
+        // Só os frames em memória: os implícitos voltam a ser simulados depois de carregar
+        for (BaseDados *frame = listaFrames->head; frame != NULL; frame = frame->next)
+            escreverFrameEstado(frame, &escrita);
+    } else {
+        percorrerHistorico(listaFrames, escreverFrameEstado, &escrita);
+    }
+
+    escreverArray(trajetorias->primeiro, sizeof(int), trajetorias->capacidadeIds, escrita.fp);
+    escreverArray(trajetorias->ultimo, sizeof(int), trajetorias->capacidadeIds, escrita.fp);
+    escreverArray(trajetorias->segmentos, sizeof(SegmentoTrajetoria), (size_t) trajetorias->numSegmentos, escrita.fp);
+
+    cabecalho.numFrames = escrita.numFrames;
+    if (fseek(escrita.fp, 0, SEEK_SET) == 0)
+        fwrite(&cabecalho, sizeof(cabecalho), 1, escrita.fp);
+
+    erro = ferror(escrita.fp);
+    if (fclose(escrita.fp) != 0)
+        erro = 1;
+    if (erro) {
+        perror("Erro ao escrever o ficheiro do estado");
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Indica que o ficheiro de estado não pode ser carregado e termina o programa.
+ *
+ * @param ficheiro Caminho do ficheiro.
+ * @param motivo Descrição do problema.
+ */
+static void erroEstado(const char *ficheiro, const char *motivo) {
+    fprintf(stderr, "Ficheiro de estado \"%s\" inválido: %s\n", ficheiro, motivo);
+    exit(1);
+}
+
+/**
+ * @brief Devolve a próxima secção do ficheiro mapeado, com 'n' elementos de 'tamanho' bytes, e avança.
+ *
+ * Se o ficheiro terminar antes do fim da secção, termina o programa com erro.
+ *
+ * @param p Posição atual no ficheiro (é avançada).
+ * @param fim Fim do ficheiro.
+ * @param n Número de elementos.
+ * @param tamanho Tamanho de cada elemento, em bytes.
+ * @param ficheiro Caminho do ficheiro (para a mensagem de erro).
+ * @return Início da secção.
+ */
+static const void *lerSeccao(const char **p, const char *fim, size_t n, size_t tamanho, const char *ficheiro) {
+    const char *seccao = *p;
+
+    if (tamanho > 0 && n > (size_t) (fim - seccao) / tamanho)
+        erroEstado(ficheiro, "ficheiro incompleto");
+
+    *p += n * tamanho;
+    return seccao;
+}
+
+/**
+ * @brief Lê os arrays das entidades de um frame do ficheiro mapeado e copia-os para o frame.
+ *
+ * @param frame Frame de destino (sem entidades).
+ * @param total Número de entidades.
+ * @param p Posição atual no ficheiro (é avançada).
+ * @param fim Fim do ficheiro.
+ * @param ficheiro Caminho do ficheiro.
+ */
+static void lerEntidadesEstado(BaseDados *frame, int total, const char **p, const char *fim, const char *ficheiro) {
+    EntidadesIED *barcos = &frame->barcos;
+    size_t bytes = (size_t) total * sizeof(int);
+    const int *navio;
+
+    barcos->total = 0;
+    if (total == 0)
+        return;
+
+    reservarEntidades(frame, total);
+    memcpy(barcos->posX, lerSeccao(p, fim, (size_t) total, sizeof(int), ficheiro), bytes);
+    memcpy(barcos->posY, lerSeccao(p, fim, (size_t) total, sizeof(int), ficheiro), bytes);
+    memcpy(barcos->velX, lerSeccao(p, fim, (size_t) total, sizeof(int), ficheiro), bytes);
+    memcpy(barcos->velY, lerSeccao(p, fim, (size_t) total, sizeof(int), ficheiro), bytes);
+
+    navio = lerSeccao(p, fim, (size_t) total, sizeof(int), ficheiro);
+    for (int i = 0; i < total; i++) {
+        if (navio[i] < 0 || navio[i] >= frame->registo->total)
+            erroEstado(ficheiro, "entidade com um navio inexistente");
+    }
+    memcpy(barcos->navio, navio, bytes);
+
+    memcpy(barcos->flags, lerSeccao(p, fim, (size_t) total, 1, ficheiro), (size_t) total);
+    lerSeccao(p, fim, (size_t) (-total & 3), 1, ficheiro);
+    barcos->total = total;
+}
+
+/**
+ * @brief Verifica que um índice de segmento guardado é -1 ou um segmento existente.
+ */
+static void validarSegmento(int segmento, int numSegmentos, const char *ficheiro) {
+    if (segmento < -1 || segmento >= numSegmentos)
+        erroEstado(ficheiro, "trajetorias corrompidas");
+}
+
+/**
+ * @brief Retoma uma simulação a partir de um ficheiro escrito por guardarEstado.
+ *
+ * O ficheiro é mapeado em memória e os arrays são copiados diretamente para os frames, sem
+ * voltar a simular. O registo de navios é reconstruído com os mesmos ids e índices, o frame 0 é
+ * preenchido e o histórico é iniciado com a configuração guardada; os frames seguintes são
+ * acrescentados ao histórico por ordem, como se acabassem de ser calculados. Por fim, o índice de
+ * trajetórias é substituído pelo guardado.
+ *
+ * Se o ficheiro não tiver o histórico, o frame atual é acrescentado logo a seguir ao frame 0 e a
+ * sessão continua com o histórico em anel: os frames intermédios não existem, e um recuo para um
+ * deles fica no frame mais antigo ainda no anel (ver primeiroFrameRecuperavel); só um recuo até
+ * ao frame 0 chega ao frame 0.
+ *
+ * As opções do histórico da linha de comandos são substituídas pelas do ficheiro. Um ficheiro
+ * inválido ou incompleto termina o programa com erro.
+ *
+ * @param ficheiro Caminho do ficheiro de estado.
+ * @param frameInicial Frame 0 (vazio, com um registo de navios vazio).
+ * @param listaFrames Histórico a iniciar.
+ * @param latitudeMax Onde é escrito o número de linhas da grelha.
+ * @param longitudeMax Onde é escrito o número de colunas da grelha.
+ * @return O frame atual da simulação retomada.
+ */
+BaseDados *carregarEstado(const char *ficheiro, BaseDados *frameInicial, ListaFrames *listaFrames,
+                          int *latitudeMax, int *longitudeMax) {
+    RegistoNavios *registo = frameInicial->registo;
+    const CabecalhoEstado *cabecalho;
+    const IdentidadeNavio *identidades;
+    const NoVessel *navios;
+    IndiceTrajetorias guardado;
+    struct stat info;
+    const char *dados;
+    const char *p, *fim;
+    size_t tamanho;
+    int fd = open(ficheiro, O_RDONLY);
+
+    if (fd == -1 || fstat(fd, &info) == -1) {
+        printf("\nErro ao abrir ficheiro \"%s\"\n", ficheiro);
+        exit(1);
+    }
+
+    tamanho = (size_t) info.st_size;
+    if (tamanho < sizeof(CabecalhoEstado))
+        erroEstado(ficheiro, "ficheiro incompleto");
+
+    dados = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (dados == MAP_FAILED) {
+        perror("Erro ao mapear o ficheiro do estado");
+        exit(1);
+    }
+    close(fd);
+    p = dados;
+    fim = dados + tamanho;
+
+    // Cabeçalho
+    cabecalho = lerSeccao(&p, fim, 1, sizeof(CabecalhoEstado), ficheiro);
+    if (memcmp(cabecalho->assinatura, ASSINATURA_ESTADO, sizeof(cabecalho->assinatura)) != 0)
+        erroEstado(ficheiro, "não é um ficheiro de estado");
+    if (cabecalho->ordem != ORDEM_ESTADO)
+        erroEstado(ficheiro, "escrito numa máquina com outra ordem de bytes");
+    if (cabecalho->versao != VERSAO_ESTADO)
+        erroEstado(ficheiro, "versão do formato não suportada");
+    if (cabecalho->latitudeMax <= 0 || cabecalho->longitudeMax <= 0 || cabecalho->numFrames < 1 ||
+        cabecalho->totalNavios < 0 || cabecalho->modo < HISTORICO_COMPLETO || cabecalho->modo > HISTORICO_ANEL)
+        erroEstado(ficheiro, "cabeçalho inválido");
+
+    // Registo de navios: as identidades são registadas pela mesma ordem, para manterem os ids
+    identidades = lerSeccao(&p, fim, cabecalho->totalIds, sizeof(IdentidadeNavio), ficheiro);
+    reservarIdsNavios(registo, cabecalho->totalIds);
+    for (unsigned int id = 0; id < cabecalho->totalIds; id++) {
+        const char *indicativo = identidades[id].indicativo;
+
+        if (indicativo[0] == '\0' || memchr(indicativo, '\0', TAMANHO_INDICATIVO) == NULL ||
+            obterIdNavio(registo, indicativo) != id)
+            erroEstado(ficheiro, "indicativos inválidos ou repetidos");
+    }
+
+    navios = lerSeccao(&p, fim, (size_t) cabecalho->totalNavios, sizeof(NoVessel), ficheiro);
+    for (int n = 0; n < cabecalho->totalNavios; n++) {
+        if (navios[n].id >= cabecalho->totalIds)
+            erroEstado(ficheiro, "navio com um id inexistente");
+        registarNavio(registo, navios[n].id, navios[n].tipologia, navios[n].frame);
+    }
+
+    // Configuração do histórico: sem os frames intermédios, só o anel a consegue representar
+    iniciarConfigHistorico(&listaFrames->config);
+    if (cabecalho->opcoes & ESTADO_COM_HISTORICO) {
+        listaFrames->config.modo = (ModoHistorico) cabecalho->modo;
+        listaFrames->config.intervalo = cabecalho->intervalo;
+        listaFrames->config.memoriaMaxima = (size_t) cabecalho->memoriaMaxima;
+        listaFrames->config.profundidade = cabecalho->profundidade;
+    } else {
+        listaFrames->config.modo = HISTORICO_ANEL;
+        if (cabecalho->modo == HISTORICO_ANEL)
+            listaFrames->config.profundidade = cabecalho->profundidade;
+    }
+
+    // Frames, do frame 0 ao atual
+    for (int k = 0; k < cabecalho->numFrames; k++) {
+        const CabecalhoFrameEstado *cabecalhoFrame = lerSeccao(&p, fim, 1, sizeof(CabecalhoFrameEstado), ficheiro);
+        BaseDados *frame;
+
+        if (cabecalhoFrame->total < 0 || (k == 0 && cabecalhoFrame->numero != 0) ||
+            (k > 0 && cabecalhoFrame->numero <= listaFrames->tail->frame_atual_num))
+            erroEstado(ficheiro, "frames inválidos");
+
+        frame = k == 0 ? frameInicial : novoFrameHistorico(listaFrames, listaFrames->tail, cabecalhoFrame->total);
+        frame->frame_atual_num = cabecalhoFrame->numero;
+        frame->alterado = cabecalhoFrame->alterado;
+        lerEntidadesEstado(frame, cabecalhoFrame->total, &p, fim, ficheiro);
+
+        if (k == 0)
+            iniciarHistorico(listaFrames, frameInicial, cabecalho->latitudeMax, cabecalho->longitudeMax);
+        else
+            acrescentarFrame(listaFrames, frame);
+    }
+
+    // Índice de trajetórias, tal como estava quando o estado foi guardado
+    memset(&guardado, 0, sizeof(guardado));
+    guardado.capacidadeIds = cabecalho->idsTrajetorias;
+    guardado.primeiro = (int *) lerSeccao(&p, fim, cabecalho->idsTrajetorias, sizeof(int), ficheiro);
+    guardado.ultimo = (int *) lerSeccao(&p, fim, cabecalho->idsTrajetorias, sizeof(int), ficheiro);
+    if (cabecalho->numSegmentos < 0)
+        erroEstado(ficheiro, "trajetorias corrompidas");
+    guardado.segmentos = (SegmentoTrajetoria *) lerSeccao(&p, fim, (size_t) cabecalho->numSegmentos,
+                                                          sizeof(SegmentoTrajetoria), ficheiro);
+    guardado.numSegmentos = cabecalho->numSegmentos;
+    guardado.livre = cabecalho->segmentoLivre;
+    guardado.ultimoFrame = cabecalho->ultimoFrameTrajetorias;
+
+    validarSegmento(guardado.livre, guardado.numSegmentos, ficheiro);
+    for (unsigned int id = 0; id < guardado.capacidadeIds; id++) {
+        validarSegmento(guardado.primeiro[id], guardado.numSegmentos, ficheiro);
+        validarSegmento(guardado.ultimo[id], guardado.numSegmentos, ficheiro);
+    }
+    for (int s = 0; s < guardado.numSegmentos; s++)
+        validarSegmento(guardado.segmentos[s].anterior, guardado.numSegmentos, ficheiro);
+    restaurarTrajetorias(&listaFrames->trajetorias, &guardado);
+
+    if (p != fim)
+        erroEstado(ficheiro, "dados a mais no fim do ficheiro");
+
+    *latitudeMax = cabecalho->latitudeMax;
+    *longitudeMax = cabecalho->longitudeMax;
+    munmap((void *) dados, tamanho);
+    return listaFrames->tail;
+}
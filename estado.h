@@ -0,0 +1,17 @@
+#ifndef ESTADO_H
+#define ESTADO_H
+
+// ================================================ ESTADO =============================================================
+
+/**
+ * @brief Guarda o estado da simulação num ficheiro binário. Retorna 0 em caso de erro.
+ */
+int guardarEstado(const char *ficheiro, ListaFrames *listaFrames, int comHistorico);
+
+/**
+ * @brief Retoma uma simulação guardada com guardarEstado. Retorna o frame atual.
+ */
+BaseDados *carregarEstado(const char *ficheiro, BaseDados *frameInicial, ListaFrames *listaFrames,
+                          int *latitudeMax, int *longitudeMax);
+
+#endif //ESTADO_H
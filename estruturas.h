@@ -3,29 +3,157 @@
 
 // ================================================ ESTRUTURAS =========================================================
 
+/** @brief Tamanho máximo do indicativo de um barco, incluindo o '\0'. */
+#define TAMANHO_INDICATIVO 16
+
 /**
  * @brief Estrutura que representa um navio.
  *
- * Cada navio é identificado por um nome (caractere), tem uma tipologia (número identificador)
- * e um indicador de visibilidade no radar (utilizado para o submarino).
+ * Cada navio é identificado por um id de 32 bits (ver IdentidadeNavio) e tem uma tipologia
+ * (número identificador). O mesmo barco pode ter vários navios no registo, um por cada tipo
+ * que teve, todos com o mesmo id.
+ * A visibilidade no radar (utilizada para o submarino) varia de frame para frame e por isso
+ * é guardada nas flags de cada entidade (ver BARCO_VISIVEL).
  */
 typedef struct NoVessel {
-    char nome;         /**< Identificador único do navio (ex: 'A', 'B') */
+    unsigned int id;   /**< Identificador do barco (índice em RegistoNavios::identidades) */
     int tipologia;     /**< Tipo do navio (ex: cruzador, pescador, etc.) */
-    int isVisible;     /**< Indicador de visibilidade no radar (1 = visível, 0 = invisível) */
+    int frame;         /**< Número do frame em que o navio foi registado */
 } NoVessel;
 
 /**
- * @brief Estrutura que representa a instância de um navio num determinado frame.
+ * @brief Identidade de um barco: o indicativo com que aparece nos ficheiros e no menu.
+ */
+typedef struct IdentidadeNavio {
+    char indicativo[TAMANHO_INDICATIVO]; /**< Indicativo do barco (ex: "A", "CS1234") */
+} IdentidadeNavio;
+
+/**
+ * @brief Registo central de todos os navios conhecidos pela simulação.
  *
- * Esta estrutura liga-se em lista para representar todos os navios num frame específico.
+ * Os navios são guardados num array contíguo e referenciados pelas entidades através
+ * do seu índice, que se mantém estável mesmo quando o array cresce. Os navios só são registados
+ * no frame atual, que é sempre o último, por isso o array fica ordenado pelo frame de registo:
+ * ao recuar, os navios registados depois do novo frame atual já não são referenciados por
+ * nenhum frame e saem do fim do array (ver descartarNaviosFuturos).
+ *
+ * Os ids dos barcos são atribuídos por ordem (0, 1, 2, ...) na primeira vez que um indicativo
+ * aparece, e a tabela de dispersão 'tabelaIds' encontra o id de um indicativo em tempo constante.
+ * O índice 'entidadePorId' dá a entidade de cada id num frame ('frameIndexado'); é reconstruído
+ * na primeira procura num frame diferente (ver procurarEntidade).
+ */
+typedef struct RegistoNavios {
+    NoVessel *navios;            /**< Array de navios */
+    int total;                   /**< Número de navios registados */
+    int capacidade;              /**< Capacidade alocada do array */
+    IdentidadeNavio *identidades; /**< Identidade de cada id */
+    unsigned int totalIds;       /**< Número de ids atribuídos */
+    unsigned int capacidadeIds;  /**< Capacidade alocada de 'identidades' */
+    unsigned int *tabelaIds;     /**< Tabela de dispersão indicativo -> id + 1 (0 = posição livre) */
+    unsigned int capacidadeTabela; /**< Número de posições da tabela (potência de 2) */
+    int *entidadePorId;          /**< Índice da entidade de cada id em 'frameIndexado' (-1 se não está) */
+    unsigned int idsIndexados;   /**< Número de ids cobertos por 'entidadePorId' */
+    unsigned int capacidadeIndice; /**< Capacidade alocada de 'entidadePorId' */
+    const struct BaseDados *frameIndexado; /**< Frame a que corresponde 'entidadePorId' (NULL se nenhum) */
+} RegistoNavios;
+
+/**
+ * @brief Categorias da contabilidade de memória (ver imprimirMemoria).
  */
-typedef struct EntidadeIED {
-    int posicao[2];               /**< Posição do navio no radar (x, y) */
-    int velocidade[2];           /**< Velocidade do navio em cada eixo (vx, vy) */
-    NoVessel *no_nautico;        /**< Ponteiro para a estrutura estática do navio */
-    struct EntidadeIED *seguinte;/**< Ponteiro para a próxima entidade no frame */
-} EntidadeIED;
+typedef enum CategoriaMemoria {
+    MEMORIA_FRAMES,              /**< Estruturas BaseDados dos frames */
+    MEMORIA_ENTIDADES,           /**< Arrays de entidades (EntidadesIED) dos frames e do histórico */
+    MEMORIA_NAVIOS,              /**< Navios (NoVessel), identidades e índices do registo */
+    MEMORIA_COLISOES,            /**< Registos de colisão (Colisao) */
+    MEMORIA_BARCOS_COLISAO,      /**< Barcos de cada colisão (BarcosEmColisao) */
+    MEMORIA_TRAJETORIAS,         /**< Índice de trajetórias do histórico (IndiceTrajetorias) */
+    MEMORIA_ARENAS,              /**< Blocos pedidos ao sistema pelas arenas (inclui as categorias anteriores) */
+    MEMORIA_HISTORICO,           /**< Registos codificados, pontos de controlo e anel do histórico (fora das arenas) */
+    MEMORIA_AUXILIAR,            /**< Encontros da previsão, blocos de leitura e mensagens de saída (fora das arenas) */
+    NUM_CATEGORIAS_MEMORIA
+} CategoriaMemoria;
+
+/**
+ * @brief Bytes vivos e máximos de cada categoria de memória, desde o início do programa.
+ */
+typedef struct ContabilidadeMemoria {
+    long long vivos[NUM_CATEGORIAS_MEMORIA];        /**< Bytes alocados e ainda não libertados */
+    long long pico[NUM_CATEGORIAS_MEMORIA];         /**< Maior valor de 'vivos' */
+    long long alocacoes[NUM_CATEGORIAS_MEMORIA];    /**< Número de alocações */
+    long long inicioAvanco[NUM_CATEGORIAS_MEMORIA]; /**< Bytes vivos no início do último avanço */
+    long long crescimento[NUM_CATEGORIAS_MEMORIA];  /**< Variação dos bytes vivos no último avanço */
+    int framesAvanco;                               /**< Número de frames do último avanço */
+} ContabilidadeMemoria;
+
+/**
+ * @brief Bloco de memória de uma arena. Os dados começam logo a seguir ao cabeçalho.
+ */
+typedef struct BlocoArena {
+    struct BlocoArena *seguinte; /**< Bloco seguinte da arena (mais recente) */
+    size_t capacidade;           /**< Bytes disponíveis para dados neste bloco */
+    size_t usado;                /**< Bytes já entregues neste bloco */
+} BlocoArena;
+
+/**
+ * @brief Arena de memória (bump allocator).
+ *
+ * As alocações avançam um cursor dentro do bloco atual; quando não cabem, passa-se ao
+ * bloco seguinte (reaproveitado ou novo). A memória não é libertada alocação a alocação:
+ * a arena inteira é devolvida de uma vez e reaproveitada por outra.
+ */
+typedef struct Arena {
+    BlocoArena *primeiro;        /**< Primeiro bloco da arena */
+    BlocoArena *atual;           /**< Bloco onde se está a alocar */
+    struct Arena *proximaLivre;  /**< Ligação na lista de arenas livres */
+    size_t bytesCategoria[NUM_CATEGORIAS_MEMORIA]; /**< Bytes alocados na arena por categoria de memória */
+} Arena;
+
+/**
+ * @brief Posição de uma arena, para libertar tudo o que foi alocado depois dela.
+ */
+typedef struct MarcaArena {
+    BlocoArena *bloco;           /**< Bloco atual no momento da marca */
+    size_t usado;                /**< Bytes usados nesse bloco no momento da marca */
+    size_t bytesCategoria[NUM_CATEGORIAS_MEMORIA]; /**< Bytes de cada categoria na arena no momento da marca */
+} MarcaArena;
+
+/** @brief Flag de entidade: o navio está visível no radar neste frame. */
+#define BARCO_VISIVEL 0x01
+
+/**
+ * @brief Estrutura que representa as instâncias dos navios num determinado frame.
+ *
+ * As entidades de um frame são guardadas em formato structure-of-arrays: a entidade i
+ * é descrita pela posição i de cada um dos arrays. Todos os arrays partilham um único
+ * bloco de memória, alocado na arena do frame, para que percorrer um frame seja uma
+ * leitura sequencial.
+ */
+typedef struct EntidadesIED {
+    int *posX;                   /**< Posição dos navios no eixo x (longitude) */
+    int *posY;                   /**< Posição dos navios no eixo y (latitude) */
+    int *velX;                   /**< Velocidade dos navios no eixo x */
+    int *velY;                   /**< Velocidade dos navios no eixo y */
+    int *navio;                  /**< Índice de cada navio no RegistoNavios */
+    unsigned char *flags;        /**< Flags de cada entidade (ex: BARCO_VISIVEL) */
+    int total;                   /**< Número de entidades no frame */
+    int capacidade;              /**< Número de entidades que cabem nos arrays alocados */
+} EntidadesIED;
+
+/**
+ * @brief Grelha espacial uniforme sobre as entidades de um frame.
+ *
+ * O radar é dividido em células quadradas de 'tamanhoCelula' casas. Os índices das entidades
+ * são agrupados por célula (ordenação por contagem), pelo que os barcos da célula c são
+ * indices[inicioCelula[c]] .. indices[inicioCelula[c + 1] - 1], por ordem crescente de índice.
+ * Entidades fora do radar ficam na célula mais próxima da borda.
+ */
+typedef struct GrelhaEspacial {
+    int tamanhoCelula;           /**< Lado de cada célula, em casas */
+    int colunas;                 /**< Número de células no eixo x */
+    int linhas;                  /**< Número de células no eixo y */
+    int *inicioCelula;           /**< Início de cada célula em 'indices' (colunas * linhas + 1 valores) */
+    int *indices;                /**< Índices das entidades agrupados por célula */
+} GrelhaEspacial;
 
 /**
  * @brief Estrutura que representa um frame da simulação.
@@ -34,27 +162,150 @@ typedef struct EntidadeIED {
  */
 typedef struct BaseDados {
     int frame_atual_num;         /**< Número identificador do frame */
-    EntidadeIED *barcos;         /**< Lista de entidades (navios) presentes no frame */
+    EntidadesIED barcos;         /**< Entidades (navios) presentes no frame */
+    RegistoNavios *registo;      /**< Registo partilhado com os dados estáticos dos navios */
+    GrelhaEspacial *grelha;      /**< Grelha das entidades, só existe enquanto se calcula o frame seguinte */
+    Arena *arena;                /**< Arena de onde vêm todas as alocações do frame */
+    int alterado;                /**< 1 se o utilizador inseriu ou alterou barcos neste frame */
     struct BaseDados *prev;      /**< Ponteiro para o frame anterior */
     struct BaseDados *next;      /**< Ponteiro para o frame seguinte */
 } BaseDados;
 
+/**
+ * @brief Forma como o histórico de frames é guardado.
+ */
+typedef enum ModoHistorico {
+    HISTORICO_COMPLETO,          /**< Todos os frames completos, ligados por prev/next */
+    HISTORICO_DELTA,             /**< Frames-chave periódicos e diferenças entre frames */
+    HISTORICO_CHECKPOINT,        /**< Pontos de controlo periódicos; o resto é simulado de novo */
+    HISTORICO_ANEL               /**< Apenas os últimos frames, num anel de tamanho fixo */
+} ModoHistorico;
+
+/**
+ * @brief Configuração do histórico de frames (ver as opções da linha de comandos).
+ */
+typedef struct ConfigHistorico {
+    ModoHistorico modo;          /**< Forma de guardar os frames passados */
+    int intervalo;               /**< Distância (em frames) entre frames-chave ou pontos de controlo */
+    size_t memoriaMaxima;        /**< Limite de memória dos pontos de controlo em bytes (0 = sem limite) */
+    int profundidade;            /**< Número de frames guardados no modo anel */
+} ConfigHistorico;
+
+/**
+ * @brief Frame passado guardado de forma compacta (modo HISTORICO_DELTA).
+ *
+ * Um frame-chave guarda todas as entidades. Os restantes guardam só a diferença para o
+ * frame anterior: por omissão cada barco do frame anterior continua, na mesma ordem,
+ * deslocado pela sua velocidade e com as mesmas velocidade, navio e flags. Os barcos que
+ * não seguem esta previsão (saíram, colidiram, mudaram de velocidade ou visibilidade) são
+ * indicados em 'removidos' e os que não vêm previstos são guardados por inteiro em 'novos'.
+ */
+typedef struct FrameCodificado {
+    int chave;                   /**< 1 se for frame-chave (todas as entidades em 'novos') */
+    int total;                   /**< Número de entidades do frame */
+    int numRemovidos;            /**< Número de barcos do frame anterior que não são previstos */
+    int *removidos;              /**< Índices (crescentes) desses barcos no frame anterior */
+    int *posicaoNovos;           /**< Índice (crescente) de cada entidade de 'novos' no frame */
+    EntidadesIED novos;          /**< Entidades guardadas por inteiro */
+    Arena *arena;                /**< Frames-chave: arena do intervalo que começa neste frame */
+    MarcaArena marca;            /**< Posição da arena do intervalo antes deste frame */
+} FrameCodificado;
+
+/**
+ * @brief Intervalo de frames seguidos em que um barco esteve no radar.
+ *
+ * Um barco só deixa de estar no radar quando sai da grelha ou colide; volta a ter um segmento
+ * novo se o utilizador o inserir outra vez.
+ */
+typedef struct SegmentoTrajetoria {
+    int inicio;                  /**< Primeiro frame do segmento */
+    int fim;                     /**< Último frame do segmento */
+    int xInicio, yInicio;        /**< Posição no primeiro frame */
+    int xFim, yFim;              /**< Posição no último frame */
+    int anterior;                /**< Segmento anterior do barco (-1 se for o primeiro), ou o seguinte livre */
+} SegmentoTrajetoria;
+
+/**
+ * @brief Índice das trajetórias de todos os barcos, do frame 0 ao frame atual (ver trajetorias.c).
+ *
+ * É atualizado a cada frame acrescentado ao histórico e cortado quando se recua, pelo que
+ * responde às perguntas sobre um barco sem percorrer os frames. Os segmentos de cada barco
+ * formam uma lista do mais recente para o mais antigo, guardada em 'segmentos'.
+ */
+typedef struct IndiceTrajetorias {
+    SegmentoTrajetoria *segmentos; /**< Segmentos de todos os barcos */
+    int numSegmentos;            /**< Posições usadas de 'segmentos' (incluindo as livres) */
+    int capacidadeSegmentos;     /**< Capacidade alocada de 'segmentos' */
+    int livre;                   /**< Primeiro segmento livre (-1 se nenhum) */
+    int *primeiro;               /**< Primeiro segmento de cada id (-1 se o barco nunca apareceu) */
+    int *ultimo;                 /**< Último segmento de cada id (-1 se o barco nunca apareceu) */
+    unsigned int capacidadeIds;  /**< Número de ids cobertos por 'primeiro' e 'ultimo' */
+    int ultimoFrame;             /**< Último frame registado */
+} IndiceTrajetorias;
+
 /**
  * @brief Estrutura auxiliar para aceder rapidamente ao início e fim da lista de frames.
+ *
+ * Com o histórico completo todos os frames estão em memória, ligados por prev/next. No
+ * modo delta só o frame inicial, o frame atual e o anterior a este estão em memória; os
+ * restantes estão codificados em 'codificados' e são reconstruídos quando necessário.
+ * Com pontos de controlo ficam em memória o frame inicial, o atual e os frames em
+ * 'checkpoints'; os restantes voltam a ser simulados a partir do ponto de controlo anterior.
+ * No modo anel ficam o frame inicial e os últimos frames, em 'anel'; os mais antigos
+ * perdem-se e a sua memória é reaproveitada para os frames seguintes.
  */
 typedef struct ListaFrames {
     BaseDados *head;             /**< Ponteiro para o primeiro frame (frame inicial) */
     BaseDados *tail;             /**< Ponteiro para o último frame gerado */
     int total_frames;            /**< Total de frames existentes na simulação */
+    ConfigHistorico config;      /**< Configuração do histórico */
+    FrameCodificado *codificados;/**< Frames passados codificados, indexados pelo número do frame */
+    int numCodificados;          /**< Frames [0, numCodificados) estão codificados */
+    int capacidadeCodificados;   /**< Capacidade alocada de 'codificados' */
+    BaseDados **checkpoints;     /**< Pontos de controlo, por ordem crescente do número do frame */
+    int numCheckpoints;          /**< Número de pontos de controlo */
+    int capacidadeCheckpoints;   /**< Capacidade alocada de 'checkpoints' */
+    size_t memoriaCheckpoints;   /**< Memória ocupada pelos pontos de controlo (bytes) */
+    int latitudeMax;             /**< Número máximo de linhas, para voltar a simular frames */
+    int longitudeMax;            /**< Número máximo de colunas, para voltar a simular frames */
+    BaseDados **anel;            /**< Últimos frames (modo anel), do mais antigo para o atual */
+    int inicioAnel;              /**< Posição do frame mais antigo em 'anel' */
+    int numAnel;                 /**< Número de frames no anel */
+    BaseDados *reserva;          /**< Frame que saiu do anel, a reaproveitar para o próximo frame */
+    IndiceTrajetorias trajetorias; /**< Trajetórias dos barcos do frame 0 ao frame atual */
 } ListaFrames;
 
+/**
+ * @brief Primeira e última posição de um barco no histórico (ver calcularEstatisticasBarco).
+ */
+typedef struct EstatisticasBarco {
+    unsigned int id;             /**< Id do barco procurado */
+    int posInicialX;             /**< Posição x no primeiro frame em que aparece */
+    int posInicialY;             /**< Posição y no primeiro frame em que aparece */
+    int posAtualX;               /**< Posição x no último frame em que aparece */
+    int posAtualY;               /**< Posição y no último frame em que aparece */
+    int primeiroFrame;           /**< Primeiro frame em que aparece (-1 se nunca) */
+    int ultimoFrame;             /**< Último frame em que aparece */
+    float distancia;             /**< Distância entre a primeira e a última posição */
+    float velocidadeMedia;       /**< Distância percorrida por frame */
+} EstatisticasBarco;
+
+/**
+ * @brief Formato em que são escritos os resultados das operações.
+ */
+typedef enum FormatoSaida {
+    SAIDA_TEXTO,                 /**< Mensagens para o utilizador do menu */
+    SAIDA_LOTE,                  /**< Uma linha por resultado, com campos separados por espaços (modo em lote) */
+    SAIDA_NENHUMA                /**< Nada é impresso (medições de desempenho) */
+} FormatoSaida;
+
 /**
  * @brief Estrutura que representa um navio envolvido numa colisão.
  *
  * Ligada em lista para representar todos os navios envolvidos numa colisão específica.
  */
 typedef struct BarcosEmColisao {
-    char id;                     /**< Identificador do navio envolvido na colisão */
+    unsigned int id;             /**< Id do barco envolvido na colisão (ver IdentidadeNavio) */
     struct BarcosEmColisao *seguinte; /**< Ponteiro para o próximo navio em colisão */
 } BarcosEmColisao;
 
@@ -69,4 +320,270 @@ typedef struct Colisao {
     struct Colisao *seguinte;   /**< Ponteiro para a próxima colisão na lista */
 } Colisao;
 
+/**
+ * @brief Estrutura auxiliar que representa uma célula ocupada durante a deteção de colisões.
+ *
+ * Cada posição (x, y) ocupada no frame tem uma entrada numa tabela de dispersão. Os barcos
+ * que podem colidir nessa posição ficam encadeados por ordem de índice (cabeca .. cauda).
+ */
+typedef struct CelulaOcupada {
+    int x, y;                    /**< Coordenadas da célula */
+    int primeiro;                /**< Menor índice de um barco nesta célula (-1 se a entrada está livre) */
+    int elegiveis;               /**< Número de barcos nesta célula que podem colidir */
+    int cabeca;                  /**< Primeiro barco elegível da célula */
+    int cauda;                   /**< Último barco elegível da célula */
+} CelulaOcupada;
+
+/**
+ * @brief Estrutura auxiliar com o estado partilhado pelas threads durante o cálculo de um frame.
+ *
+ * O frame anterior só é lido; cada thread escreve apenas nas posições do novo frame e dos
+ * arrays auxiliares que pertencem à sua parte.
+ */
+typedef struct PassoFrame {
+    BaseDados *anterior;         /**< Frame de origem (só leitura) */
+    BaseDados *novo;             /**< Frame a calcular */
+    int latitudeMax;             /**< Número máximo de linhas da grelha */
+    int longitudeMax;            /**< Número máximo de colunas da grelha */
+    int alterna;                 /**< Indica se os submarinos alternam a visibilidade neste frame */
+    int *deslX;                  /**< Deslocamento de cada barco no eixo x */
+    int *deslY;                  /**< Deslocamento de cada barco no eixo y */
+    int *sobreviventes;          /**< Índice original de cada barco que fica no radar */
+    int *inicioParte;            /**< Início de cada parte processada em paralelo */
+    int *sobreviventesParte;     /**< Número de sobreviventes de cada parte */
+} PassoFrame;
+
+/**
+ * @brief Estado da procura de frames sem eventos ao longo de um avanço (ver saltoSemEventos).
+ *
+ * O horizonte cresce enquanto as procuras chegam ao fim sem encontrar eventos; quando uma
+ * procura falha, as seguintes ficam em espera durante um número crescente de passos.
+ */
+typedef struct ProcuraEventos {
+    int horizonte;               /**< Frames procurados de cada vez por framesSemEventos */
+    int espera;                  /**< Passos normais até voltar a procurar frames sem eventos */
+    int penalizacao;             /**< Espera aplicada depois da última procura sem sucesso */
+    int eventoSeguinte;          /**< 1 se o último salto parou num frame com eventos */
+} ProcuraEventos;
+
+/**
+ * @brief Dados de uma etapa do avanço direto (ver avancarDireto), alocados na arena temporária.
+ *
+ * Os barcos "presos" podem interagir com outros durante a etapa e são calculados passo a
+ * passo; os restantes têm movimento linear e são colocados diretamente na posição final.
+ */
+typedef struct EtapaAvanco {
+    BaseDados *frame;            /**< Frame no início da etapa (só leitura) */
+    int janela;                  /**< Número de frames da etapa */
+    int *deslX;                  /**< Deslocamento linear de cada barco no eixo x */
+    int *deslY;                  /**< Deslocamento linear de cada barco no eixo y */
+    int *raio;                   /**< Raio de proximidade de cada barco (ver raioDeProximidade) */
+    int *saida;                  /**< Frame de saída do radar com movimento linear (relativo ao início) */
+    int *minX, *maxX;            /**< Menor e maior deslocamento possível por frame no eixo x */
+    int *minY, *maxY;            /**< Menor e maior deslocamento possível por frame no eixo y */
+    int *indice;                 /**< Índice de cada navio do registo no frame inicial (-1 se não está) */
+    unsigned char *preso;        /**< 1 se o barco tem de ser calculado passo a passo */
+    int numPresos;               /**< Número de barcos presos */
+} EtapaAvanco;
+
+/**
+ * @brief Entrada das tabelas de dispersão usadas na previsão analítica de colisões.
+ *
+ * A chave tem três partes (por exemplo, a posição inicial de um barco e a sua classe de velocidade)
+ * e o valor é normalmente o primeiro barco com essa chave.
+ */
+typedef struct EntradaPrevisao {
+    long long chave;             /**< Primeira parte da chave */
+    int chave2;                  /**< Segunda parte da chave */
+    int chave3;                  /**< Terceira parte da chave */
+    int valor;                   /**< Valor associado à chave (-1 se a entrada está livre) */
+} EntradaPrevisao;
+
+/**
+ * @brief Encontro previsto entre dois barcos com movimento linear.
+ */
+typedef struct EncontroPrevisto {
+    int t;                       /**< Número de frames até ao encontro */
+    int x, y;                    /**< Posição do encontro */
+    int a, b;                    /**< Barcos que se encontram (b = -1 se só indica a presença de a) */
+} EncontroPrevisto;
+
+/**
+ * @brief Colisão prevista num frame da previsão analítica.
+ *
+ * Os barcos envolvidos ocupam as posições [inicio, inicio + numBarcos) de um array auxiliar.
+ */
+typedef struct ColisaoPrevista {
+    int ordem;                   /**< Menor índice de um barco na posição (ordem de impressão) */
+    int x, y;                    /**< Posição da colisão */
+    int inicio;                  /**< Primeiro barco envolvido no array auxiliar */
+    int numBarcos;               /**< Número de barcos envolvidos */
+} ColisaoPrevista;
+
+/**
+ * @brief Fases do avanço da simulação medidas pelas métricas (ver metricas.c).
+ */
+typedef enum FaseMetricas {
+    FASE_DIRETO,                 /**< Avanço direto dos frames que não ficam no histórico (inclui as fases do passo) */
+    FASE_SALTOS,                 /**< Procura e avanço de frames sem eventos */
+    FASE_GRELHA,                 /**< Construção da grelha espacial */
+    FASE_COMPORTAMENTO,          /**< Comportamento por tipo, incluindo as verificações de proximidade */
+    FASE_MOVIMENTO,              /**< Movimento e remoção dos barcos que saem do radar */
+    FASE_JUNCAO,                 /**< Junção dos sobreviventes de cada parte e avisos de saída */
+    FASE_COLISOES,               /**< Deteção e remoção dos barcos em colisão */
+    FASE_HISTORICO,              /**< Criação do frame e ligação ao histórico */
+    NUM_FASES
+} FaseMetricas;
+
+/**
+ * @brief Contadores das métricas.
+ */
+typedef enum ContadorMetricas {
+    CONTADOR_FRAMES,             /**< Frames calculados passo a passo */
+    CONTADOR_BARCOS,             /**< Barcos processados nesses frames */
+    CONTADOR_VIZINHOS,           /**< Verificações de proximidade (temBarcosADistancia) */
+    CONTADOR_COLISOES,           /**< Grupos de barcos em colisão */
+    CONTADOR_ALOCACOES,          /**< Alocações nas arenas */
+    CONTADOR_BLOCOS,             /**< Blocos de memória pedidos ao sistema pelas arenas */
+    NUM_CONTADORES
+} ContadorMetricas;
+
+/**
+ * @brief Tempos e contadores acumulados desde o início do programa (ou desde reiniciarMetricas).
+ */
+typedef struct Metricas {
+    long long tempoFase[NUM_FASES];      /**< Tempo total de cada fase, em nanossegundos */
+    long long medicoesFase[NUM_FASES];   /**< Número de vezes que cada fase foi medida */
+    long long inicioFase[NUM_FASES];     /**< Instante em que começou a medição em curso de cada fase */
+    long long contadores[NUM_CONTADORES]; /**< Valor de cada contador */
+} Metricas;
+
+#define BARCOS_POR_BLOCO_LEITURA 4096  // Barcos em cada bloco do ficheiro inicial (ver lerFicheiroInicial)
+
+/**
+ * @brief Bloco de barcos já interpretados do ficheiro inicial, à espera de serem inseridos no frame 0.
+ */
+typedef struct BlocoLeitura {
+    char indicativo[BARCOS_POR_BLOCO_LEITURA][TAMANHO_INDICATIVO]; /**< Indicativo de cada barco */
+    int posX[BARCOS_POR_BLOCO_LEITURA];      /**< Longitude */
+    int posY[BARCOS_POR_BLOCO_LEITURA];      /**< Latitude */
+    int velX[BARCOS_POR_BLOCO_LEITURA];      /**< Velocidade no eixo x (já convertida do ângulo) */
+    int velY[BARCOS_POR_BLOCO_LEITURA];      /**< Velocidade no eixo y */
+    int tipo[BARCOS_POR_BLOCO_LEITURA];      /**< Tipo do navio */
+    int linha[BARCOS_POR_BLOCO_LEITURA];     /**< Número da linha do ficheiro (para as mensagens de erro) */
+    int total;                               /**< Número de barcos no bloco */
+} BlocoLeitura;
+
+#define ASSINATURA_ESTADO "RADAREST"  // Primeiros 8 bytes de um ficheiro de estado
+#define VERSAO_ESTADO 1                // Versão do formato dos ficheiros de estado
+#define ORDEM_ESTADO 0x01020304u       // Para reconhecer ficheiros escritos com outra ordem de bytes
+#define ESTADO_COM_HISTORICO 0x01      // O ficheiro tem todos os frames do histórico (ver guardarEstado)
+
+/**
+ * @brief Cabeçalho de um ficheiro de estado (ver estado.c).
+ *
+ * É seguido pelas identidades e pelos navios do registo, pelos frames (cada um com um
+ * CabecalhoFrameEstado e os arrays das entidades) e pelo índice de trajetórias.
+ */
+typedef struct CabecalhoEstado {
+    char assinatura[8];          /**< ASSINATURA_ESTADO, sem o '\0' */
+    unsigned int versao;         /**< VERSAO_ESTADO */
+    unsigned int ordem;          /**< ORDEM_ESTADO, tal como ficou em memória */
+    unsigned int opcoes;         /**< ESTADO_COM_HISTORICO */
+    int latitudeMax;             /**< Número de linhas da grelha */
+    int longitudeMax;            /**< Número de colunas da grelha */
+    int modo;                    /**< Modo do histórico (ModoHistorico) */
+    int intervalo;               /**< Intervalo do histórico */
+    int profundidade;            /**< Profundidade do histórico em anel */
+    unsigned long long memoriaMaxima; /**< Limite de memória dos pontos de controlo (bytes) */
+    unsigned int totalIds;       /**< Número de identidades do registo */
+    int totalNavios;             /**< Número de navios do registo */
+    int numFrames;               /**< Número de frames guardados (o primeiro é o frame 0, o último o atual) */
+    unsigned int idsTrajetorias; /**< Número de ids cobertos pelo índice de trajetórias */
+    int numSegmentos;            /**< Segmentos do índice de trajetórias (incluindo os livres) */
+    int segmentoLivre;           /**< Primeiro segmento livre (-1 se nenhum) */
+    int ultimoFrameTrajetorias;  /**< Último frame registado no índice de trajetórias */
+    int reservado;               /**< Sempre 0 */
+} CabecalhoEstado;
+
+/**
+ * @brief Cabeçalho de cada frame de um ficheiro de estado.
+ *
+ * É seguido pelos arrays posX, posY, velX, velY e navio (com 'total' inteiros cada) e pelo
+ * array flags, completado com zeros até um múltiplo de 4 bytes.
+ */
+typedef struct CabecalhoFrameEstado {
+    int numero;                  /**< Número do frame */
+    int total;                   /**< Número de entidades */
+    int alterado;                /**< 1 se o utilizador alterou o frame */
+    int reservado;               /**< Sempre 0 */
+} CabecalhoFrameEstado;
+
+/**
+ * @brief Ficheiro de estado a ser escrito, passado a cada frame visitado (ver guardarEstado).
+ */
+typedef struct EscritaEstado {
+    FILE *fp;                    /**< Ficheiro aberto para escrita */
+    int numFrames;               /**< Frames já escritos */
+} EscritaEstado;
+
+/**
+ * @brief Pedidos da thread principal à thread de escrita do ficheiro de saída (ver saida.c).
+ */
+typedef enum TipoMensagemSaida {
+    MENSAGEM_FICHEIRO,           /**< Substitui o ficheiro de saída pelos barcos do frame */
+    MENSAGEM_FRAME,              /**< Acrescenta o frame ao registo contínuo */
+    MENSAGEM_TEXTO,              /**< Acrescenta linhas já formatadas ao registo contínuo */
+    MENSAGEM_DESPEJAR,           /**< Despeja o buffer do registo contínuo para o ficheiro */
+    MENSAGEM_FIM                 /**< Termina a thread de escrita */
+} TipoMensagemSaida;
+
+/**
+ * @brief Pedido à thread de escrita, com uma cópia dos dados a escrever.
+ *
+ * Os barcos de um frame são copiados (só os visíveis) para que a simulação possa continuar
+ * enquanto são formatados. Os arrays são reaproveitados pelas mensagens seguintes.
+ */
+typedef struct MensagemSaida {
+    TipoMensagemSaida tipo;      /**< O que fazer com a mensagem */
+    int frame;                   /**< Número do frame copiado */
+    int total;                   /**< Número de barcos copiados */
+    int capacidade;              /**< Capacidade dos arrays dos barcos */
+    char (*indicativo)[TAMANHO_INDICATIVO]; /**< Indicativo de cada barco */
+    int *posX, *posY;            /**< Posição de cada barco */
+    int *velX, *velY;            /**< Velocidade de cada barco */
+    int *tipologia;              /**< Tipo de cada barco */
+    char *texto;                 /**< Linhas formatadas (MENSAGEM_TEXTO) */
+    size_t tamanhoTexto;         /**< Bytes usados em 'texto' */
+    size_t capacidadeTexto;      /**< Bytes alocados em 'texto' */
+} MensagemSaida;
+
+/**
+ * @brief Ficheiro de saída da simulação (ver saida.c).
+ *
+ * Sem registo contínuo, o ficheiro tem apenas o frame guardado por último. Com ele, os frames
+ * simulados (um em cada 'intervalo'), as colisões e os recuos são acrescentados ao ficheiro
+ * à medida que acontecem, através de um buffer grande.
+ */
+typedef struct SaidaSimulacao {
+    const char *ficheiro;        /**< Caminho do ficheiro de saída */
+    FILE *fp;                    /**< Ficheiro aberto do registo contínuo (NULL sem registo) */
+    char *buffer;                /**< Buffer do registo contínuo (usado pela thread de escrita) */
+    int intervalo;               /**< Escreve os frames múltiplos deste número (0 sem registo contínuo) */
+    int ultimoFrame;             /**< Número do último frame escrito no registo (-1 se nenhum) */
+} SaidaSimulacao;
+
+/**
+ * @brief Parâmetros de um cenário sintético gerado pelo benchmark.
+ */
+typedef struct ConfigCenario {
+    int barcos;                  /**< Número de barcos */
+    int linhas, colunas;         /**< Dimensões da grelha (0 = calculadas a partir da densidade) */
+    double densidade;            /**< Barcos por casa da grelha, usada se as dimensões não forem dadas */
+    int pesosTipos[14];          /**< Peso relativo de cada tipo de barco (índices 1 a 13) */
+    int velocidadeMinima;        /**< Menor velocidade gerada */
+    int velocidadeMaxima;        /**< Maior velocidade gerada */
+    unsigned long long semente;  /**< Semente do gerador de números pseudo-aleatórios */
+} ConfigCenario;
+
 #endif
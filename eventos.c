@@ -0,0 +1,1069 @@
+#include "modulo.h"
+
+// ================================================ EVENTOS ============================================================
+
+/*
+ * Avanço por eventos. Na maior parte dos frames nenhum barco interage: nenhum barco está ao
+ * alcance de um Cruzador ou de um Rebocador, nenhum par de barcos partilha uma posição e
+ * nenhum barco sai do radar. Enquanto isso acontece, cada barco desloca-se sempre o mesmo
+ * (a velocidade, a dobrar nos Cruzadores) e os Submarinos só alternam a visibilidade, pelo que
+ * um frame k passos à frente pode ser calculado diretamente (ver extrapolarFrame).
+ *
+ * framesSemEventos calcula quantos frames seguidos estão nestas condições, procurando o
+ * primeiro frame em que algum barco entra no raio de um Cruzador ou Rebocador, em que dois
+ * barcos que podem colidir ficam na mesma posição, ou em que algum barco sai do radar. Para
+ * não comparar todos os pares de barcos, os trajetos são distribuídos por uma grelha e só se
+ * comparam barcos cujos trajetos (alargados pelo raio de proximidade) se intersetam.
+ *
+ * A verificação é conservadora: conta com todos os barcos, mesmo submarinos invisíveis, pelo
+ * que a visibilidade dos Submarinos nunca altera o comportamento de outro barco num salto.
+ */
+
+// Maior número médio de células da grelha de trajetos por barco, antes de encurtar o horizonte
+#define CELULAS_POR_BARCO 16
+
+// Lado mínimo das células da grelha de trajetos
+#define CELULA_MINIMA 8
+
+// Horizonte inicial e máximo da procura de frames sem eventos (ver saltoSemEventos)
+#define HORIZONTE_INICIAL 4
+#define HORIZONTE_MAXIMO 1024
+
+// Maior número de passos normais seguidos antes de voltar a procurar frames sem eventos
+#define ESPERA_MAXIMA 64
+
+// Janela inicial e mínima (em frames) de cada etapa do avanço direto
+#define JANELA_INICIAL 64
+#define JANELA_MINIMA 16
+
+// Maior número médio de pares de barcos a comparar por barco, antes de encurtar a janela
+#define PARES_POR_BARCO 16
+
+// Maior número de frames seguidos calculados com todos os barcos presos, sem tentar separá-los
+#define ESPERA_MAXIMA_PRESOS 1024
+
+/**
+ * @brief Divisão inteira arredondada para cima.
+ *
+ * @param a Dividendo.
+ * @param b Divisor (diferente de zero).
+ * @return O menor inteiro maior ou igual a a / b.
+ */
+static long long dividirPorCima(long long a, long long b) {
+    return -dividirPorBaixo(-a, b);
+}
+
+/**
+ * @brief Calcula o deslocamento de um barco por frame enquanto não houver eventos.
+ *
+ * Sem barcos por perto, o Cruzador desloca-se o dobro da velocidade e os restantes a velocidade.
+ *
+ * @param frame Frame onde está o barco.
+ * @param i Índice do barco.
+ * @param dx Devolve o deslocamento no eixo x.
+ * @param dy Devolve o deslocamento no eixo y.
+ */
+static void deslocamentoSemEventos(BaseDados *frame, int i, int *dx, int *dy) {
+    int fator = frame->registo->navios[frame->barcos.navio[i]].tipologia == 2 ? 2 : 1;
+
+    *dx = frame->barcos.velX[i] * fator;
+    *dy = frame->barcos.velY[i] * fator;
+}
+
+/**
+ * @brief Raio em que a aproximação de outro barco muda o deslocamento deste barco.
+ *
+ * Um Cruzador parado e um Rebocador que já se move no máximo 1 casa por eixo deslocam-se
+ * da mesma forma com ou sem barcos por perto, por isso não precisam de ser vigiados.
+ *
+ * @param frame Frame onde está o barco.
+ * @param i Índice do barco.
+ * @return 4 para um Cruzador, 5 para um Rebocador, 0 se a proximidade não importa.
+ */
+static int raioDeProximidade(BaseDados *frame, int i) {
+    int vx = frame->barcos.velX[i];
+    int vy = frame->barcos.velY[i];
+
+    switch (frame->registo->navios[frame->barcos.navio[i]].tipologia) {
+        case 2:
+            return (vx != 0 || vy != 0) ? 4 : 0;
+        case 10:
+            return (vx < -1 || vx > 1 || vy < -1 || vy > 1) ? 5 : 0;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Restringe [inicio, fim] aos passos t em que a * t <= c.
+ *
+ * @param a Coeficiente de t.
+ * @param c Valor máximo de a * t.
+ * @param inicio Primeiro passo do intervalo (atualizado).
+ * @param fim Último passo do intervalo (atualizado; fica menor que inicio se o intervalo ficar vazio).
+ */
+static void restringirDesigualdade(long long a, long long c, long long *inicio, long long *fim) {
+    if (a == 0) {
+        if (c < 0)
+            *fim = *inicio - 1;
+    } else if (a > 0) {
+        long long ate = dividirPorBaixo(c, a);
+        if (ate < *fim) *fim = ate;
+    } else {
+        long long de = dividirPorCima(c, a);
+        if (de > *inicio) *inicio = de;
+    }
+}
+
+/**
+ * @brief Restringe [inicio, fim] aos passos t em que |q + t * w| <= raio.
+ *
+ * @param q Distância inicial num eixo.
+ * @param w Variação da distância por passo.
+ * @param raio Distância máxima.
+ * @param inicio Primeiro passo do intervalo (atualizado).
+ * @param fim Último passo do intervalo (atualizado).
+ */
+static void restringirNoEixo(long long q, int w, int raio, long long *inicio, long long *fim) {
+    restringirDesigualdade(-w, q + raio, inicio, fim);
+    restringirDesigualdade(w, raio - q, inicio, fim);
+}
+
+/**
+ * @brief Calcula o primeiro passo em que dois barcos ficam a uma distância máxima 'raio' em ambos os eixos.
+ *
+ * @param qx Posição do segundo barco relativa ao primeiro, no eixo x.
+ * @param qy Posição do segundo barco relativa ao primeiro, no eixo y.
+ * @param wx Deslocamento relativo por passo, no eixo x.
+ * @param wy Deslocamento relativo por passo, no eixo y.
+ * @param raio Distância máxima (0 para a mesma posição).
+ * @param inicio Primeiro passo a considerar.
+ * @param fim Último passo a considerar.
+ * @return O primeiro passo em [inicio, fim], ou fim + 1 se não houver nenhum.
+ */
+static int primeiroEncontro(long long qx, long long qy, int wx, int wy, int raio, int inicio, int fim) {
+    long long de = inicio, ate = fim;
+
+    restringirNoEixo(qx, wx, raio, &de, &ate);
+    restringirNoEixo(qy, wy, raio, &de, &ate);
+    return de <= ate ? (int) de : fim + 1;
+}
+
+/**
+ * @brief Calcula até que passo dois barcos não interagem.
+ *
+ * @param frame Frame de partida.
+ * @param i Primeiro barco.
+ * @param j Segundo barco.
+ * @param deslX Deslocamento de cada barco no eixo x.
+ * @param deslY Deslocamento de cada barco no eixo y.
+ * @param raio Raio de proximidade de cada barco.
+ * @param limite Número de passos sem eventos encontrado até agora.
+ * @return O novo limite (nunca maior que 'limite').
+ */
+static int limiteDoPar(BaseDados *frame, int i, int j, const int *deslX, const int *deslY, const int *raio,
+                       int limite) {
+    EntidadesIED *barcos = &frame->barcos;
+    NoVessel *navios = frame->registo->navios;
+    long long qx = (long long) barcos->posX[j] - barcos->posX[i];
+    long long qy = (long long) barcos->posY[j] - barcos->posY[i];
+    int wx = deslX[j] - deslX[i];
+    int wy = deslY[j] - deslY[i];
+    int t;
+
+    // Um barco ao alcance no frame t muda o deslocamento do passo t + 1
+    if (raio[i] > 0 && limite > 0) {
+        t = primeiroEncontro(qx, qy, wx, wy, raio[i], 0, limite - 1);
+        if (t < limite) limite = t;
+    }
+    if (raio[j] > 0 && limite > 0) {
+        t = primeiroEncontro(qx, qy, wx, wy, raio[j], 0, limite - 1);
+        if (t < limite) limite = t;
+    }
+
+    // Dois barcos que podem colidir na mesma posição no frame t tornam o passo t um evento
+    if (limite > 0 && navios[barcos->navio[i]].tipologia != 1 && navios[barcos->navio[j]].tipologia != 1) {
+        t = primeiroEncontro(qx, qy, wx, wy, 0, 1, limite);
+        if (t <= limite) limite = t - 1;
+    }
+
+    return limite;
+}
+
+/**
+ * @brief Calcula quantos frames a seguir a um frame podem ser obtidos por movimento linear.
+ *
+ * Um frame é "sem eventos" se, ao calculá-lo a partir do anterior, nenhum barco muda de
+ * deslocamento, sai do radar ou fica na mesma posição que outro barco com que possa colidir.
+ * Os frames sem eventos podem ser obtidos com extrapolarFrame, sem calcular os passos
+ * intermédios; o frame seguinte ao último tem de ser calculado com calcularFrameSeguinte.
+ *
+ * @param frame Frame de partida.
+ * @param maximo Número máximo de frames a considerar (o horizonte da procura).
+ * @param latitudeMax Número máximo de linhas da grelha.
+ * @param longitudeMax Número máximo de colunas da grelha.
+ * @return Número de frames seguidos sem eventos (entre 0 e maximo).
+ */
+int framesSemEventos(BaseDados *frame, int maximo, int latitudeMax, int longitudeMax) {
+    EntidadesIED *barcos = &frame->barcos;
+    int n = barcos->total;
+    Arena *temporaria = arenaTemporaria();
+    MarcaArena marca;
+    int *deslX, *deslY, *raio, *x0, *x1, *y0, *y1;
+    int limite = maximo;
+    int maiorPasso = 0;
+
+    if (maximo <= 0 || n == 0)
+        return maximo > 0 ? maximo : 0;
+
+    marca = marcarArena(temporaria);
+    deslX = alocarArena(temporaria, (size_t) n * 7 * sizeof(int));
+    deslY = deslX + n;
+    raio = deslY + n;
+    x0 = raio + n;
+    x1 = x0 + n;
+    y0 = x1 + n;
+    y1 = y0 + n;
+
+    // Deslocamento de cada barco e saídas do radar
+    for (int i = 0; i < n && limite > 0; i++) {
+        int saida;
+
+        deslocamentoSemEventos(frame, i, &deslX[i], &deslY[i]);
+        raio[i] = raioDeProximidade(frame, i);
+        saida = frameDeSaida(barcos->posX[i], barcos->posY[i], deslX[i], deslY[i], latitudeMax, longitudeMax);
+        if (saida - 1 < limite)
+            limite = saida - 1;
+
+        if (abs(deslX[i]) > maiorPasso) maiorPasso = abs(deslX[i]);
+        if (abs(deslY[i]) > maiorPasso) maiorPasso = abs(deslY[i]);
+    }
+
+    // Pares de barcos cujos trajetos se aproximam, encontrados através de uma grelha
+    while (limite > 0) {
+        int lado = maiorPasso * limite / 2 + 1;
+        int colunas, linhas, numCelulas, entradas = 0;
+        int *inicioCelula, *livre, *indices;
+        MarcaArena marcaGrelha = marcarArena(temporaria);
+        int horizonte = limite;
+
+        if (lado < CELULA_MINIMA) lado = CELULA_MINIMA;
+        colunas = (longitudeMax + 10) / lado + 1;
+        linhas = (latitudeMax + 10) / lado + 1;
+        numCelulas = colunas * linhas;
+
+        // Caixa de cada trajeto até ao horizonte, em células (a grelha começa em -5, o maior raio)
+        for (int i = 0; i < n; i++) {
+            int xa = barcos->posX[i], xb = barcos->posX[i] + horizonte * deslX[i];
+            int ya = barcos->posY[i], yb = barcos->posY[i] + horizonte * deslY[i];
+
+            x0[i] = ((xa < xb ? xa : xb) - raio[i] + 5) / lado;
+            x1[i] = ((xa < xb ? xb : xa) + raio[i] + 5) / lado;
+            y0[i] = ((ya < yb ? ya : yb) - raio[i] + 5) / lado;
+            y1[i] = ((ya < yb ? yb : ya) + raio[i] + 5) / lado;
+            entradas += (x1[i] - x0[i] + 1) * (y1[i] - y0[i] + 1);
+        }
+
+        // Trajetos demasiado longos: procura-se primeiro num horizonte mais curto
+        if (entradas > CELULAS_POR_BARCO * n && horizonte > 1) {
+            limite = horizonte / 2;
+            restaurarArena(temporaria, marcaGrelha);
+            continue;
+        }
+
+        inicioCelula = alocarArena(temporaria, (size_t) (numCelulas + 1) * sizeof(int));
+        livre = alocarArena(temporaria, (size_t) numCelulas * sizeof(int));
+        indices = alocarArena(temporaria, (size_t) (entradas > 0 ? entradas : 1) * sizeof(int));
+        memset(inicioCelula, 0, (size_t) (numCelulas + 1) * sizeof(int));
+
+        for (int i = 0; i < n; i++)
+            for (int cy = y0[i]; cy <= y1[i]; cy++)
+                for (int cx = x0[i]; cx <= x1[i]; cx++)
+                    inicioCelula[cy * colunas + cx + 1]++;
+        for (int c = 0; c < numCelulas; c++)
+            inicioCelula[c + 1] += inicioCelula[c];
+        memcpy(livre, inicioCelula, (size_t) numCelulas * sizeof(int));
+        for (int i = 0; i < n; i++)
+            for (int cy = y0[i]; cy <= y1[i]; cy++)
+                for (int cx = x0[i]; cx <= x1[i]; cx++)
+                    indices[livre[cy * colunas + cx]++] = i;
+
+        // Cada par é analisado só na célula do canto inferior da interseção das caixas
+        for (int c = 0; c < numCelulas && limite > 0; c++) {
+            int cx = c % colunas, cy = c / colunas;
+
+            for (int a = inicioCelula[c]; a < inicioCelula[c + 1] && limite > 0; a++) {
+                int i = indices[a];
+
+                for (int b = a + 1; b < inicioCelula[c + 1] && limite > 0; b++) {
+                    int j = indices[b];
+
+                    if ((x0[i] > x0[j] ? x0[i] : x0[j]) != cx || (y0[i] > y0[j] ? y0[i] : y0[j]) != cy)
+                        continue;
+                    limite = limiteDoPar(frame, i, j, deslX, deslY, raio, limite);
+                }
+            }
+        }
+
+        restaurarArena(temporaria, marcaGrelha);
+        break;
+    }
+
+    restaurarArena(temporaria, marca);
+    return limite;
+}
+
+/**
+ * @brief Calcula diretamente o frame 'passos' frames depois de outro, sem eventos pelo meio.
+ *
+ * Só é válido se 'passos' não for maior que framesSemEventos(origem, ...): cada barco avança
+ * 'passos' vezes o seu deslocamento e os Submarinos alternam a visibilidade uma vez por cada
+ * frame múltiplo de 5 no intervalo. O destino tem de ter sido criado a partir da origem
+ * (criarFrame ou reciclarFrame) e fica com o número origem + passos.
+ *
+ * @param origem Frame de partida.
+ * @param destino Frame a preencher.
+ * @param passos Número de frames a avançar (>= 1).
+ */
+void extrapolarFrame(BaseDados *origem, BaseDados *destino, int passos) {
+    EntidadesIED *de = &origem->barcos;
+    EntidadesIED *para = &destino->barcos;
+    NoVessel *navios = origem->registo->navios;
+    int inicio = origem->frame_atual_num;
+    int alternancias = (inicio + passos) / 5 - inicio / 5;
+    int n = de->total;
+
+    reservarEntidades(destino, n);
+    destino->frame_atual_num = inicio + passos;
+    copiarEntidades(para, 0, de, 0, n);
+    para->total = n;
+
+    for (int i = 0; i < n; i++) {
+        int dx, dy;
+
+        deslocamentoSemEventos(origem, i, &dx, &dy);
+        para->posX[i] += passos * dx;
+        para->posY[i] += passos * dy;
+        if ((alternancias & 1) && navios[de->navio[i]].tipologia == 3)
+            para->flags[i] ^= BARCO_VISIVEL;
+    }
+}
+
+/**
+ * @brief Prepara a procura de frames sem eventos para um novo avanço.
+ *
+ * @param procura Estado da procura.
+ */
+void iniciarProcuraEventos(ProcuraEventos *procura) {
+    procura->horizonte = HORIZONTE_INICIAL;
+    procura->espera = 0;
+    procura->penalizacao = 0;
+    procura->eventoSeguinte = 0;
+}
+
+/**
+ * @brief Decide quantos frames sem eventos podem ser saltados a partir do frame atual.
+ *
+ * A procura (framesSemEventos) vai até ao horizonte, que duplica sempre que a procura chega
+ * ao fim sem encontrar eventos. Quando há eventos logo no frame seguinte, o horizonte passa
+ * a metade e as procuras seguintes ficam em espera durante um número crescente de passos.
+ * Depois de um salto que parou antes do horizonte, o frame seguinte tem um evento e é
+ * calculado passo a passo sem voltar a procurar.
+ *
+ * @param procura Estado da procura.
+ * @param frame Frame atual.
+ * @param maximo Número de frames que ainda faltam avançar.
+ * @param latitudeMax Número máximo de linhas da grelha.
+ * @param longitudeMax Número máximo de colunas da grelha.
+ * @return Número de frames a calcular com extrapolarFrame (0 se o seguinte tem de ser calculado passo a passo).
+ */
+int saltoSemEventos(ProcuraEventos *procura, BaseDados *frame, int maximo, int latitudeMax, int longitudeMax) {
+    int pedidos = maximo < procura->horizonte ? maximo : procura->horizonte;
+    int saltados;
+
+    if (procura->eventoSeguinte) {
+        procura->eventoSeguinte = 0;
+        return 0;
+    }
+    if (procura->espera > 0) {
+        procura->espera--;
+        return 0;
+    }
+
+    saltados = framesSemEventos(frame, pedidos, latitudeMax, longitudeMax);
+    if (saltados == 0) {
+        // Há eventos logo no frame seguinte: espera cada vez mais até voltar a procurar
+        procura->penalizacao = procura->penalizacao == 0 ? 1 : procura->penalizacao * 2;
+        if (procura->penalizacao > ESPERA_MAXIMA) procura->penalizacao = ESPERA_MAXIMA;
+        procura->espera = procura->penalizacao;
+        if (procura->horizonte / 2 > HORIZONTE_INICIAL)
+            procura->horizonte /= 2;
+        else
+            procura->horizonte = HORIZONTE_INICIAL;
+        return 0;
+    }
+
+    procura->penalizacao = 0;
+    if (saltados == procura->horizonte && procura->horizonte * 2 <= HORIZONTE_MAXIMO)
+        procura->horizonte *= 2;
+    procura->eventoSeguinte = saltados < pedidos;
+    return saltados;
+}
+
+/*
+ * Avanço direto. Num avanço longo a maior parte dos barcos nunca chega perto de outro: cada um
+ * desloca-se sempre o mesmo até sair do radar (ver frameDeSaida), pelo que a sua posição no fim
+ * do avanço é a inicial mais o deslocamento vezes o número de frames. Só os barcos que podem
+ * interagir precisam de ser calculados passo a passo, e só entre eles.
+ *
+ * O avanço é feito em etapas (janelas) de vários frames. No início de cada etapa os barcos são
+ * separados em livres e presos. Ficam presos os pares de barcos em que o movimento linear de
+ * ambos leva a um evento (ver limiteDoPar) e, depois, qualquer barco que possa chegar ao raio de
+ * proximidade de um barco preso (ou à sua posição), contando com todos os deslocamentos que o
+ * barco preso pode ter: o Cruzador entre a velocidade e o dobro dela e o Rebocador entre a
+ * velocidade e 1 casa no mesmo sentido. Os barcos presos formam um frame à parte, pela ordem
+ * original, que é calculado com calcularFrameSeguinte (e com saltos por frames sem eventos).
+ * Como nenhum barco livre se aproxima deles, o resultado é o mesmo que com o frame inteiro.
+ *
+ * Para que as mensagens de debug saiam pela mesma ordem, os barcos livres que saem do radar num
+ * passo entram no frame dos presos nesse passo, na sua posição original.
+ */
+
+/**
+ * @brief Calcula o menor e o maior deslocamento por frame de um barco, num eixo.
+ *
+ * @param tipologia Tipo do barco.
+ * @param v Velocidade no eixo.
+ * @param minimo Devolve o menor deslocamento.
+ * @param maximo Devolve o maior deslocamento.
+ */
+static void alcanceNoEixo(int tipologia, int v, int *minimo, int *maximo) {
+    int outro = v;
+
+    if (tipologia == 2)
+        outro = 2 * v;
+    else if (tipologia == 10)
+        outro = (v == 0) ? 0 : (v > 0 ? 1 : -1);
+
+    *minimo = v < outro ? v : outro;
+    *maximo = v < outro ? outro : v;
+}
+
+/**
+ * @brief Calcula os dados de cada barco que não dependem da janela da etapa.
+ *
+ * @param etapa Etapa a preparar (os arrays ficam na arena temporária).
+ * @param frame Frame no início da etapa.
+ * @param latitudeMax Número máximo de linhas da grelha.
+ * @param longitudeMax Número máximo de colunas da grelha.
+ */
+static void prepararEtapa(EtapaAvanco *etapa, BaseDados *frame, int latitudeMax, int longitudeMax) {
+    EntidadesIED *barcos = &frame->barcos;
+    NoVessel *navios = frame->registo->navios;
+    Arena *temporaria = arenaTemporaria();
+    int n = barcos->total;
+    int m = n > 0 ? n : 1;
+
+    etapa->frame = frame;
+    etapa->janela = 0;
+    etapa->deslX = alocarArena(temporaria, (size_t) m * 9 * sizeof(int));
+    etapa->deslY = etapa->deslX + m;
+    etapa->raio = etapa->deslY + m;
+    etapa->saida = etapa->raio + m;
+    etapa->minX = etapa->saida + m;
+    etapa->maxX = etapa->minX + m;
+    etapa->minY = etapa->maxX + m;
+    etapa->maxY = etapa->minY + m;
+    etapa->indice = alocarArena(temporaria, (size_t) (frame->registo->total > 0 ? frame->registo->total : 1) *
+                                            sizeof(int));
+    etapa->preso = alocarArena(temporaria, (size_t) m);
+    etapa->numPresos = 0;
+
+    for (int k = 0; k < frame->registo->total; k++)
+        etapa->indice[k] = -1;
+
+    for (int i = 0; i < n; i++) {
+        int tipologia = navios[barcos->navio[i]].tipologia;
+
+        deslocamentoSemEventos(frame, i, &etapa->deslX[i], &etapa->deslY[i]);
+        etapa->raio[i] = raioDeProximidade(frame, i);
+        etapa->saida[i] = frameDeSaida(barcos->posX[i], barcos->posY[i], etapa->deslX[i], etapa->deslY[i],
+                                       latitudeMax, longitudeMax);
+        alcanceNoEixo(tipologia, barcos->velX[i], &etapa->minX[i], &etapa->maxX[i]);
+        alcanceNoEixo(tipologia, barcos->velY[i], &etapa->minY[i], &etapa->maxY[i]);
+        etapa->indice[barcos->navio[i]] = i;
+        etapa->preso[i] = 0;
+    }
+}
+
+/**
+ * @brief Último frame da etapa em que um barco livre ainda está no radar.
+ */
+static int ultimoFrameNoRadar(EtapaAvanco *etapa, int i) {
+    return etapa->saida[i] - 1 < etapa->janela ? etapa->saida[i] - 1 : etapa->janela;
+}
+
+/**
+ * @brief Indica se um barco livre pode chegar perto de um barco preso durante a etapa.
+ *
+ * O barco preso está, no frame t, entre p + t * min e p + t * max em cada eixo; o barco livre
+ * está em p + t * desl enquanto estiver no radar. Basta que a distância entre os dois chegue
+ * ao maior dos raios de proximidade (ou a zero, para as colisões) para o barco ficar preso.
+ *
+ * @param etapa Etapa atual.
+ * @param b Barco preso.
+ * @param j Barco livre.
+ * @return 1 se os barcos se podem aproximar, 0 caso contrário.
+ */
+static int alcancaBarco(EtapaAvanco *etapa, int b, int j) {
+    EntidadesIED *barcos = &etapa->frame->barcos;
+    long long qx = (long long) barcos->posX[j] - barcos->posX[b];
+    long long qy = (long long) barcos->posY[j] - barcos->posY[b];
+    int raio = etapa->raio[b] > etapa->raio[j] ? etapa->raio[b] : etapa->raio[j];
+    long long inicio = 0, fim = ultimoFrameNoRadar(etapa, j);
+
+    restringirDesigualdade((long long) etapa->minX[b] - etapa->deslX[j], qx + raio, &inicio, &fim);
+    restringirDesigualdade((long long) etapa->deslX[j] - etapa->maxX[b], raio - qx, &inicio, &fim);
+    restringirDesigualdade((long long) etapa->minY[b] - etapa->deslY[j], qy + raio, &inicio, &fim);
+    restringirDesigualdade((long long) etapa->deslY[j] - etapa->maxY[b], raio - qy, &inicio, &fim);
+    return inicio <= fim;
+}
+
+/**
+ * @brief Limita uma coordenada da caixa de um barco a uma margem de 5 casas à volta do radar.
+ */
+static int limitarAoRadar(long long coordenada, int dimensao) {
+    if (coordenada < -5) return -5;
+    if (coordenada > (long long) dimensao + 4) return dimensao + 4;
+    return (int) coordenada;
+}
+
+/**
+ * @brief Prende todos os barcos de uma etapa (todos são calculados passo a passo).
+ *
+ * @param etapa Etapa preparada com prepararEtapa.
+ * @param janela Número de frames da etapa.
+ */
+static void prenderTodos(EtapaAvanco *etapa, int janela) {
+    int n = etapa->frame->barcos.total;
+
+    etapa->janela = janela;
+    memset(etapa->preso, 1, (size_t) n);
+    etapa->numPresos = n;
+}
+
+/**
+ * @brief Separa os barcos de uma etapa em livres e presos.
+ *
+ * Os pares de barcos a comparar são encontrados numa grelha com a caixa de tudo o que cada
+ * barco pode alcançar na janela, alargada pelo seu raio. Os pares sem eventos no movimento
+ * linear ficam guardados: se um dos barcos ficar preso, o outro é verificado com alcancaBarco
+ * e pode ficar preso também, até não haver mais barcos a prender. Se a grelha tiver demasiadas
+ * entradas ou pares, a janela é reduzida a metade; se nem com JANELA_MINIMA frames isso deixa
+ * de acontecer, os barcos estão demasiado juntos e ficam todos presos.
+ *
+ * @param etapa Etapa preparada com prepararEtapa.
+ * @param janela Número de frames pedidos para a etapa.
+ * @param latitudeMax Número máximo de linhas da grelha.
+ * @param longitudeMax Número máximo de colunas da grelha.
+ * @return Número de frames da etapa (no máximo 'janela').
+ */
+static int separarBarcos(EtapaAvanco *etapa, int janela, int latitudeMax, int longitudeMax) {
+    EntidadesIED *barcos = &etapa->frame->barcos;
+    int n = barcos->total;
+    Arena *temporaria = arenaTemporaria();
+    int *x0, *x1, *y0, *y1;
+
+    if (n == 0) {
+        etapa->janela = janela;
+        return janela;
+    }
+
+    x0 = alocarArena(temporaria, (size_t) n * 4 * sizeof(int));
+    x1 = x0 + n;
+    y0 = x1 + n;
+    y1 = y0 + n;
+
+    while (1) {
+        MarcaArena marcaGrelha = marcarArena(temporaria);
+        long long extensao = 0, entradas = 0, maxPares = 0;
+        int lado, colunas, linhas, numCelulas, numPares = 0, numFila = 0;
+        int *inicioCelula, *livre, *indices, *pares, *inicioVizinhos, *vizinhos, *fila;
+
+        etapa->janela = janela;
+
+        // Caixa do que cada barco pode alcançar na janela, alargada pelo raio e limitada ao radar
+        for (int i = 0; i < n; i++) {
+            long long xa = barcos->posX[i] + (long long) janela * etapa->minX[i];
+            long long xb = barcos->posX[i] + (long long) janela * etapa->maxX[i];
+            long long ya = barcos->posY[i] + (long long) janela * etapa->minY[i];
+            long long yb = barcos->posY[i] + (long long) janela * etapa->maxY[i];
+
+            if (xa > barcos->posX[i]) xa = barcos->posX[i];
+            if (xb < barcos->posX[i]) xb = barcos->posX[i];
+            if (ya > barcos->posY[i]) ya = barcos->posY[i];
+            if (yb < barcos->posY[i]) yb = barcos->posY[i];
+
+            x0[i] = limitarAoRadar(xa - etapa->raio[i], longitudeMax);
+            x1[i] = limitarAoRadar(xb + etapa->raio[i], longitudeMax);
+            y0[i] = limitarAoRadar(ya - etapa->raio[i], latitudeMax);
+            y1[i] = limitarAoRadar(yb + etapa->raio[i], latitudeMax);
+            extensao += (x1[i] - x0[i]) + (y1[i] - y0[i]);
+        }
+
+        // Células do tamanho médio das caixas (a grelha começa em -5)
+        lado = (int) (extensao / (2LL * n)) + 1;
+        if (lado < CELULA_MINIMA) lado = CELULA_MINIMA;
+        colunas = (longitudeMax + 10) / lado + 1;
+        linhas = (latitudeMax + 10) / lado + 1;
+        numCelulas = colunas * linhas;
+
+        for (int i = 0; i < n; i++) {
+            x0[i] = (x0[i] + 5) / lado;
+            x1[i] = (x1[i] + 5) / lado;
+            y0[i] = (y0[i] + 5) / lado;
+            y1[i] = (y1[i] + 5) / lado;
+            entradas += (long long) (x1[i] - x0[i] + 1) * (y1[i] - y0[i] + 1);
+        }
+
+        if (entradas > (long long) CELULAS_POR_BARCO * n) {
+            restaurarArena(temporaria, marcaGrelha);
+            if (janela <= JANELA_MINIMA)
+                break;
+            janela /= 2;
+            continue;
+        }
+
+        inicioCelula = alocarArena(temporaria, (size_t) (numCelulas + 1) * sizeof(int));
+        livre = alocarArena(temporaria, (size_t) numCelulas * sizeof(int));
+        indices = alocarArena(temporaria, (size_t) entradas * sizeof(int));
+        memset(inicioCelula, 0, (size_t) (numCelulas + 1) * sizeof(int));
+
+        for (int i = 0; i < n; i++)
+            for (int cy = y0[i]; cy <= y1[i]; cy++)
+                for (int cx = x0[i]; cx <= x1[i]; cx++)
+                    inicioCelula[cy * colunas + cx + 1]++;
+        for (int c = 0; c < numCelulas; c++) {
+            long long k = inicioCelula[c + 1];
+            maxPares += k * (k - 1) / 2;
+            inicioCelula[c + 1] += inicioCelula[c];
+        }
+
+        // Demasiados barcos nas mesmas células: tenta-se uma janela mais curta
+        if (maxPares > (long long) PARES_POR_BARCO * n) {
+            restaurarArena(temporaria, marcaGrelha);
+            if (janela <= JANELA_MINIMA)
+                break;
+            janela /= 2;
+            continue;
+        }
+
+        memcpy(livre, inicioCelula, (size_t) numCelulas * sizeof(int));
+        for (int i = 0; i < n; i++)
+            for (int cy = y0[i]; cy <= y1[i]; cy++)
+                for (int cx = x0[i]; cx <= x1[i]; cx++)
+                    indices[livre[cy * colunas + cx]++] = i;
+
+        // Cada par é analisado só na célula do canto inferior da interseção das caixas; os pares
+        // com eventos no movimento linear ficam presos, os restantes guardados para depois
+        pares = alocarArena(temporaria, (size_t) (maxPares > 0 ? maxPares : 1) * 2 * sizeof(int));
+        for (int c = 0; c < numCelulas; c++) {
+            int cx = c % colunas, cy = c / colunas;
+
+            for (int a = inicioCelula[c]; a < inicioCelula[c + 1]; a++) {
+                int i = indices[a];
+
+                for (int b = a + 1; b < inicioCelula[c + 1]; b++) {
+                    int j = indices[b];
+                    int fim = janela - 1;
+
+                    if ((x0[i] > x0[j] ? x0[i] : x0[j]) != cx || (y0[i] > y0[j] ? y0[i] : y0[j]) != cy)
+                        continue;
+
+                    // Um evento no frame t (ainda com os dois no radar) muda o passo t + 1
+                    if (ultimoFrameNoRadar(etapa, i) < fim) fim = ultimoFrameNoRadar(etapa, i);
+                    if (ultimoFrameNoRadar(etapa, j) < fim) fim = ultimoFrameNoRadar(etapa, j);
+                    if (limiteDoPar(etapa->frame, i, j, etapa->deslX, etapa->deslY, etapa->raio, fim + 1) <= fim) {
+                        etapa->preso[i] = etapa->preso[j] = 1;
+                    } else {
+                        pares[2 * numPares] = i;
+                        pares[2 * numPares + 1] = j;
+                        numPares++;
+                    }
+                }
+            }
+        }
+
+        // Vizinhos de cada barco nos pares guardados
+        inicioVizinhos = alocarArena(temporaria, (size_t) (n + 1) * sizeof(int));
+        vizinhos = alocarArena(temporaria, (size_t) (numPares > 0 ? numPares : 1) * 2 * sizeof(int));
+        fila = alocarArena(temporaria, (size_t) n * sizeof(int));
+        memset(inicioVizinhos, 0, (size_t) (n + 1) * sizeof(int));
+        for (int p = 0; p < 2 * numPares; p++)
+            inicioVizinhos[pares[p] + 1]++;
+        for (int i = 0; i < n; i++)
+            inicioVizinhos[i + 1] += inicioVizinhos[i];
+        for (int p = 0; p < numPares; p++) {
+            vizinhos[inicioVizinhos[pares[2 * p]]++] = pares[2 * p + 1];
+            vizinhos[inicioVizinhos[pares[2 * p + 1]]++] = pares[2 * p];
+        }
+        for (int i = n; i > 0; i--)
+            inicioVizinhos[i] = inicioVizinhos[i - 1];
+        inicioVizinhos[0] = 0;
+
+        // Prende os barcos livres que podem chegar perto de um barco preso, até não haver mais
+        for (int i = 0; i < n; i++)
+            if (etapa->preso[i])
+                fila[numFila++] = i;
+        for (int f = 0; f < numFila; f++) {
+            int b = fila[f];
+
+            for (int v = inicioVizinhos[b]; v < inicioVizinhos[b + 1]; v++) {
+                int j = vizinhos[v];
+
+                if (!etapa->preso[j] && alcancaBarco(etapa, b, j)) {
+                    etapa->preso[j] = 1;
+                    fila[numFila++] = j;
+                }
+            }
+        }
+        etapa->numPresos = numFila;
+
+        restaurarArena(temporaria, marcaGrelha);
+        return janela;
+    }
+
+    prenderTodos(etapa, janela);
+    return janela;
+}
+
+/**
+ * @brief Acrescenta a um frame um barco livre da etapa, 'passos' frames depois do início.
+ *
+ * @param destino Frame onde o barco é acrescentado (com espaço reservado).
+ * @param etapa Etapa atual.
+ * @param i Índice do barco no frame inicial da etapa.
+ * @param passos Número de frames desde o início da etapa.
+ */
+static void colocarBarco(BaseDados *destino, EtapaAvanco *etapa, int i, int passos) {
+    EntidadesIED *de = &etapa->frame->barcos;
+    EntidadesIED *para = &destino->barcos;
+    int inicio = etapa->frame->frame_atual_num;
+    int k = para->total++;
+
+    para->posX[k] = de->posX[i] + passos * etapa->deslX[i];
+    para->posY[k] = de->posY[i] + passos * etapa->deslY[i];
+    para->velX[k] = de->velX[i];
+    para->velY[k] = de->velY[i];
+    para->navio[k] = de->navio[i];
+    para->flags[k] = de->flags[i];
+    if ((((inicio + passos) / 5 - inicio / 5) & 1) && etapa->frame->registo->navios[de->navio[i]].tipologia == 3)
+        para->flags[k] ^= BARCO_VISIVEL;
+}
+
+/**
+ * @brief Junta num frame os barcos presos e os barcos livres indicados, pela ordem do frame inicial.
+ *
+ * @param destino Frame a preencher (com espaço reservado e sem barcos).
+ * @param presos Frame com os barcos presos, pela ordem do frame inicial.
+ * @param etapa Etapa atual.
+ * @param livres Índices dos barcos livres, por ordem crescente.
+ * @param numLivres Número de barcos livres.
+ * @param passos Número de frames desde o início da etapa.
+ */
+static void juntarBarcos(BaseDados *destino, BaseDados *presos, EtapaAvanco *etapa, const int *livres, int numLivres,
+                         int passos) {
+    EntidadesIED *barcos = &presos->barcos;
+    int k = 0, q = 0;
+
+    while (k < barcos->total || q < numLivres) {
+        if (q == numLivres || (k < barcos->total && etapa->indice[barcos->navio[k]] < livres[q])) {
+            copiarEntidades(&destino->barcos, destino->barcos.total++, barcos, k, 1);
+            k++;
+        } else {
+            colocarBarco(destino, etapa, livres[q++], passos);
+        }
+    }
+}
+
+/**
+ * @brief Copia uma lista de colisões para a arena de um frame, acrescentando-a a outra lista.
+ *
+ * @param lista Colisões a copiar.
+ * @param frame Frame onde as cópias são alocadas.
+ * @param fim Ponteiro para o fim da lista de destino.
+ * @return O novo fim da lista de destino.
+ */
+static Colisao **copiarColisoes(Colisao *lista, BaseDados *frame, Colisao **fim) {
+    for (Colisao *colisao = lista; colisao != NULL; colisao = colisao->seguinte) {
+        Colisao *copia = alocarNoFrame(frame, sizeof(Colisao), MEMORIA_COLISOES);
+        BarcosEmColisao **fimBarcos = &copia->barcos;
+
+        copia->x = colisao->x;
+        copia->y = colisao->y;
+        copia->seguinte = NULL;
+        for (BarcosEmColisao *barco = colisao->barcos; barco != NULL; barco = barco->seguinte) {
+            BarcosEmColisao *copiaBarco = alocarNoFrame(frame, sizeof(BarcosEmColisao), MEMORIA_BARCOS_COLISAO);
+
+            copiaBarco->id = barco->id;
+            copiaBarco->seguinte = NULL;
+            *fimBarcos = copiaBarco;
+            fimBarcos = &copiaBarco->seguinte;
+        }
+
+        *fim = copia;
+        fim = &copia->seguinte;
+    }
+
+    return fim;
+}
+
+/**
+ * @brief Ordena chaves (frame de saída, índice) por ordem crescente.
+ */
+static int compararSaidas(const void *a, const void *b) {
+    long long x = *(const long long *) a;
+    long long y = *(const long long *) b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Regista no índice de trajetórias os barcos que estavam num frame da etapa e não estão no seguinte.
+ *
+ * @param etapa Etapa atual.
+ * @param antes Frame com os barcos presos, 'passo' frames depois do início da etapa.
+ * @param depois Frame seguinte, calculado a partir de 'antes'.
+ * @param visto Marca de cada barco da etapa (deve ser diferente de passo + 1 antes da chamada).
+ * @param passo Número de frames de 'antes' desde o início da etapa.
+ * @param trajetorias Índice de trajetórias a atualizar.
+ */
+static void registarDesaparecidos(EtapaAvanco *etapa, BaseDados *antes, BaseDados *depois, int *visto, int passo,
+                                  IndiceTrajetorias *trajetorias) {
+    EntidadesIED *barcos = &antes->barcos;
+    NoVessel *navios = antes->registo->navios;
+
+    for (int k = 0; k < depois->barcos.total; k++)
+        visto[etapa->indice[depois->barcos.navio[k]]] = passo + 1;
+
+    for (int k = 0; k < barcos->total; k++)
+        if (visto[etapa->indice[barcos->navio[k]]] != passo + 1)
+            registarSaidaTrajetoria(trajetorias, navios[barcos->navio[k]].id,
+                                    etapa->frame->frame_atual_num + passo, barcos->posX[k], barcos->posY[k]);
+}
+
+/**
+ * @brief Calcula o frame no fim de uma etapa, avançando passo a passo só os barcos presos.
+ *
+ * @param etapa Etapa já separada com separarBarcos.
+ * @param alvo Frame onde fica o resultado (criado a partir do frame inicial da etapa).
+ * @param donoColisoes Frame em cuja arena são copiadas as colisões.
+ * @param fimColisoes Fim da lista de colisões do avanço.
+ * @param latitudeMax Número máximo de linhas da grelha.
+ * @param longitudeMax Número máximo de colunas da grelha.
+ * @param showOutput Se for diferente de zero, imprime os barcos que saem do radar e as colisões.
+ * @param trajetorias Índice onde são registados os barcos que desaparecem durante a etapa (ou NULL).
+ * @return O novo fim da lista de colisões.
+ */
+static Colisao **executarEtapa(EtapaAvanco *etapa, BaseDados *alvo, BaseDados *donoColisoes, Colisao **fimColisoes,
+                               int latitudeMax, int longitudeMax, int showOutput, IndiceTrajetorias *trajetorias) {
+    BaseDados *frame = etapa->frame;
+    int n = frame->barcos.total;
+    int janela = etapa->janela;
+    int inicio = frame->frame_atual_num;
+    Arena *temporaria = arenaTemporaria();
+    MarcaArena marca = marcarArena(temporaria);
+    long long *chaves = alocarArena(temporaria, (size_t) (n > 0 ? n : 1) * sizeof(long long));
+    int *livres = alocarArena(temporaria, (size_t) (n > 0 ? n : 1) * sizeof(int));
+    int *visto = NULL;
+    BaseDados *atual = criarFrame(frame, etapa->numPresos);
+    BaseDados *outro = NULL, *entrada = NULL;
+    ProcuraEventos procura;
+    int numSaidas = 0, numLivres = 0, passo = 0, q = 0;
+
+    // Barcos presos, pela ordem original
+    atual->frame_atual_num = inicio;
+    for (int i = 0; i < n; i++)
+        if (etapa->preso[i])
+            copiarEntidades(&atual->barcos, atual->barcos.total++, &frame->barcos, i, 1);
+
+    // Barcos livres que saem do radar durante a etapa, por frame de saída e índice
+    for (int i = 0; i < n; i++)
+        if (!etapa->preso[i] && etapa->saida[i] <= janela)
+            chaves[numSaidas++] = (long long) etapa->saida[i] * n + i;
+    qsort(chaves, (size_t) numSaidas, sizeof(long long), compararSaidas);
+
+    // Os barcos livres estão no radar até ao frame antes da saída, em movimento linear
+    if (trajetorias != NULL) {
+        NoVessel *navios = frame->registo->navios;
+
+        visto = alocarArena(temporaria, (size_t) (n > 0 ? n : 1) * sizeof(int));
+        memset(visto, 0, (size_t) (n > 0 ? n : 1) * sizeof(int));
+        for (int i = 0; i < n; i++) {
+            int passos = etapa->saida[i] - 1;
+
+            if (etapa->preso[i] || etapa->saida[i] > janela)
+                continue;
+            registarSaidaTrajetoria(trajetorias, navios[frame->barcos.navio[i]].id, inicio + passos,
+                                    frame->barcos.posX[i] + passos * etapa->deslX[i],
+                                    frame->barcos.posY[i] + passos * etapa->deslY[i]);
+        }
+    }
+
+    iniciarProcuraEventos(&procura);
+    while (passo < janela) {
+        // Passo em que saem os próximos barcos livres (janela + 1 se não há mais)
+        int proxima = q < numSaidas ? (int) (chaves[q] / n) : janela + 1;
+        int ate = proxima - 1 < janela ? proxima - 1 : janela;
+        BaseDados *anterior = atual;
+        Colisao *colisoes;
+
+        if (passo < ate) {
+            int saltados;
+
+            // Sem barcos presos, não há nada a calcular até à próxima saída
+            if (atual->barcos.total == 0) {
+                passo = ate;
+                atual->frame_atual_num = inicio + passo;
+                continue;
+            }
+
+            saltados = saltoSemEventos(&procura, atual, ate - passo, latitudeMax, longitudeMax);
+            if (saltados > 0) {
+                outro = outro == NULL ? criarFrame(atual, atual->barcos.total)
+                                      : reciclarFrame(outro, atual, atual->barcos.total);
+                extrapolarFrame(atual, outro, saltados);
+                atual = outro;
+                outro = anterior;
+                passo += saltados;
+                continue;
+            }
+        } else {
+            // Os barcos livres que saem neste passo entram no cálculo, para as mensagens de debug
+            numLivres = 0;
+            while (q < numSaidas && chaves[q] / n == proxima)
+                livres[numLivres++] = (int) (chaves[q++] % n);
+
+            if (showOutput) {
+                entrada = entrada == NULL ? criarFrame(atual, atual->barcos.total + numLivres)
+                                          : reciclarFrame(entrada, atual, atual->barcos.total + numLivres);
+                entrada->frame_atual_num = atual->frame_atual_num;
+                juntarBarcos(entrada, atual, etapa, livres, numLivres, passo);
+                anterior = entrada;
+            }
+        }
+
+        outro = outro == NULL ? criarFrame(anterior, anterior->barcos.total)
+                              : reciclarFrame(outro, anterior, anterior->barcos.total);
+        colisoes = calcularFrameSeguinte(anterior, outro, latitudeMax, longitudeMax, showOutput);
+        fimColisoes = copiarColisoes(colisoes, donoColisoes, fimColisoes);
+        if (trajetorias != NULL)
+            registarDesaparecidos(etapa, atual, outro, visto, passo, trajetorias);
+        anterior = atual;
+        atual = outro;
+        outro = anterior;
+        passo++;
+    }
+
+    // Frame final: os barcos presos que sobreviveram e os livres que continuam no radar
+    numLivres = 0;
+    for (int i = 0; i < n; i++)
+        if (!etapa->preso[i] && etapa->saida[i] > janela)
+            livres[numLivres++] = i;
+    reservarEntidades(alvo, atual->barcos.total + numLivres);
+    alvo->barcos.total = 0;
+    alvo->frame_atual_num = inicio + janela;
+    juntarBarcos(alvo, atual, etapa, livres, numLivres, janela);
+
+    libertarFrame(atual);
+    if (outro != NULL) libertarFrame(outro);
+    if (entrada != NULL) libertarFrame(entrada);
+    restaurarArena(temporaria, marca);
+    return fimColisoes;
+}
+
+/**
+ * @brief Calcula diretamente o frame 'passos' frames depois de outro, com o mesmo resultado que passo a passo.
+ *
+ * O avanço é feito por etapas: em cada uma, os barcos que não interagem com nenhum outro são
+ * colocados diretamente na posição final (ou retirados, se saírem do radar pelo caminho) e só
+ * os restantes são calculados passo a passo. A janela das etapas duplica de cada vez, a menos
+ * que separarBarcos a tenha encurtado. Quando a maioria dos barcos fica presa, as etapas
+ * seguintes prendem logo todos os barcos, durante um número crescente de frames, antes de
+ * voltar a tentar separá-los. Os frames intermédios não são guardados; as colisões são
+ * copiadas para a arena do destino. O destino tem de ter sido criado a partir da origem e fica
+ * com o número origem + passos.
+ *
+ * @param origem Frame de partida (não é alterado).
+ * @param destino Frame a preencher.
+ * @param passos Número de frames a avançar (>= 1).
+ * @param latitudeMax Número máximo de linhas da grelha.
+ * @param longitudeMax Número máximo de colunas da grelha.
+ * @param showOutput Se for diferente de zero, imprime os barcos que saem do radar e as colisões de cada frame.
+ * @param trajetorias Índice onde são registados o último frame e a posição dos barcos que saem ou colidem
+ *                    pelo caminho (NULL se os frames já foram registados antes).
+ * @return Lista das colisões de todos os frames do avanço (alocada na arena do destino).
+ */
+Colisao *avancarDireto(BaseDados *origem, BaseDados *destino, int passos, int latitudeMax, int longitudeMax,
+                       int showOutput, IndiceTrajetorias *trajetorias) {
+    Colisao *colisoes = NULL;
+    Colisao **fimColisoes = &colisoes;
+    BaseDados *atual = origem;
+    BaseDados *intermedios[2] = {NULL, NULL};
+    Arena *temporaria = arenaTemporaria();
+    int janela = JANELA_INICIAL;
+    int espera = 0;             // Frames a calcular com todos os barcos presos antes de voltar a separá-los
+    int penalizacao = 0;        // Espera aplicada depois da última separação com a maioria dos barcos presos
+    int feitos = 0, proximo = 0;
+
+    while (feitos < passos) {
+        MarcaArena marca = marcarArena(temporaria);
+        int pedida = passos - feitos < janela ? passos - feitos : janela;
+        EtapaAvanco etapa;
+        BaseDados *alvo;
+        int usada;
+
+        prepararEtapa(&etapa, atual, latitudeMax, longitudeMax);
+        if (espera > 0) {
+            // Barcos demasiado juntos: separá-los custaria mais do que calculá-los todos
+            usada = passos - feitos < espera ? passos - feitos : espera;
+            prenderTodos(&etapa, usada);
+            espera -= usada;
+        } else {
+            usada = separarBarcos(&etapa, pedida, latitudeMax, longitudeMax);
+            if (usada < pedida)
+                janela = usada;
+            else if (janela <= INT_MAX / 2)
+                janela *= 2;
+
+            if (etapa.numPresos * 2 > atual->barcos.total) {
+                penalizacao = penalizacao == 0 ? JANELA_MINIMA : penalizacao * 2;
+                if (penalizacao > ESPERA_MAXIMA_PRESOS) penalizacao = ESPERA_MAXIMA_PRESOS;
+                espera = penalizacao;
+            } else {
+                penalizacao = 0;
+            }
+        }
+
+        // A última etapa escreve no destino; as outras alternam entre dois frames intermédios
+        if (feitos + usada == passos) {
+            alvo = destino;
+        } else {
+            alvo = intermedios[proximo] == NULL ? criarFrame(atual, atual->barcos.total)
+                                                : reciclarFrame(intermedios[proximo], atual, atual->barcos.total);
+            intermedios[proximo] = alvo;
+            proximo ^= 1;
+        }
+
+        fimColisoes = executarEtapa(&etapa, alvo, destino, fimColisoes, latitudeMax, longitudeMax, showOutput,
+                                    trajetorias);
+        restaurarArena(temporaria, marca);
+
+        atual = alvo;
+        feitos += usada;
+    }
+
+    if (intermedios[0] != NULL) libertarFrame(intermedios[0]);
+    if (intermedios[1] != NULL) libertarFrame(intermedios[1]);
+    return colisoes;
+}
@@ -0,0 +1,32 @@
+#ifndef EVENTOS_H
+#define EVENTOS_H
+
+// ================================================ EVENTOS ============================================================
+
+/**
+ * @brief Número de frames seguintes (até 'maximo') em que nenhum barco interage, sai do radar ou colide.
+ */
+int framesSemEventos(BaseDados *frame, int maximo, int latitudeMax, int longitudeMax);
+
+/**
+ * @brief Calcula diretamente um frame 'passos' frames à frente, dentro de um intervalo sem eventos.
+ */
+void extrapolarFrame(BaseDados *origem, BaseDados *destino, int passos);
+
+/**
+ * @brief Prepara a procura de frames sem eventos para um novo avanço.
+ */
+void iniciarProcuraEventos(ProcuraEventos *procura);
+
+/**
+ * @brief Número de frames sem eventos a saltar a partir do frame atual (0 se o seguinte tem de ser calculado).
+ */
+int saltoSemEventos(ProcuraEventos *procura, BaseDados *frame, int maximo, int latitudeMax, int longitudeMax);
+
+/**
+ * @brief Calcula diretamente o frame 'passos' frames à frente, calculando passo a passo só os barcos que interagem.
+ */
+Colisao *avancarDireto(BaseDados *origem, BaseDados *destino, int passos, int latitudeMax, int longitudeMax,
+                       int showOutput, IndiceTrajetorias *trajetorias);
+
+#endif //EVENTOS_H
@@ -0,0 +1,715 @@
+#include "modulo.h"
+
+// ================================================ HISTORICO ==========================================================
+
+// Distância por omissão entre frames-chave no modo delta
+#define INTERVALO_HISTORICO 64
+
+// Número de frames guardados por omissão no modo anel
+#define PROFUNDIDADE_HISTORICO 64
+
+/**
+ * @brief Liberta um frame materializado pelo histórico (o frame inicial nunca é libertado).
+ */
+static void largarFrame(ListaFrames *listaFrames, BaseDados *frame) {
+    if (frame != NULL && frame != listaFrames->head)
+        libertarFrame(frame);
+}
+
+/**
+ * @brief Garante espaço para o registo codificado do frame 'numFrame'.
+ */
+static FrameCodificado *novoRegisto(ListaFrames *listaFrames, int numFrame) {
+    FrameCodificado *registo;
+
+    if (numFrame >= listaFrames->capacidadeCodificados) {
+        int novaCapacidade = listaFrames->capacidadeCodificados ? listaFrames->capacidadeCodificados * 2 : 64;
+        FrameCodificado *novos;
+
+        while (novaCapacidade <= numFrame)
+            novaCapacidade *= 2;
+
+        novos = realloc(listaFrames->codificados, (size_t) novaCapacidade * sizeof(FrameCodificado));
+        if (!novos) {
+            perror("Erro ao alocar historico");
+            exit(1);
+        }
+        registarMemoria(MEMORIA_HISTORICO, (long long) (novaCapacidade - listaFrames->capacidadeCodificados) *
+                                           (long long) sizeof(FrameCodificado));
+        listaFrames->codificados = novos;
+        listaFrames->capacidadeCodificados = novaCapacidade;
+    }
+
+    registo = &listaFrames->codificados[numFrame];
+    memset(registo, 0, sizeof(FrameCodificado));
+    listaFrames->numCodificados = numFrame + 1;
+    return registo;
+}
+
+/**
+ * @brief Codifica um frame que deixou de ser o frame atual.
+ *
+ * Os frames múltiplos do intervalo são frames-chave e começam uma arena nova, onde ficam
+ * também as diferenças dos frames seguintes até ao próximo frame-chave. O frame inicial é
+ * um frame-chave sem dados: está sempre em memória (listaFrames->head).
+ *
+ * Os restantes são comparados com o frame anterior: cada barco do frame é procurado (pelo
+ * índice do navio) no frame anterior e, se estiver exatamente onde a previsão o coloca,
+ * não é guardado. Os barcos do frame anterior saltados pelo caminho ficam em 'removidos'.
+ *
+ * @param listaFrames Histórico onde o frame é guardado.
+ * @param frame Frame a codificar.
+ * @param anterior Frame anterior (ignorado nos frames-chave).
+ */
+static void codificarFrame(ListaFrames *listaFrames, BaseDados *frame, BaseDados *anterior) {
+    int intervalo = listaFrames->config.intervalo;
+    int numFrame = frame->frame_atual_num;
+    EntidadesIED *atual = &frame->barcos;
+    FrameCodificado *registo = novoRegisto(listaFrames, numFrame);
+    Arena *arena;
+    Arena *temp;
+    MarcaArena marcaTemp;
+    EntidadesIED *prev;
+    int *mapa;              // Índice de cada navio no frame anterior (-1 se não estiver)
+    int *removidos;
+    int *posicaoNovos;
+    int numNovos = 0;
+    int ultimo = -1;        // Último barco do frame anterior usado na previsão
+
+    registo->total = atual->total;
+
+    if (numFrame % intervalo == 0) {
+        registo->chave = 1;
+        registo->arena = obterArena();
+        registo->marca = marcarArena(registo->arena);
+
+        // O frame inicial está sempre em memória
+        if (numFrame == 0)
+            return;
+
+        reservarEntidadesNaArena(registo->arena, &registo->novos, atual->total);
+        copiarEntidades(&registo->novos, 0, atual, 0, atual->total);
+        registo->novos.total = atual->total;
+        return;
+    }
+
+    arena = listaFrames->codificados[numFrame - numFrame % intervalo].arena;
+    registo->marca = marcarArena(arena);
+    prev = &anterior->barcos;
+
+    temp = arenaTemporaria();
+    marcaTemp = marcarArena(temp);
+    mapa = alocarArena(temp, (size_t) frame->registo->total * sizeof(int));
+    removidos = alocarArena(temp, (size_t) (prev->total > 0 ? prev->total : 1) * sizeof(int));
+    posicaoNovos = alocarArena(temp, (size_t) (atual->total > 0 ? atual->total : 1) * sizeof(int));
+
+    for (int n = 0; n < frame->registo->total; n++)
+        mapa[n] = -1;
+    for (int j = 0; j < prev->total; j++)
+        mapa[prev->navio[j]] = j;
+
+    // Separa os barcos previstos dos que têm de ser guardados por inteiro
+    for (int k = 0; k < atual->total; k++) {
+        int j = mapa[atual->navio[k]];
+
+        if (j > ultimo &&
+            atual->posX[k] == prev->posX[j] + prev->velX[j] &&
+            atual->posY[k] == prev->posY[j] + prev->velY[j] &&
+            atual->velX[k] == prev->velX[j] && atual->velY[k] == prev->velY[j] &&
+            atual->flags[k] == prev->flags[j]) {
+            // Os barcos do frame anterior entre o último previsto e este não continuam
+            for (int q = ultimo + 1; q < j; q++)
+                removidos[registo->numRemovidos++] = q;
+            ultimo = j;
+        } else {
+            posicaoNovos[numNovos++] = k;
+        }
+    }
+    for (int q = ultimo + 1; q < prev->total; q++)
+        removidos[registo->numRemovidos++] = q;
+
+    // Copia para a arena do intervalo apenas o que é preciso
+    registo->removidos = alocarArena(arena, (size_t) registo->numRemovidos * sizeof(int));
+    memcpy(registo->removidos, removidos, (size_t) registo->numRemovidos * sizeof(int));
+    registo->posicaoNovos = alocarArena(arena, (size_t) numNovos * sizeof(int));
+    memcpy(registo->posicaoNovos, posicaoNovos, (size_t) numNovos * sizeof(int));
+
+    reservarEntidadesNaArena(arena, &registo->novos, numNovos);
+    for (int l = 0; l < numNovos; l++)
+        copiarEntidades(&registo->novos, l, atual, posicaoNovos[l], 1);
+    registo->novos.total = numNovos;
+
+    restaurarArena(temp, marcaTemp);
+}
+
+/**
+ * @brief Reconstrói um frame a partir do seu registo codificado.
+ *
+ * @param listaFrames Histórico de onde o frame é lido.
+ * @param numFrame Número do frame a reconstruir (> 0).
+ * @param anterior Frame numFrame - 1 (ignorado se numFrame for um frame-chave).
+ * @return Novo frame (a libertar com libertarFrame).
+ */
+static BaseDados *descodificarFrame(ListaFrames *listaFrames, int numFrame, BaseDados *anterior) {
+    FrameCodificado *registo = &listaFrames->codificados[numFrame];
+    EntidadesIED *prev;
+    EntidadesIED *novo;
+    BaseDados *frame;
+    int j = 0, r = 0, l = 0;
+
+    if (registo->chave) {
+        frame = criarFrame(listaFrames->head, registo->total);
+        frame->frame_atual_num = numFrame;
+        copiarEntidades(&frame->barcos, 0, &registo->novos, 0, registo->total);
+        frame->barcos.total = registo->total;
+        return frame;
+    }
+
+    frame = criarFrame(anterior, registo->total);
+    prev = &anterior->barcos;
+    novo = &frame->barcos;
+
+    for (int k = 0; k < registo->total; k++) {
+        // Entidade guardada por inteiro
+        if (l < registo->novos.total && registo->posicaoNovos[l] == k) {
+            copiarEntidades(novo, k, &registo->novos, l, 1);
+            l++;
+            continue;
+        }
+
+        // Próximo barco do frame anterior que segue a previsão
+        while (r < registo->numRemovidos && registo->removidos[r] == j) {
+            r++;
+            j++;
+        }
+        novo->posX[k] = prev->posX[j] + prev->velX[j];
+        novo->posY[k] = prev->posY[j] + prev->velY[j];
+        novo->velX[k] = prev->velX[j];
+        novo->velY[k] = prev->velY[j];
+        novo->navio[k] = prev->navio[j];
+        novo->flags[k] = prev->flags[j];
+        j++;
+    }
+    novo->total = registo->total;
+
+    return frame;
+}
+
+/**
+ * @brief Reconstrói um frame passado a partir do frame-chave mais próximo.
+ *
+ * @param listaFrames Histórico de onde o frame é lido.
+ * @param numFrame Número do frame (já codificado).
+ * @return O frame inicial, se numFrame for 0, ou um novo frame (a libertar com libertarFrame).
+ */
+static BaseDados *reconstruirFrame(ListaFrames *listaFrames, int numFrame) {
+    int chave = numFrame - numFrame % listaFrames->config.intervalo;
+    BaseDados *frame = chave == 0 ? listaFrames->head : descodificarFrame(listaFrames, chave, NULL);
+
+    for (int f = chave + 1; f <= numFrame; f++) {
+        BaseDados *seguinte = descodificarFrame(listaFrames, f, frame);
+        largarFrame(listaFrames, frame);
+        frame = seguinte;
+    }
+
+    return frame;
+}
+
+/**
+ * @brief Descarta os registos codificados dos frames >= numFrame.
+ */
+static void truncarCodificados(ListaFrames *listaFrames, int numFrame) {
+    int intervalo = listaFrames->config.intervalo;
+
+    if (numFrame >= listaFrames->numCodificados)
+        return;
+
+    // Os intervalos que começam a partir de numFrame são devolvidos de uma vez
+    for (int f = listaFrames->numCodificados - 1; f >= numFrame; f--) {
+        if (listaFrames->codificados[f].chave)
+            devolverArena(listaFrames->codificados[f].arena);
+    }
+
+    // No intervalo que fica a meio, recua a arena até ao início do frame numFrame
+    if (numFrame % intervalo != 0)
+        restaurarArena(listaFrames->codificados[numFrame - numFrame % intervalo].arena,
+                       listaFrames->codificados[numFrame].marca);
+
+    listaFrames->numCodificados = numFrame;
+}
+
+/**
+ * @brief Calcula, sem mostrar output, o frame seguinte a um frame do histórico.
+ */
+static BaseDados *simularFrameSeguinte(ListaFrames *listaFrames, BaseDados *frame) {
+    BaseDados *seguinte = criarFrame(frame, frame->barcos.total);
+
+    calcularFrameSeguinte(frame, seguinte, listaFrames->latitudeMax, listaFrames->longitudeMax, 0);
+    return seguinte;
+}
+
+/**
+ * @brief Descarta pontos de controlo até o histórico caber no limite de memória.
+ *
+ * Em cada passagem o intervalo entre pontos de controlo duplica e são libertados os que
+ * deixam de calhar num múltiplo do intervalo. Os frames alterados pelo utilizador não
+ * podem ser obtidos por simulação e por isso nunca são descartados.
+ */
+static void desbastarCheckpoints(ListaFrames *listaFrames) {
+    size_t limite = listaFrames->config.memoriaMaxima;
+
+    while (limite > 0 && listaFrames->memoriaCheckpoints > limite) {
+        int removiveis = 0;
+        int mantidos = 0;
+
+        for (int i = 0; i < listaFrames->numCheckpoints; i++)
+            removiveis += !listaFrames->checkpoints[i]->alterado;
+        if (removiveis == 0)
+            break;
+
+        listaFrames->config.intervalo *= 2;
+        for (int i = 0; i < listaFrames->numCheckpoints; i++) {
+            BaseDados *frame = listaFrames->checkpoints[i];
+
+            if (frame->alterado || frame->frame_atual_num % listaFrames->config.intervalo == 0) {
+                listaFrames->checkpoints[mantidos++] = frame;
+            } else {
+                listaFrames->memoriaCheckpoints -= memoriaArena(frame->arena);
+                libertarFrame(frame);
+            }
+        }
+        listaFrames->numCheckpoints = mantidos;
+    }
+}
+
+/**
+ * @brief Guarda um frame que deixou de ser o atual como ponto de controlo.
+ */
+static void guardarCheckpoint(ListaFrames *listaFrames, BaseDados *frame) {
+    if (listaFrames->numCheckpoints == listaFrames->capacidadeCheckpoints) {
+        int novaCapacidade = listaFrames->capacidadeCheckpoints ? listaFrames->capacidadeCheckpoints * 2 : 64;
+        BaseDados **novos = realloc(listaFrames->checkpoints, (size_t) novaCapacidade * sizeof(BaseDados *));
+        if (!novos) {
+            perror("Erro ao alocar historico");
+            exit(1);
+        }
+        registarMemoria(MEMORIA_HISTORICO, (long long) (novaCapacidade - listaFrames->capacidadeCheckpoints) *
+                                           (long long) sizeof(BaseDados *));
+        listaFrames->checkpoints = novos;
+        listaFrames->capacidadeCheckpoints = novaCapacidade;
+    }
+
+    frame->prev = NULL;
+    frame->next = NULL;
+    listaFrames->checkpoints[listaFrames->numCheckpoints++] = frame;
+    listaFrames->memoriaCheckpoints += memoriaArena(frame->arena);
+
+    desbastarCheckpoints(listaFrames);
+}
+
+/**
+ * @brief Liberta os pontos de controlo a partir da posição 'inicio' da lista.
+ */
+static void truncarCheckpoints(ListaFrames *listaFrames, int inicio) {
+    for (int i = inicio; i < listaFrames->numCheckpoints; i++) {
+        listaFrames->memoriaCheckpoints -= memoriaArena(listaFrames->checkpoints[i]->arena);
+        libertarFrame(listaFrames->checkpoints[i]);
+    }
+    if (inicio < listaFrames->numCheckpoints)
+        listaFrames->numCheckpoints = inicio;
+}
+
+/**
+ * @brief Frame mais recente do anel (o anel não pode estar vazio).
+ */
+static BaseDados *ultimoDoAnel(ListaFrames *listaFrames) {
+    return listaFrames->anel[(listaFrames->inicioAnel + listaFrames->numAnel - 1) % listaFrames->config.profundidade];
+}
+
+/**
+ * @brief Um frame que saiu do anel fica de reserva para o próximo frame, ou é libertado.
+ */
+static void descartarDoAnel(ListaFrames *listaFrames, BaseDados *frame) {
+    if (listaFrames->reserva == NULL)
+        listaFrames->reserva = frame;
+    else
+        libertarFrame(frame);
+}
+
+/**
+ * @brief Prepara o histórico de frames, com o frame inicial como único frame.
+ *
+ * O frame inicial é registado no índice de trajetórias, que acompanha o histórico a partir daqui.
+ *
+ * @param listaFrames Histórico a preparar (com a configuração já preenchida).
+ * @param frameInicial Frame 0 da simulação.
+ * @param latitudeMax Número máximo de linhas (para voltar a simular frames).
+ * @param longitudeMax Número máximo de colunas (para voltar a simular frames).
+ */
+void iniciarHistorico(ListaFrames *listaFrames, BaseDados *frameInicial, int latitudeMax, int longitudeMax) {
+    listaFrames->head = frameInicial;
+    listaFrames->tail = frameInicial;
+    listaFrames->total_frames = 0;
+    listaFrames->latitudeMax = latitudeMax;
+    listaFrames->longitudeMax = longitudeMax;
+    listaFrames->codificados = NULL;
+    listaFrames->numCodificados = 0;
+    listaFrames->capacidadeCodificados = 0;
+    listaFrames->checkpoints = NULL;
+    listaFrames->numCheckpoints = 0;
+    listaFrames->capacidadeCheckpoints = 0;
+    listaFrames->memoriaCheckpoints = 0;
+    listaFrames->anel = NULL;
+    listaFrames->inicioAnel = 0;
+    listaFrames->numAnel = 0;
+    listaFrames->reserva = NULL;
+    memset(&listaFrames->trajetorias, 0, sizeof(IndiceTrajetorias));
+    listaFrames->trajetorias.livre = -1;
+    registarFrameTrajetorias(&listaFrames->trajetorias, frameInicial);
+
+    if (listaFrames->config.intervalo <= 0)
+        listaFrames->config.intervalo = INTERVALO_HISTORICO;
+    if (listaFrames->config.profundidade <= 0)
+        listaFrames->config.profundidade = PROFUNDIDADE_HISTORICO;
+
+    // O anel é alocado uma única vez, com a profundidade pedida
+    if (listaFrames->config.modo == HISTORICO_ANEL) {
+        listaFrames->anel = malloc((size_t) listaFrames->config.profundidade * sizeof(BaseDados *));
+        if (!listaFrames->anel) {
+            perror("Erro ao alocar historico");
+            exit(1);
+        }
+        registarMemoria(MEMORIA_HISTORICO, (long long) listaFrames->config.profundidade *
+                                           (long long) sizeof(BaseDados *));
+    }
+}
+
+/**
+ * @brief Cria o frame seguinte a 'anterior', para ser depois acrescentado ao histórico.
+ *
+ * No modo anel reaproveita o frame que saiu do anel, sem alocar memória; nos outros
+ * modos é o mesmo que criarFrame.
+ *
+ * @param listaFrames Histórico de frames.
+ * @param anterior Frame atual (o último do histórico).
+ * @param capacidade Número de entidades a reservar.
+ * @return Novo frame, vazio.
+ */
+BaseDados *novoFrameHistorico(ListaFrames *listaFrames, BaseDados *anterior, int capacidade) {
+    BaseDados *reserva = listaFrames->reserva;
+
+    if (reserva == NULL)
+        return criarFrame(anterior, capacidade);
+
+    listaFrames->reserva = NULL;
+    return reciclarFrame(reserva, anterior, capacidade);
+}
+
+/**
+ * @brief Número do frame mais antigo, depois do frame 0, para onde ainda é possível recuar.
+ *
+ * Só o modo anel perde frames: nos outros todos os frames podem ser recuperados.
+ *
+ * @param listaFrames Histórico de frames.
+ * @return Número do frame (o frame 0 pode ser sempre recuperado).
+ */
+int primeiroFrameRecuperavel(ListaFrames *listaFrames) {
+    if (listaFrames->config.modo != HISTORICO_ANEL || listaFrames->numAnel == 0)
+        return 0;
+
+    return listaFrames->anel[listaFrames->inicioAnel]->frame_atual_num;
+}
+
+/**
+ * @brief Acrescenta um frame acabado de calcular ao fim do histórico.
+ *
+ * O frame passa a ser o último (frame atual) e é registado no índice de trajetórias.
+ * No histórico completo pode estar mais de um
+ * frame à frente do último: os frames pelo meio ficam implícitos e são simulados de novo
+ * a partir do último frame guardado quando forem pedidos. O que
+ * acontece ao frame que deixa de ser o atual depende do modo do histórico:
+ * - completo: fica ligado ao novo frame por prev/next;
+ * - delta: é codificado, e o frame antes dele deixa de estar em memória;
+ * - pontos de controlo: é guardado se calhar num múltiplo do intervalo ou tiver sido
+ *   alterado pelo utilizador (não pode ser obtido por simulação); senão é libertado;
+ * - anel: fica no anel, de onde sai o frame mais antigo quando o anel está cheio.
+ *
+ * @param listaFrames Histórico de frames.
+ * @param novo Frame seguinte ao último do histórico (ou um frame mais à frente, ver avancarFrame).
+ */
+void acrescentarFrame(ListaFrames *listaFrames, BaseDados *novo) {
+    BaseDados *ultimo = listaFrames->tail;
+
+    listaFrames->tail = novo;
+    listaFrames->total_frames = novo->frame_atual_num;
+    registarFrameTrajetorias(&listaFrames->trajetorias, novo);
+
+    switch (listaFrames->config.modo) {
+        case HISTORICO_DELTA:
+            // O último frame já não pode ser alterado: é codificado e o anterior sai de memória
+            codificarFrame(listaFrames, ultimo, ultimo->prev);
+            if (ultimo->prev != NULL && ultimo->prev != listaFrames->head) {
+                largarFrame(listaFrames, ultimo->prev);
+                ultimo->prev = NULL;
+            }
+            break;
+
+        case HISTORICO_CHECKPOINT:
+            // Só o frame inicial e o atual ficam ligados (sem prev/next entre eles)
+            novo->prev = NULL;
+            if (ultimo == listaFrames->head)
+                return;
+            if (ultimo->alterado || ultimo->frame_atual_num % listaFrames->config.intervalo == 0)
+                guardarCheckpoint(listaFrames, ultimo);
+            else
+                libertarFrame(ultimo);
+            return;
+
+        case HISTORICO_ANEL:
+            // Se o anel estiver cheio, o frame mais antigo fica de reserva para o próximo
+            novo->prev = NULL;
+            if (listaFrames->numAnel == listaFrames->config.profundidade) {
+                BaseDados *velho = listaFrames->anel[listaFrames->inicioAnel];
+                listaFrames->inicioAnel = (listaFrames->inicioAnel + 1) % listaFrames->config.profundidade;
+                listaFrames->numAnel--;
+                descartarDoAnel(listaFrames, velho);
+            }
+            listaFrames->anel[(listaFrames->inicioAnel + listaFrames->numAnel) % listaFrames->config.profundidade] =
+                    novo;
+            listaFrames->numAnel++;
+            return;
+
+        default:
+            break;
+    }
+
+    ultimo->next = novo;
+    novo->prev = ultimo;
+}
+
+/**
+ * @brief Torna um frame passado no frame atual, descartando todos os que vinham depois.
+ *
+ * Com o histórico completo basta recuar pelos ponteiros prev (e calcular o frame a partir do
+ * anterior com avancarDireto, se for um dos frames que não foram guardados). No modo delta, o frame
+ * (e o anterior, necessário para o codificar mais tarde) são reconstruídos a partir do
+ * frame-chave mais próximo. Com pontos de controlo, o frame é simulado de novo a partir
+ * do último ponto de controlo até ele; como a simulação é determinista e os frames
+ * alterados são sempre pontos de controlo, o resultado é igual ao frame original.
+ * No modo anel o frame tem de estar no anel ou ser o frame 0 (ver
+ * primeiroFrameRecuperavel). O índice de trajetórias é cortado no frame pretendido e os navios
+ * registados depois dele saem do registo (ver descartarNaviosFuturos).
+ *
+ * @param listaFrames Histórico de frames.
+ * @param numFrame Número do frame pretendido (entre 0 e o frame atual).
+ * @return O novo frame atual.
+ */
+BaseDados *recuarHistorico(ListaFrames *listaFrames, int numFrame) {
+    BaseDados *atual = listaFrames->tail;
+    BaseDados *anterior;
+    int ultimoCheckpoint = -1;
+
+    if (numFrame >= atual->frame_atual_num)
+        return atual;
+
+    switch (listaFrames->config.modo) {
+        case HISTORICO_COMPLETO:
+            while (atual->frame_atual_num > numFrame)
+                atual = atual->prev;
+
+            apagarFramesFuturos(&atual, listaFrames);
+
+            // O frame pretendido pode ser implícito: é calculado a partir do último frame guardado
+            if (atual->frame_atual_num < numFrame) {
+                BaseDados *frame = criarFrame(atual, atual->barcos.total);
+
+                avancarDireto(atual, frame, numFrame - atual->frame_atual_num, listaFrames->latitudeMax,
+                              listaFrames->longitudeMax, 0, NULL);
+                atual->next = frame;
+                frame->prev = atual;
+                atual = frame;
+            }
+            break;
+
+        case HISTORICO_DELTA:
+            // Os frames em memória (o atual e o anterior) vão ser todos substituídos
+            largarFrame(listaFrames, atual->prev);
+            largarFrame(listaFrames, atual);
+            listaFrames->head->next = NULL;
+
+            if (numFrame == 0) {
+                atual = listaFrames->head;
+            } else {
+                anterior = reconstruirFrame(listaFrames, numFrame - 1);
+                atual = descodificarFrame(listaFrames, numFrame, anterior);
+                anterior->next = atual;
+                atual->prev = anterior;
+            }
+
+            truncarCodificados(listaFrames, numFrame);
+            break;
+
+        case HISTORICO_CHECKPOINT:
+            largarFrame(listaFrames, atual);
+            listaFrames->head->next = NULL;
+
+            // Último ponto de controlo até ao frame pretendido
+            while (ultimoCheckpoint + 1 < listaFrames->numCheckpoints &&
+                   listaFrames->checkpoints[ultimoCheckpoint + 1]->frame_atual_num <= numFrame)
+                ultimoCheckpoint++;
+            truncarCheckpoints(listaFrames, ultimoCheckpoint + 1);
+
+            if (ultimoCheckpoint < 0) {
+                atual = listaFrames->head;
+            } else if (listaFrames->checkpoints[ultimoCheckpoint]->frame_atual_num == numFrame) {
+                // O próprio ponto de controlo volta a ser o frame atual
+                atual = listaFrames->checkpoints[ultimoCheckpoint];
+                listaFrames->memoriaCheckpoints -= memoriaArena(atual->arena);
+                listaFrames->numCheckpoints--;
+                break;
+            } else {
+                atual = listaFrames->checkpoints[ultimoCheckpoint];
+            }
+
+            // Simula de novo a partir do ponto de controlo (que fica guardado)
+            anterior = atual;
+            while (atual->frame_atual_num < numFrame) {
+                BaseDados *seguinte = simularFrameSeguinte(listaFrames, atual);
+                if (atual != anterior)
+                    largarFrame(listaFrames, atual);
+                atual = seguinte;
+            }
+            break;
+
+        case HISTORICO_ANEL:
+            // Retira do anel os frames depois do pretendido
+            while (listaFrames->numAnel > 0 && ultimoDoAnel(listaFrames)->frame_atual_num > numFrame) {
+                BaseDados *frame = ultimoDoAnel(listaFrames);
+                listaFrames->numAnel--;
+                descartarDoAnel(listaFrames, frame);
+            }
+
+            atual = listaFrames->numAnel > 0 ? ultimoDoAnel(listaFrames) : listaFrames->head;
+            break;
+    }
+
+    listaFrames->tail = atual;
+    listaFrames->total_frames = numFrame;
+    truncarTrajetorias(&listaFrames->trajetorias, atual);
+    descartarNaviosFuturos(atual->registo, atual->frame_atual_num);
+    return atual;
+}
+
+/**
+ * @brief Percorre por ordem todos os frames, do frame inicial ao atual.
+ *
+ * Nos modos delta e de pontos de controlo os frames passados são reconstruídos (ou
+ * simulados de novo) um a um, tal como os frames implícitos do histórico completo, pelo que
+ * o frame passado a 'visitar' só é válido durante essa chamada. No modo anel são visitados
+ * apenas o frame 0 e os frames do anel.
+ *
+ * @param listaFrames Histórico de frames.
+ * @param visitar Função chamada para cada frame.
+ * @param contexto Dados passados a 'visitar'.
+ */
+void percorrerHistorico(ListaFrames *listaFrames, VisitaFrame visitar, void *contexto) {
+    BaseDados *frame = listaFrames->head;
+    int temporario = 0;         // 1 se 'frame' foi criado aqui e tem de ser libertado
+    int proximoCheckpoint = 0;
+
+    if (listaFrames->config.modo == HISTORICO_COMPLETO) {
+        for (; frame != NULL; frame = frame->next) {
+            BaseDados *implicitos[2] = {NULL, NULL};
+            BaseDados *anterior = frame;
+
+            visitar(frame, contexto);
+
+            // Frames implícitos entre este e o seguinte, simulados um a um
+            for (int f = frame->frame_atual_num + 1; frame->next != NULL && f < frame->next->frame_atual_num; f++) {
+                BaseDados **implicito = &implicitos[f & 1];
+
+                if (*implicito == NULL)
+                    *implicito = criarFrame(anterior, anterior->barcos.total);
+                else
+                    *implicito = reciclarFrame(*implicito, anterior, anterior->barcos.total);
+                calcularFrameSeguinte(anterior, *implicito, listaFrames->latitudeMax, listaFrames->longitudeMax, 0);
+                visitar(*implicito, contexto);
+                anterior = *implicito;
+            }
+            if (implicitos[0] != NULL) libertarFrame(implicitos[0]);
+            if (implicitos[1] != NULL) libertarFrame(implicitos[1]);
+        }
+        return;
+    }
+
+    visitar(frame, contexto);
+    if (listaFrames->tail == frame)
+        return;
+
+    // No modo anel só existem os frames do anel
+    if (listaFrames->config.modo == HISTORICO_ANEL) {
+        for (int i = 0; i < listaFrames->numAnel; i++)
+            visitar(listaFrames->anel[(listaFrames->inicioAnel + i) % listaFrames->config.profundidade], contexto);
+        return;
+    }
+
+    // Frames passados (todos menos o atual)
+    for (int f = 1; f < listaFrames->tail->frame_atual_num; f++) {
+        BaseDados *seguinte;
+        int seguinteTemporario = 1;
+
+        if (listaFrames->config.modo == HISTORICO_DELTA) {
+            seguinte = descodificarFrame(listaFrames, f, frame);
+        } else if (proximoCheckpoint < listaFrames->numCheckpoints &&
+                   listaFrames->checkpoints[proximoCheckpoint]->frame_atual_num == f) {
+            seguinte = listaFrames->checkpoints[proximoCheckpoint++];
+            seguinteTemporario = 0;
+        } else {
+            seguinte = simularFrameSeguinte(listaFrames, frame);
+        }
+
+        if (temporario)
+            libertarFrame(frame);
+        frame = seguinte;
+        temporario = seguinteTemporario;
+        visitar(frame, contexto);
+    }
+    if (temporario)
+        libertarFrame(frame);
+
+    visitar(listaFrames->tail, contexto);
+}
+
+/**
+ * @brief Liberta os frames guardados no histórico.
+ *
+ * Deve ser chamada depois de recuar até ao frame inicial (ver rewindFrames).
+ *
+ * @param listaFrames Histórico de frames.
+ */
+void libertarHistorico(ListaFrames *listaFrames) {
+    truncarCodificados(listaFrames, 0);
+    registarMemoria(MEMORIA_HISTORICO, -(long long) listaFrames->capacidadeCodificados *
+                                       (long long) sizeof(FrameCodificado));
+    free(listaFrames->codificados);
+    listaFrames->codificados = NULL;
+    listaFrames->capacidadeCodificados = 0;
+
+    truncarCheckpoints(listaFrames, 0);
+    registarMemoria(MEMORIA_HISTORICO, -(long long) listaFrames->capacidadeCheckpoints *
+                                       (long long) sizeof(BaseDados *));
+    free(listaFrames->checkpoints);
+    listaFrames->checkpoints = NULL;
+    listaFrames->capacidadeCheckpoints = 0;
+
+    if (listaFrames->reserva != NULL)
+        libertarFrame(listaFrames->reserva);
+    listaFrames->reserva = NULL;
+    if (listaFrames->anel != NULL)
+        registarMemoria(MEMORIA_HISTORICO, -(long long) listaFrames->config.profundidade *
+                                           (long long) sizeof(BaseDados *));
+    free(listaFrames->anel);
+    listaFrames->anel = NULL;
+
+    libertarTrajetorias(&listaFrames->trajetorias);
+}
@@ -0,0 +1,46 @@
+#ifndef HISTORICO_H
+#define HISTORICO_H
+
+// ================================================ HISTORICO ==========================================================
+
+/**
+ * @brief Função chamada para cada frame ao percorrer o histórico.
+ */
+typedef void (*VisitaFrame)(BaseDados *frame, void *contexto);
+
+/**
+ * @brief Prepara o histórico com o frame inicial como único frame.
+ */
+void iniciarHistorico(ListaFrames *listaFrames, BaseDados *frameInicial, int latitudeMax, int longitudeMax);
+
+/**
+ * @brief Cria o frame seguinte ao frame atual (reaproveitando memória no modo anel).
+ */
+BaseDados *novoFrameHistorico(ListaFrames *listaFrames, BaseDados *anterior, int capacidade);
+
+/**
+ * @brief Número do frame mais antigo (além do frame 0) para onde ainda é possível recuar.
+ */
+int primeiroFrameRecuperavel(ListaFrames *listaFrames);
+
+/**
+ * @brief Acrescenta um novo frame ao fim do histórico (passa a ser o frame atual).
+ */
+void acrescentarFrame(ListaFrames *listaFrames, BaseDados *novo);
+
+/**
+ * @brief Volta ao frame indicado, descartando os seguintes. Retorna o novo frame atual.
+ */
+BaseDados *recuarHistorico(ListaFrames *listaFrames, int numFrame);
+
+/**
+ * @brief Percorre por ordem todos os frames, do inicial ao atual.
+ */
+void percorrerHistorico(ListaFrames *listaFrames, VisitaFrame visitar, void *contexto);
+
+/**
+ * @brief Liberta os frames guardados no histórico.
+ */
+void libertarHistorico(ListaFrames *listaFrames);
+
+#endif //HISTORICO_H
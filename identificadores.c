@@ -0,0 +1,298 @@
+#include "modulo.h"
+
+// ================================================ IDENTIFICADORES ====================================================
+
+/**
+ * @brief Aumenta um array do registo para 'nova' posições, contabilizando a memória em MEMORIA_NAVIOS.
+ *
+ * Em caso de falha de alocação, mostra o erro e termina o programa.
+ *
+ * @param array Array atual (pode ser NULL).
+ * @param antiga Número de posições do array atual.
+ * @param nova Número de posições pretendido.
+ * @param tamanho Tamanho de cada posição, em bytes.
+ * @return Ponteiro para o array aumentado.
+ */
+static void *crescerArrayRegisto(void *array, size_t antiga, size_t nova, size_t tamanho) {
+    void *novo = realloc(array, nova * tamanho);
+
+    if (!novo) {
+        perror("Erro ao alocar indice de navios");
+        exit(1);
+    }
+    registarMemoria(MEMORIA_NAVIOS, (long long) ((nova - antiga) * tamanho));
+    return novo;
+}
+
+/**
+ * @brief Calcula o valor de dispersão de um indicativo (FNV-1a de 32 bits).
+ *
+ * @param indicativo Indicativo do barco.
+ * @return Valor de dispersão.
+ */
+static unsigned int dispersarIndicativo(const char *indicativo) {
+    unsigned int h = 2166136261u;
+
+    for (const unsigned char *c = (const unsigned char *) indicativo; *c != '\0'; c++) {
+        h ^= *c;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief Procura a posição de um indicativo na tabela de dispersão (sondagem linear).
+ *
+ * @param registo Registo com a tabela (com pelo menos uma posição livre).
+ * @param indicativo Indicativo a procurar.
+ * @return Posição do indicativo, ou a posição livre onde deve ser inserido.
+ */
+static unsigned int posicaoNaTabela(const RegistoNavios *registo, const char *indicativo) {
+    unsigned int mascara = registo->capacidadeTabela - 1;
+    unsigned int p = dispersarIndicativo(indicativo) & mascara;
+
+    while (registo->tabelaIds[p] != 0 &&
+           strcmp(registo->identidades[registo->tabelaIds[p] - 1].indicativo, indicativo) != 0)
+        p = (p + 1) & mascara;
+    return p;
+}
+
+/**
+ * @brief Aumenta a tabela de dispersão para 'nova' posições e volta a inserir todos os ids.
+ *
+ * @param registo Registo cuja tabela cresce.
+ * @param nova Número de posições da nova tabela (potência de 2).
+ */
+static void crescerTabelaIds(RegistoNavios *registo, unsigned int nova) {
+    unsigned int antiga = registo->capacidadeTabela;
+
+    registarMemoria(MEMORIA_NAVIOS, -(long long) antiga * (long long) sizeof(unsigned int));
+    free(registo->tabelaIds);
+    registo->tabelaIds = calloc(nova, sizeof(unsigned int));
+    if (!registo->tabelaIds) {
+        perror("Erro ao alocar indice de navios");
+        exit(1);
+    }
+    registarMemoria(MEMORIA_NAVIOS, (long long) nova * (long long) sizeof(unsigned int));
+    registo->capacidadeTabela = nova;
+
+    for (unsigned int id = 0; id < registo->totalIds; id++)
+        registo->tabelaIds[posicaoNaTabela(registo, registo->identidades[id].indicativo)] = id + 1;
+}
+
+/**
+ * @brief Procura o id do barco com um indicativo, sem o criar.
+ *
+ * @param registo Registo de navios.
+ * @param indicativo Indicativo do barco.
+ * @param id Onde é escrito o id, se o barco existir.
+ * @return 1 se o indicativo já tem id, 0 caso contrário.
+ */
+int procurarIdNavio(const RegistoNavios *registo, const char *indicativo, unsigned int *id) {
+    unsigned int p;
+
+    if (registo->capacidadeTabela == 0)
+        return 0;
+
+    p = posicaoNaTabela(registo, indicativo);
+    if (registo->tabelaIds[p] == 0)
+        return 0;
+
+    *id = registo->tabelaIds[p] - 1;
+    return 1;
+}
+
+/**
+ * @brief Devolve o id do barco com um indicativo, atribuindo um id novo se ainda não existir.
+ *
+ * Os indicativos com mais de TAMANHO_INDICATIVO - 1 caracteres têm de ser rejeitados por quem lê
+ * os dados: truncá-los juntaria barcos diferentes no mesmo id, por isso aqui terminam o programa.
+ *
+ * @param registo Registo de navios.
+ * @param indicativo Indicativo do barco.
+ * @return Id do barco.
+ */
+unsigned int obterIdNavio(RegistoNavios *registo, const char *indicativo) {
+    unsigned int id;
+    unsigned int p = 0;
+    size_t tamanho = strlen(indicativo);
+
+    if (tamanho >= TAMANHO_INDICATIVO) {
+        fprintf(stderr, "Indicativo demasiado longo: %s\n", indicativo);
+        exit(1);
+    }
+
+    // Uma só sondagem: se o indicativo não existir, 'p' é a posição livre onde é inserido
+    if (registo->capacidadeTabela > 0) {
+        p = posicaoNaTabela(registo, indicativo);
+        if (registo->tabelaIds[p] != 0)
+            return registo->tabelaIds[p] - 1;
+    }
+
+    if (registo->totalIds == UINT_MAX) {
+        fprintf(stderr, "Demasiados barcos registados\n");
+        exit(1);
+    }
+
+    if (registo->totalIds == registo->capacidadeIds) {
+        unsigned int nova = registo->capacidadeIds ? registo->capacidadeIds * 2 : 16;
+
+        registo->identidades = crescerArrayRegisto(registo->identidades, registo->capacidadeIds, nova,
+                                                   sizeof(IdentidadeNavio));
+        registo->capacidadeIds = nova;
+    }
+
+    id = registo->totalIds++;
+    memcpy(registo->identidades[id].indicativo, indicativo, tamanho + 1);
+
+    // A tabela fica no máximo meio cheia, para que as sondagens sejam curtas
+    if (2 * registo->totalIds > registo->capacidadeTabela)
+        crescerTabelaIds(registo, registo->capacidadeTabela ? registo->capacidadeTabela * 2 : 64);
+    else
+        registo->tabelaIds[p] = id + 1;
+
+    return id;
+}
+
+/**
+ * @brief Prepara o registo para receber 'n' ids novos sem crescer a meio.
+ *
+ * Usada antes de carregar muitos barcos de uma vez (ver lerFicheiroInicial), para que a tabela
+ * de dispersão não seja reconstruída várias vezes durante o carregamento.
+ *
+ * @param registo Registo de navios.
+ * @param n Número de ids que ainda vão ser atribuídos (no máximo).
+ */
+void reservarIdsNavios(RegistoNavios *registo, unsigned int n) {
+    unsigned int total = registo->totalIds + n;
+    unsigned int tabela = registo->capacidadeTabela ? registo->capacidadeTabela : 64;
+
+    if (n == 0 || total < registo->totalIds || total > UINT_MAX / 4)
+        return;
+
+    if (total > registo->capacidadeIds) {
+        registo->identidades = crescerArrayRegisto(registo->identidades, registo->capacidadeIds, total,
+                                                   sizeof(IdentidadeNavio));
+        registo->capacidadeIds = total;
+    }
+
+    while (2 * total > tabela)
+        tabela *= 2;
+    if (tabela > registo->capacidadeTabela)
+        crescerTabelaIds(registo, tabela);
+}
+
+/**
+ * @brief Devolve o indicativo de um barco.
+ *
+ * @param registo Registo de navios.
+ * @param id Id do barco.
+ * @return Indicativo do barco (válido enquanto o registo existir).
+ */
+const char *indicativoNavio(const RegistoNavios *registo, unsigned int id) {
+    return registo->identidades[id].indicativo;
+}
+
+/**
+ * @brief Garante que o índice do frame cobre todos os ids atribuídos, marcando os novos como ausentes.
+ *
+ * @param registo Registo de navios.
+ */
+static void cobrirIdsNoIndice(RegistoNavios *registo) {
+    if (registo->totalIds > registo->capacidadeIndice) {
+        unsigned int nova = registo->capacidadeIndice ? registo->capacidadeIndice : 16;
+
+        while (nova < registo->totalIds)
+            nova *= 2;
+        registo->entidadePorId = crescerArrayRegisto(registo->entidadePorId, registo->capacidadeIndice, nova,
+                                                     sizeof(int));
+        registo->capacidadeIndice = nova;
+    }
+
+    for (unsigned int id = registo->idsIndexados; id < registo->totalIds; id++)
+        registo->entidadePorId[id] = -1;
+    registo->idsIndexados = registo->totalIds;
+}
+
+/**
+ * @brief Procura a entidade de um barco num frame.
+ *
+ * O índice id -> entidade do registo corresponde a um só frame. Se o frame pedido não for esse,
+ * o índice é reconstruído (uma passagem pelas entidades) e as procuras seguintes no mesmo frame
+ * são feitas em tempo constante. Se o barco aparecer mais do que uma vez no frame, é devolvida
+ * a primeira entidade.
+ *
+ * @param frame Frame onde procurar.
+ * @param id Id do barco.
+ * @return Índice da entidade do barco no frame, ou -1 se o barco não estiver no frame.
+ */
+int procurarEntidade(BaseDados *frame, unsigned int id) {
+    RegistoNavios *registo = frame->registo;
+    EntidadesIED *barcos = &frame->barcos;
+
+    if (registo->frameIndexado != frame) {
+        registo->idsIndexados = 0;
+        cobrirIdsNoIndice(registo);
+
+        // Do fim para o início, para que fique a primeira entidade de cada id
+        for (int i = barcos->total - 1; i >= 0; i--)
+            registo->entidadePorId[registo->navios[barcos->navio[i]].id] = i;
+        registo->frameIndexado = frame;
+    }
+
+    return id < registo->idsIndexados ? registo->entidadePorId[id] : -1;
+}
+
+/**
+ * @brief Acrescenta uma entidade nova ao índice, se o frame for o que está indexado.
+ *
+ * Chamada por adicionarEntidade, para que o índice continue válido quando se inserem barcos.
+ *
+ * @param frame Frame onde a entidade foi acrescentada.
+ * @param entidade Índice da entidade.
+ */
+void indexarEntidade(BaseDados *frame, int entidade) {
+    RegistoNavios *registo = frame->registo;
+    unsigned int id;
+
+    if (registo == NULL || registo->frameIndexado != frame)
+        return;
+
+    id = registo->navios[frame->barcos.navio[entidade]].id;
+    cobrirIdsNoIndice(registo);
+    if (registo->entidadePorId[id] == -1)
+        registo->entidadePorId[id] = entidade;
+}
+
+/**
+ * @brief Esquece o índice de um frame que vai ser libertado ou reaproveitado.
+ *
+ * @param frame Frame que deixa de ser válido.
+ */
+void invalidarIndice(const BaseDados *frame) {
+    if (frame->registo != NULL && frame->registo->frameIndexado == frame)
+        frame->registo->frameIndexado = NULL;
+}
+
+/**
+ * @brief Liberta as identidades, a tabela de dispersão e o índice do registo.
+ *
+ * @param registo Registo de navios.
+ */
+void libertarIdentificadores(RegistoNavios *registo) {
+    registarMemoria(MEMORIA_NAVIOS, -(long long) (registo->capacidadeIds * sizeof(IdentidadeNavio) +
+                                                  registo->capacidadeTabela * sizeof(unsigned int) +
+                                                  registo->capacidadeIndice * sizeof(int)));
+    free(registo->identidades);
+    free(registo->tabelaIds);
+    free(registo->entidadePorId);
+    registo->identidades = NULL;
+    registo->tabelaIds = NULL;
+    registo->entidadePorId = NULL;
+    registo->totalIds = 0;
+    registo->capacidadeIds = 0;
+    registo->capacidadeTabela = 0;
+    registo->idsIndexados = 0;
+    registo->capacidadeIndice = 0;
+    registo->frameIndexado = NULL;
+}
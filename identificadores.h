@@ -0,0 +1,46 @@
+#ifndef IDENTIFICADORES_H
+#define IDENTIFICADORES_H
+
+// ================================================ IDENTIFICADORES ====================================================
+
+/**
+ * @brief Procura o id de um indicativo. Retorna 1 se existir, 0 caso contrário.
+ */
+int procurarIdNavio(const RegistoNavios *registo, const char *indicativo, unsigned int *id);
+
+/**
+ * @brief Devolve o id de um indicativo, atribuindo um novo se ainda não existir. Termina se for demasiado longo.
+ */
+unsigned int obterIdNavio(RegistoNavios *registo, const char *indicativo);
+
+/**
+ * @brief Prepara o registo para receber 'n' ids novos sem crescer a meio.
+ */
+void reservarIdsNavios(RegistoNavios *registo, unsigned int n);
+
+/**
+ * @brief Devolve o indicativo de um barco.
+ */
+const char *indicativoNavio(const RegistoNavios *registo, unsigned int id);
+
+/**
+ * @brief Devolve o índice da entidade de um barco no frame, ou -1 se não estiver no frame.
+ */
+int procurarEntidade(BaseDados *frame, unsigned int id);
+
+/**
+ * @brief Atualiza o índice do registo com uma entidade acrescentada ao frame.
+ */
+void indexarEntidade(BaseDados *frame, int entidade);
+
+/**
+ * @brief Esquece o índice de um frame que vai ser libertado ou reaproveitado.
+ */
+void invalidarIndice(const BaseDados *frame);
+
+/**
+ * @brief Liberta as identidades, a tabela de dispersão e o índice do registo.
+ */
+void libertarIdentificadores(RegistoNavios *registo);
+
+#endif //IDENTIFICADORES_H
@@ -11,25 +11,27 @@
  * @param frame Ponteiro para o frame atual da simulação.
  */
 void imprimirFrameAtual(BaseDados *frame) {
-    EntidadeIED *atual = frame->barcos;
+    EntidadesIED *barcos;
+    NoVessel *navios;
     if (frame == NULL) return;
 
+    barcos = &frame->barcos;
+    navios = frame->registo->navios;
 
     printf("\nEstado do frame %d:\n", frame->frame_atual_num);
 
-    if (!atual) {
+    if (barcos->total == 0) {
         printf("(Sem navios no frame)\n");
         return;
     }
 
-    while (atual != NULL) {
-        printf("Barco %c: posicao (%d,%d), velocidade (%d,%d)\n",
-               atual->no_nautico->nome,
-               atual->posicao[0],
-               atual->posicao[1],
-               atual->velocidade[0],
-               atual->velocidade[1]);
-        atual = atual->seguinte;
+    for (int i = 0; i < barcos->total; i++) {
+        printf("Barco %s: posicao (%d,%d), velocidade (%d,%d)\n",
+               indicativoNavio(frame->registo, navios[barcos->navio[i]].id),
+               barcos->posX[i],
+               barcos->posY[i],
+               barcos->velX[i],
+               barcos->velY[i]);
     }
 }
 
@@ -43,7 +45,8 @@ void imprimirFrameAtual(BaseDados *frame) {
  * @param frame Ponteiro para o frame atual da simulação.
  */
 void imprimirBarcosDebug(BaseDados *frame) {
-    EntidadeIED *atual = frame->barcos;
+    EntidadesIED *barcos;
+    NoVessel *navios;
     char *tiposNomes[] = {
         "JonhDoe", // 0
         "ProfPaiMau", // 1
@@ -63,29 +66,67 @@ void imprimirBarcosDebug(BaseDados *frame) {
 
     if (frame == NULL) return;
 
+    barcos = &frame->barcos;
+    navios = frame->registo->navios;
+
     printf("\nFrame %d:\n", frame->frame_atual_num);
 
-    if (!atual) {
+    if (barcos->total == 0) {
         printf("(Sem navios no frame)\n");
         return;
     }
 
 
-    while (atual != NULL) {
+    for (int i = 0; i < barcos->total; i++) {
+        NoVessel *navio = &navios[barcos->navio[i]];
         char tipoNome[20];
-        strcpy(tipoNome, tiposNomes[atual->no_nautico->tipologia]);
+        strcpy(tipoNome, tiposNomes[navio->tipologia]);
 
 
-        printf("Barco %-3c | Tipo %-2d: %-12s | Pos %3d,%-5d | Vel %3d,%3d\n",
-               atual->no_nautico->nome,
-               atual->no_nautico->tipologia,
+        printf("Barco %-3s | Tipo %-2d: %-12s | Pos %3d,%-5d | Vel %3d,%3d\n",
+               indicativoNavio(frame->registo, navio->id),
+               navio->tipologia,
                tipoNome,
-               atual->posicao[0],
-               atual->posicao[1],
-               atual->velocidade[0],
-               atual->velocidade[1]);
-        atual = atual->seguinte;
+               barcos->posX[i],
+               barcos->posY[i],
+               barcos->velX[i],
+               barcos->velY[i]);
+    }
+}
+
+/**
+ * @brief Imprime uma colisão prevista.
+ *
+ * No formato de texto, mostra o frame, os barcos envolvidos e a posição em três linhas. No modo
+ * em lote, escreve uma única linha "colisao <frame> <x> <y> <barco> <barco> ...", com os
+ * indicativos dos barcos separados por espaços. Com SAIDA_NENHUMA não é impresso nada.
+ *
+ * @param registo Registo de navios, para obter os indicativos.
+ * @param frame Número do frame em que ocorre a colisão.
+ * @param x Posição x da colisão.
+ * @param y Posição y da colisão.
+ * @param barcos Ids dos barcos envolvidos, pela ordem de impressão.
+ * @param numBarcos Número de barcos envolvidos.
+ * @param formato Formato da saída.
+ */
+void imprimirColisaoPrevista(const RegistoNavios *registo, int frame, int x, int y, const unsigned int *barcos,
+                             int numBarcos, FormatoSaida formato) {
+    if (formato == SAIDA_NENHUMA)
+        return;
+    if (formato == SAIDA_LOTE) {
+        printf("colisao %d %d %d", frame, x, y);
+        for (int i = 0; i < numBarcos; i++)
+            printf(" %s", indicativoNavio(registo, barcos[i]));
+        printf("\n");
+        return;
+    }
+
+    printf("Frame %d\n    Colisão prevista entre barcos: ", frame);
+    for (int i = 0; i < numBarcos; i++) {
+        printf("%s", indicativoNavio(registo, barcos[i]));
+        if (i + 1 < numBarcos) printf(", ");
     }
+    printf("\n    Posicao prevista da colisao: (%d,%d) \n", x, y);
 }
 
 /**
@@ -100,6 +141,8 @@ void imprimirMenu(void) {
         "5. Velocidade media de um barco\n"
         "6. Visualizar movimento (Python)\n"
         "7. Toggle Debug\n"
+        "8. Metricas de desempenho e memoria\n"
+        "9. Guardar estado da simulacao\n"
         "0. Sair\n"
         "Escolha uma opcao: ");
 }
@@ -17,4 +17,10 @@ void imprimirMenu(void);
  */
 void imprimirFrameAtual(BaseDados *frame);
 
+/**
+ * @brief Imprime uma colisão prevista no formato pedido.
+ */
+void imprimirColisaoPrevista(const RegistoNavios *registo, int frame, int x, int y, const unsigned int *barcos,
+                             int numBarcos, FormatoSaida formato);
+
 #endif //IMPRESSAO_H
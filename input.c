@@ -1,7 +1,113 @@
 #include "modulo.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // ================================================ INPUT ==============================================================
 
+#define BLOCOS_LEITURA 4                   // Blocos em circulação entre a thread de leitura e a principal
+#define TAMANHO_MINIMO_PIPELINE (1 << 20)  // Ficheiros mais pequenos são lidos só na thread principal
+
+/*
+ * Estado da leitura do ficheiro inicial (ver lerFicheiroInicial). Em pipeline, a thread de leitura
+ * preenche os blocos da fila circular 'blocosLeitura' pela ordem do ficheiro e a thread principal
+ * insere-os no frame pela mesma ordem; sem pipeline é usado apenas o primeiro bloco.
+ */
+static pthread_mutex_t mutexLeitura = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t condBlocoCheio = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t condBlocoLivre = PTHREAD_COND_INITIALIZER;
+
+static BlocoLeitura *blocosLeitura = NULL;
+static int leituraEmPipeline = 0;
+static int blocosProduzidos = 0;         // Blocos entregues pela thread de leitura
+static int blocosConsumidos = 0;         // Blocos já inseridos no frame
+static int leituraTerminada = 0;         // A thread de leitura já entregou o último bloco
+
+static const char *ficheiroLeitura;      // Ficheiro a interpretar (e nome usado nas mensagens de erro)
+static const char *dadosLeitura;
+static const char *fimLeitura;
+
+/**
+ * @brief Devolve o valor de uma opção "--nome=valor", ou NULL se o argumento for outra opção.
+ *
+ * @param argumento Argumento da linha de comandos.
+ * @param nome Nome da opção, sem os "--".
+ * @return Ponteiro para o texto a seguir ao '=', dentro do próprio argumento.
+ */
+const char *valorOpcao(const char *argumento, const char *nome) {
+    size_t tamanho = strlen(nome);
+
+    if (strncmp(argumento, "--", 2) != 0 || strncmp(argumento + 2, nome, tamanho) != 0 ||
+        argumento[2 + tamanho] != '=')
+        return NULL;
+
+    return argumento + 3 + tamanho;
+}
+
+/**
+ * @brief Preenche a configuração do histórico com os valores por omissão (guarda todos os frames).
+ *
+ * @param historico Configuração a preencher.
+ */
+void iniciarConfigHistorico(ConfigHistorico *historico) {
+    historico->modo = HISTORICO_COMPLETO;
+    historico->intervalo = 0;
+    historico->memoriaMaxima = 0;
+    historico->profundidade = 0;
+}
+
+/**
+ * @brief Interpreta uma opção do histórico de frames (--historico, --intervalo, --memoria ou --profundidade).
+ *
+ * Um valor inválido termina o programa com erro (ver lerArgsMain).
+ *
+ * @param argumento Argumento da linha de comandos.
+ * @param historico Configuração do histórico a atualizar.
+ * @return 1 se o argumento é uma opção do histórico, 0 caso contrário.
+ */
+int lerOpcaoHistorico(const char *argumento, ConfigHistorico *historico) {
+    const char *valor;
+
+    if ((valor = valorOpcao(argumento, "historico")) != NULL) {
+        if (strcmp(valor, "completo") == 0) {
+            historico->modo = HISTORICO_COMPLETO;
+        } else if (strcmp(valor, "delta") == 0) {
+            historico->modo = HISTORICO_DELTA;
+        } else if (strcmp(valor, "checkpoint") == 0) {
+            historico->modo = HISTORICO_CHECKPOINT;
+        } else if (strcmp(valor, "anel") == 0) {
+            historico->modo = HISTORICO_ANEL;
+        } else {
+            fprintf(stderr, "Modo de histórico inválido: %s (completo, delta, checkpoint ou anel)\n", valor);
+            exit(1);
+        }
+    } else if ((valor = valorOpcao(argumento, "intervalo")) != NULL) {
+        historico->intervalo = atoi(valor);
+        if (historico->intervalo <= 0) {
+            fprintf(stderr, "Intervalo inválido: deve ser > 0\n");
+            exit(1);
+        }
+    } else if ((valor = valorOpcao(argumento, "memoria")) != NULL) {
+        int megabytes = atoi(valor);
+        if (megabytes <= 0) {
+            fprintf(stderr, "Limite de memória inválido: deve ser > 0 (MB)\n");
+            exit(1);
+        }
+        historico->memoriaMaxima = (size_t) megabytes * 1024 * 1024;
+    } else if ((valor = valorOpcao(argumento, "profundidade")) != NULL) {
+        historico->profundidade = atoi(valor);
+        if (historico->profundidade <= 0) {
+            fprintf(stderr, "Profundidade inválida: deve ser > 0\n");
+            exit(1);
+        }
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
 /**
  * @brief Processa e valida os argumentos da linha de comandos.
  *
@@ -9,6 +115,20 @@
  * incluindo o ficheiro de entrada, dimensões da grelha, número de frames a simular
  * e o ficheiro de saída. Valida também o número e o formato dos argumentos.
  *
+ * Depois dos quatro argumentos obrigatórios podem ser dadas opções do histórico de frames:
+ * - --historico=completo|delta|checkpoint|anel : guarda todos os frames, frames-chave e diferenças,
+ *   ou só pontos de controlo (os outros frames são simulados de novo quando são precisos);
+ * - --intervalo=K : distância entre frames-chave ou pontos de controlo;
+ * - --memoria=MB  : limite de memória dos pontos de controlo (o intervalo cresce para o cumprir);
+ * - --historico=anel e --profundidade=N : guarda apenas os últimos N frames (e o frame 0),
+ *   reaproveitando a memória dos mais antigos.
+ *
+ * A opção --lote=SCRIPT executa as operações do script em vez de mostrar o menu (ver executarLote).
+ * A opção --estado=FICHEIRO retoma uma simulação guardada (ver carregarEstado) em vez de ler o
+ * ficheiro de entrada; as dimensões da grelha e o histórico passam a ser os do ficheiro de estado.
+ * A opção --trajetoria=K escreve no ficheiro de saída um frame em cada K simulados, as colisões e
+ * os recuos, à medida que acontecem (ver abrirSaida), em vez de apenas o frame guardado por último.
+ *
  * @param argc Número de argumentos recebidos na linha de comandos.
  * @param argv Vetor de strings com os argumentos.
  * @param ficheiro_entrada Ponteiro para a string onde será guardado o nome do ficheiro de entrada.
@@ -16,21 +136,29 @@
  * @param colunas Ponteiro para inteiro onde será armazenado o número de colunas da grelha.
  * @param numFrames Ponteiro para inteiro onde será armazenado o número de frames a gerar.
  * @param ficheiro_saida Ponteiro para a string onde será guardado o nome do ficheiro de saída.
+ * @param historico Ponteiro para a configuração do histórico a preencher.
+ * @param ficheiro_lote Ponteiro para a string onde será guardado o script do modo em lote (NULL se não for dado).
+ * @param ficheiro_estado Ponteiro para a string onde será guardado o ficheiro de estado (NULL se não for dado).
+ * @param intervaloSaida Ponteiro para o intervalo entre os frames do registo contínuo (0 se não for dado).
  */
 void lerArgsMain(int argc, char *argv[],
                  char **ficheiro_entrada, int *linhas, int *colunas,
-                 int *numFrames, char **ficheiro_saida) {
+                 int *numFrames, char **ficheiro_saida, ConfigHistorico *historico, const char **ficheiro_lote,
+                 const char **ficheiro_estado, int *intervaloSaida) {
 
-    char *dimensoes_str = argv[2];
-    char *numFrames_str = argv[3];
-    *ficheiro_entrada = argv[1];
-    *ficheiro_saida = argv[4];
+    char *dimensoes_str;
+    char *numFrames_str;
 
-    if (argc != 5) {
-        fprintf(stderr, "Uso: %s <ficheiro_entrada> <dimensoes> <numero_frames> <ficheiro_saida>\n", argv[0]);
+    if (argc < 5) {
+        fprintf(stderr, "Uso: %s <ficheiro_entrada> <dimensoes> <numero_frames> <ficheiro_saida> [opcoes]\n",
+                argv[0]);
         exit(1);
     }
 
+    dimensoes_str = argv[2];
+    numFrames_str = argv[3];
+    *ficheiro_entrada = argv[1];
+    *ficheiro_saida = argv[4];
 
     *numFrames = atoi(numFrames_str);
     if (*numFrames < 0) {
@@ -43,100 +171,392 @@ void lerArgsMain(int argc, char *argv[],
         exit(1);
     }
 
-    printf("\n");
+    // Opções do histórico (por omissão guarda todos os frames)
+    iniciarConfigHistorico(historico);
+    *ficheiro_lote = NULL;
+    *ficheiro_estado = NULL;
+    *intervaloSaida = 0;
+    for (int i = 5; i < argc; i++) {
+        const char *valor;
+
+        if (lerOpcaoHistorico(argv[i], historico)) {
+            // Opção do histórico, já interpretada
+        } else if ((valor = valorOpcao(argv[i], "lote")) != NULL) {
+            *ficheiro_lote = valor;
+        } else if ((valor = valorOpcao(argv[i], "estado")) != NULL) {
+            *ficheiro_estado = valor;
+        } else if ((valor = valorOpcao(argv[i], "trajetoria")) != NULL) {
+            *intervaloSaida = atoi(valor);
+            if (*intervaloSaida <= 0) {
+                fprintf(stderr, "Intervalo da trajetória inválido: deve ser > 0\n");
+                exit(1);
+            }
+        } else {
+            fprintf(stderr, "Opção desconhecida: %s\n", argv[i]);
+            exit(1);
+        }
+    }
+
+    // No modo em lote só são impressos os resultados do script
+    if (*ficheiro_lote == NULL)
+        printf("\n");
+}
+
+/**
+ * @brief Indica se um carácter separa campos numa linha do ficheiro inicial.
+ */
+static int separadorDeCampos(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * @brief Lê um inteiro em base 10 (com sinal opcional) no início de um campo.
+ *
+ * @param p Início do campo.
+ * @param fim Fim da linha.
+ * @param valor Onde é escrito o valor lido.
+ * @return Ponteiro para o carácter a seguir ao inteiro, ou NULL se o campo não começar por
+ *         um inteiro ou se o valor não couber num int.
+ */
+static const char *lerInteiro(const char *p, const char *fim, int *valor) {
+    long long n = 0;
+    int negativo = 0;
+    const char *digitos;
+
+    if (p < fim && (*p == '-' || *p == '+')) {
+        negativo = *p == '-';
+        p++;
+    }
+
+    for (digitos = p; p < fim && *p >= '0' && *p <= '9'; p++) {
+        n = n * 10 + (*p - '0');
+        if (n > (long long) INT_MAX + 1)
+            return NULL;
+    }
+
+    if (p == digitos || (!negativo && n > INT_MAX))
+        return NULL;
+
+    *valor = (int) (negativo ? -n : n);
+    return p;
+}
+
+/**
+ * @brief Interpreta uma linha do ficheiro inicial: "INDICATIVO LAT LON ANGULO VELOCIDADE TIPO".
+ *
+ * Os campos são separados por espaços ou tabulações.
+ *
+ * @param p Início da linha.
+ * @param fim Fim da linha (o '\n' ou o fim do ficheiro).
+ * @param indicativo Onde é escrito o indicativo (com TAMANHO_INDICATIVO posições).
+ * @param valores Onde são escritos os cinco inteiros da linha.
+ * @param erro Onde é escrita a descrição do erro, se a linha for inválida.
+ * @return 1 se a linha tem um barco, 0 se estiver vazia, -1 se for inválida.
+ */
+static int interpretarLinha(const char *p, const char *fim, char *indicativo, int *valores, const char **erro) {
+    const char *inicio;
+
+    while (p < fim && separadorDeCampos(*p))
+        p++;
+    if (p == fim)
+        return 0;
+
+    // Indicativo
+    for (inicio = p; p < fim && !separadorDeCampos(*p); p++)
+        ;
+    if (p - inicio >= TAMANHO_INDICATIVO) {
+        *erro = "indicativo demasiado longo";
+        return -1;
+    }
+    memcpy(indicativo, inicio, (size_t) (p - inicio));
+    indicativo[p - inicio] = '\0';
+
+    // Latitude, longitude, ângulo, velocidade e tipo
+    for (int campo = 0; campo < 5; campo++) {
+        while (p < fim && separadorDeCampos(*p))
+            p++;
+        if (p == fim) {
+            *erro = "faltam campos";
+            return -1;
+        }
+        p = lerInteiro(p, fim, &valores[campo]);
+        if (p == NULL || (p < fim && !separadorDeCampos(*p))) {
+            *erro = "valor inteiro invalido";
+            return -1;
+        }
+    }
+
+    while (p < fim && separadorDeCampos(*p))
+        p++;
+    if (p != fim) {
+        *erro = "campos a mais";
+        return -1;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Regista os navios de um bloco e acrescenta as suas entidades ao frame, pela ordem do ficheiro.
+ *
+ * Um indicativo que já apareceu numa linha anterior identificaria dois barcos com o mesmo id, por
+ * isso a linha é indicada no stderr e ignorada, como as linhas inválidas.
+ *
+ * @param frame Frame onde os barcos são inseridos.
+ * @param bloco Bloco de barcos interpretados.
+ */
+static void inserirBloco(BaseDados *frame, const BlocoLeitura *bloco) {
+    for (int i = 0; i < bloco->total; i++) {
+        unsigned int conhecidos = frame->registo->totalIds;
+        unsigned int id = obterIdNavio(frame->registo, bloco->indicativo[i]);
+        int navio;
+
+        if (id < conhecidos) {
+            fprintf(stderr, "Linha %d de \"%s\" ignorada: indicativo repetido\n", bloco->linha[i], ficheiroLeitura);
+            continue;
+        }
+        navio = registarNavio(frame->registo, id, bloco->tipo[i], frame->frame_atual_num);
+
+        // Insere a entidade no fim dos arrays do frame (visível no radar)
+        adicionarEntidade(frame, bloco->posX[i], bloco->posY[i], bloco->velX[i], bloco->velY[i], navio,
+                          BARCO_VISIVEL);
+    }
+}
+
+/**
+ * @brief Devolve o próximo bloco a preencher, vazio.
+ *
+ * Em pipeline espera que a thread principal liberte uma posição da fila.
+ *
+ * @return Bloco a preencher.
+ */
+static BlocoLeitura *blocoParaPreencher(void) {
+    BlocoLeitura *bloco;
+
+    if (!leituraEmPipeline) {
+        bloco = &blocosLeitura[0];
+    } else {
+        pthread_mutex_lock(&mutexLeitura);
+        while (blocosProduzidos - blocosConsumidos == BLOCOS_LEITURA)
+            pthread_cond_wait(&condBlocoLivre, &mutexLeitura);
+        pthread_mutex_unlock(&mutexLeitura);
+        bloco = &blocosLeitura[blocosProduzidos % BLOCOS_LEITURA];
+    }
+
+    bloco->total = 0;
+    return bloco;
+}
+
+/**
+ * @brief Entrega o bloco preenchido: em pipeline passa-o à thread principal, senão insere-o logo no frame.
+ *
+ * @param frame Frame onde os barcos são inseridos (não usado em pipeline).
+ */
+static void entregarBloco(BaseDados *frame) {
+    if (!leituraEmPipeline) {
+        inserirBloco(frame, &blocosLeitura[0]);
+        return;
+    }
+
+    pthread_mutex_lock(&mutexLeitura);
+    blocosProduzidos++;
+    pthread_cond_signal(&condBlocoCheio);
+    pthread_mutex_unlock(&mutexLeitura);
+}
+
+/**
+ * @brief Interpreta todas as linhas do ficheiro inicial, preenchendo e entregando blocos de barcos.
+ *
+ * As linhas inválidas são indicadas no stderr, com o seu número e o motivo, e ignoradas.
+ *
+ * @param ficheiro Nome do ficheiro (para as mensagens de erro).
+ * @param dados Conteúdo do ficheiro.
+ * @param fim Fim do conteúdo.
+ * @param frame Frame onde os barcos são inseridos (NULL em pipeline).
+ */
+static void interpretarFicheiro(const char *ficheiro, const char *dados, const char *fim, BaseDados *frame) {
+    BlocoLeitura *bloco = blocoParaPreencher();
+    char indicativo[TAMANHO_INDICATIVO];
+    int valores[5];  // Latitude, longitude, ângulo, velocidade e tipo
+    const char *p = dados;
+    int numLinha = 0;
+
+    while (p < fim) {
+        const char *fimLinha = memchr(p, '\n', (size_t) (fim - p));
+        const char *erro = NULL;
+        int resultado;
+
+        if (fimLinha == NULL)
+            fimLinha = fim;
+        numLinha++;
+
+        resultado = interpretarLinha(p, fimLinha, indicativo, valores, &erro);
+        if (resultado < 0) {
+            fprintf(stderr, "Linha %d de \"%s\" ignorada: %s\n", numLinha, ficheiro, erro);
+        } else if (resultado > 0) {
+            int i = bloco->total;
+            double rad;
+
+            // Converte o angulo para rad e calcula as componentes da velocidade
+            rad = valores[2] * M_PI / 180.0;
+            memcpy(bloco->indicativo[i], indicativo, TAMANHO_INDICATIVO);
+            bloco->posX[i] = valores[1];
+            bloco->posY[i] = valores[0];
+            bloco->velX[i] = (int)(round(cos(rad) * valores[3]));
+            bloco->velY[i] = (int)(round(sin(rad) * valores[3]));
+            bloco->tipo[i] = valores[4];
+            bloco->linha[i] = numLinha;
+
+            if (++bloco->total == BARCOS_POR_BLOCO_LEITURA) {
+                entregarBloco(frame);
+                bloco = blocoParaPreencher();
+            }
+        }
+
+        p = fimLinha < fim ? fimLinha + 1 : fim;
+    }
+
+    entregarBloco(frame);
+}
+
+/**
+ * @brief Corpo da thread de leitura: interpreta o ficheiro e avisa a thread principal quando acaba.
+ */
+static void *lerEmSegundoPlano(void *argumento) {
+    (void) argumento;
+
+    interpretarFicheiro(ficheiroLeitura, dadosLeitura, fimLeitura, NULL);
+
+    pthread_mutex_lock(&mutexLeitura);
+    leituraTerminada = 1;
+    pthread_cond_signal(&condBlocoCheio);
+    pthread_mutex_unlock(&mutexLeitura);
+    return NULL;
+}
+
+/**
+ * @brief Insere no frame os blocos entregues pela thread de leitura, até ela terminar.
+ *
+ * @param frame Frame onde os barcos são inseridos.
+ */
+static void consumirBlocos(BaseDados *frame) {
+    for (;;) {
+        pthread_mutex_lock(&mutexLeitura);
+        while (blocosConsumidos == blocosProduzidos && !leituraTerminada)
+            pthread_cond_wait(&condBlocoCheio, &mutexLeitura);
+        if (blocosConsumidos == blocosProduzidos) {
+            pthread_mutex_unlock(&mutexLeitura);
+            return;
+        }
+        pthread_mutex_unlock(&mutexLeitura);
+
+        inserirBloco(frame, &blocosLeitura[blocosConsumidos % BLOCOS_LEITURA]);
+
+        pthread_mutex_lock(&mutexLeitura);
+        blocosConsumidos++;
+        pthread_cond_signal(&condBlocoLivre);
+        pthread_mutex_unlock(&mutexLeitura);
+    }
 }
 
 /**
  * @brief Lê os dados iniciais dos barcos a partir de um ficheiro de texto.
  *
- * Abre o ficheiro fornecido, interpreta cada linha com os dados de um barco
- * (ID, latitude, longitude, ângulo, velocidade, tipo), converte o ângulo e velocidade
- * em componentes de velocidade (vx, vy), e insere os barcos na lista ligada do frame.
+ * O ficheiro é mapeado em memória e interpretado linha a linha: cada linha tem os dados de um barco
+ * (indicativo, latitude, longitude, ângulo, velocidade, tipo). O ângulo e a velocidade são convertidos
+ * em componentes de velocidade (vx, vy), o navio é registado no registo do frame e a entidade é
+ * acrescentada aos arrays do frame. Os arrays e a tabela de ids do registo são reservados de uma só
+ * vez para o número de linhas do ficheiro. O indicativo pode ter até TAMANHO_INDICATIVO - 1
+ * caracteres e recebe um id na primeira vez que aparece (ver obterIdNavio).
  *
- * Em caso de erro na abertura do ficheiro ou alocação de memória, limpa a memória
- * previamente alocada e termina o programa com erro.
+ * Os ficheiros grandes (a partir de TAMANHO_MINIMO_PIPELINE, com mais de uma thread) são lidos em
+ * pipeline: uma thread interpreta o ficheiro em blocos de barcos enquanto a thread principal conta
+ * as linhas, faz as reservas e insere no frame os blocos já interpretados. Os barcos ficam no frame
+ * pela mesma ordem do ficheiro, com ou sem pipeline.
+ *
+ * As linhas vazias são ignoradas. Uma linha inválida é indicada no stderr, com o seu número e o
+ * motivo, e também é ignorada; a leitura continua na linha seguinte. O mesmo acontece a uma linha
+ * com um indicativo que já apareceu antes (fica o primeiro barco com esse indicativo).
+ *
+ * Em caso de erro na abertura do ficheiro, limpa a memória previamente alocada e
+ * termina o programa com erro.
  *
  * @param ficheiro Nome do ficheiro de entrada com os dados dos barcos.
  * @param frame Ponteiro para o frame onde os barcos serão inseridos.
  */
 void lerFicheiroInicial(const char *ficheiro, BaseDados *frame) {
-    // Variáveis para armazenar os dados do ficheiro
-    char id;
-    int lat, lon, angulo, velocidade, tipo;
-    double rad;
+    struct stat info;
+    const char *dados;
+    const char *p, *fim;
+    size_t tamanho;
+    pthread_t leitora;
+    int numBlocos;
+    int linhas = 1;
 
     // Abrir o ficheiro em modo de leitura
-    FILE *fp = fopen(ficheiro, "r");
+    int fd = open(ficheiro, O_RDONLY);
 
     // Se falhar, mostra erro, liberta a memória e termina o programa
-    if (fp == NULL) {
+    if (fd == -1 || fstat(fd, &info) == -1) {
         printf("\nErro ao abrir ficheiro \"%s\"\n", ficheiro);
         limparFrameInicial(frame);
         exit(1);
     }
 
-    // Lê cada linha do ficheiro
-    while (fscanf(fp, " %c %d %d %d %d %d", &id, &lat, &lon, &angulo, &velocidade, &tipo) == 6) {
-        int vx, vy;
+    // Um ficheiro vazio não pode ser mapeado (e não tem barcos)
+    tamanho = (size_t) info.st_size;
+    if (tamanho == 0) {
+        close(fd);
+        return;
+    }
 
-        // Alocar memoria para o navio (NoVessel)
-        NoVessel *navio = malloc(sizeof(NoVessel));
-        // Aloca memoria para a entidade no frame (EntidadeIED)
-        EntidadeIED *entidade = malloc(sizeof(EntidadeIED));
+    dados = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (dados == MAP_FAILED) {
+        perror("Erro ao mapear o ficheiro inicial");
+        close(fd);
+        limparFrameInicial(frame);
+        exit(1);
+    }
+    close(fd);
+    fim = dados + tamanho;
 
-        // Se nao conseguiu alocar memoria para o navio mostra erro e limpa
-        if (!navio) {
-            perror("Erro ao alocar navio");
-            fclose(fp);
-            limparFrameInicial(frame);
-            exit(1);
-        }
+    leituraEmPipeline = tamanho >= TAMANHO_MINIMO_PIPELINE && numeroThreads() > 1;
+    numBlocos = leituraEmPipeline ? BLOCOS_LEITURA : 1;
+    blocosLeitura = malloc((size_t) numBlocos * sizeof(BlocoLeitura));
+    if (!blocosLeitura) {
+        perror("Erro ao alocar blocos de leitura");
+        exit(1);
+    }
+    registarMemoria(MEMORIA_AUXILIAR, (long long) numBlocos * (long long) sizeof(BlocoLeitura));
 
-        // Se nao conseguiu alocar memoria para a entidade mostra erro e limpa
-        if (!entidade) {
-            perror("Erro ao alocar entidade");
-            free(navio);
-            fclose(fp);
-            limparFrameInicial(frame);
+    ficheiroLeitura = ficheiro;
+    if (leituraEmPipeline) {
+        dadosLeitura = dados;
+        fimLeitura = fim;
+        blocosProduzidos = 0;
+        blocosConsumidos = 0;
+        leituraTerminada = 0;
+        if (pthread_create(&leitora, NULL, lerEmSegundoPlano, NULL) != 0) {
+            perror("Erro ao criar thread");
             exit(1);
         }
+    }
 
-        // Preenche os dados do navio
-        navio->nome = id;
-        navio->tipologia = tipo;
-        navio->isVisible = 1;
-
-        // Converte o angulo para rad para calculos
-        rad = angulo * M_PI / 180.0;
-
-        // Calcular as componentes da velocidade
-        vx = (int)(round(cos(rad) * velocidade));
-        vy = (int)(round(sin(rad) * velocidade));
-
-        // Preenche os dados da entidade
-        entidade->posicao[0] = lon;
-        entidade->posicao[1] = lat;
-        entidade->velocidade[0] = vx;
-        entidade->velocidade[1] = vy;
-        entidade->no_nautico = navio;
-        entidade->seguinte = NULL;
-
-        // Insere a entidade no fim da lista de frames
+    // Reserva as entidades para todas as linhas, para que os arrays não sejam copiados ao crescer
+    for (p = dados; p < fim && (p = memchr(p, '\n', (size_t) (fim - p))) != NULL; p++)
+        linhas++;
+    reservarEntidades(frame, frame->barcos.total + linhas);
+    reservarIdsNavios(frame->registo, (unsigned int) linhas);
 
-        // Caso seja a primeira entidade
-        if (frame->barcos == NULL) {
-            frame->barcos = entidade;
-        }
-        // Caso contrario insere no fim
-        else {
-            EntidadeIED *atual = frame->barcos;
-            while (atual->seguinte != NULL) {
-                atual = atual->seguinte;
-            }
-            atual->seguinte = entidade;
-        }
+    if (leituraEmPipeline) {
+        consumirBlocos(frame);
+        pthread_join(leitora, NULL);
+    } else {
+        interpretarFicheiro(ficheiro, dados, fim, frame);
     }
 
-    // Fecha o ficheiro após ler tudo
-    fclose(fp);
+    registarMemoria(MEMORIA_AUXILIAR, -(long long) numBlocos * (long long) sizeof(BlocoLeitura));
+    free(blocosLeitura);
+    blocosLeitura = NULL;
+    munmap((void *) dados, tamanho);
 }
@@ -3,12 +3,28 @@
 
 // ================================================ INPUT ==============================================================
 
+/**
+ * @brief Devolve o valor de uma opção "--nome=valor", ou NULL se o argumento for outra opção.
+ */
+const char *valorOpcao(const char *argumento, const char *nome);
+
+/**
+ * @brief Preenche a configuração do histórico com os valores por omissão.
+ */
+void iniciarConfigHistorico(ConfigHistorico *historico);
+
+/**
+ * @brief Interpreta uma opção do histórico. Retorna 0 se o argumento for outra opção.
+ */
+int lerOpcaoHistorico(const char *argumento, ConfigHistorico *historico);
+
 /**
  * @brief Lê e valida argumentos da linha de comandos.
  */
 void lerArgsMain(int argc, char *argv[],
                  char **ficheiro_entrada, int *linhas, int *colunas,
-                 int *numFrames, char **ficheiro_saida);
+                 int *numFrames, char **ficheiro_saida, ConfigHistorico *historico, const char **ficheiro_lote,
+                 const char **ficheiro_estado, int *intervaloSaida);
 
 /**
  * @brief Lê os dados iniciais do ficheiro e preenche o frame 0.
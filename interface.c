@@ -6,8 +6,8 @@
  * @brief Pede ao utilizador o número de frames a avançar na simulação.
  *
  * Esta função lê do utilizador quantos frames deseja avançar e chama a função
- * `avancarFrame()` para atualizar a simulação. Após isso, limpa a memória
- * associada às colisões detetadas (que não são usadas nesta função).
+ * `avancarFrame()` para atualizar a simulação. As colisões detetadas não são usadas
+ * nesta função (a sua memória pertence aos frames criados).
  *
  * @param frameAtual Ponteiro para o ponteiro do frame atual da simulação.
  * @param listaFrames Ponteiro para a lista de todos os frames da simulação.
@@ -16,7 +16,6 @@
  */
 void pedeAtualizarSimulacao(BaseDados **frameAtual, ListaFrames *listaFrames, int latMax, int lonMax) {
     int numFrames;
-    Colisao *col;
 
     // Pede ao utilizador quantos frames deseja avançar
     printf("Quantos frames deseja avançar? ");
@@ -28,86 +27,106 @@ void pedeAtualizarSimulacao(BaseDados **frameAtual, ListaFrames *listaFrames, in
     }
 
     // Atualiza a simulação com base no numero de frames indicado.
-    // A função avancarFrame aloca memoria para as colisoes detetadas,
-    // mesmo que nao sejam necessárias aqui. Por isso, guardamos o retorno
-    // para libertar corretamente essa memoria logo de seguida.
-    col = avancarFrame(frameAtual, listaFrames, numFrames, latMax, lonMax, 1);
-
-    // Limpo a memoria das colisos que nao rpeciso aqui
-    while (col != NULL) {
-        Colisao *next = col->seguinte;
-
-        // Liberta a lista de barcos em colisão
-        BarcosEmColisao *b = col->barcos;
-        while (b != NULL) {
-            BarcosEmColisao *bNext = b->seguinte;
-            free(b);
-            b = bNext;
-        }
-
-        free(col);
-        col = next;
-    }
+    // As colisoes devolvidas vivem na arena de cada frame e sao libertadas com ele.
+    avancarFrame(frameAtual, listaFrames, numFrames, latMax, lonMax, 1);
 
     // Informa o utilizador qual o frame atual
     printf("Simulação atualizada para o frame %d\n", (*frameAtual)->frame_atual_num);
 }
 
 /**
- * @brief Pede ao utilizador o identificador de um barco e imprime as suas estatisticas.
+ * @brief Pede ao utilizador o indicativo de um barco e imprime as suas estatisticas.
  *
- * Lê o identificador de um barco e chama a função de cálculo da velocidade média
+ * Lê o indicativo de um barco e chama a função de cálculo da velocidade média
  * desde o frame inicial até ao frame atual.
  *
- * @param frameAtual Ponteiro para o ponteiro do frame atual.
+ * @param listaFrames Ponteiro para o histórico de frames.
  */
-void pedeVelocidadeBarco(BaseDados **frameAtual) {
+void pedeVelocidadeBarco(ListaFrames *listaFrames) {
     int sucesso;
-    char barco;
+    char barco[TAMANHO_INDICATIVO + 1];  // Mais um caracter para detetar indicativos demasiado longos
 
     printf("\n=== Velocidade Media de um Barco ===");
-    printf("\nNome do barco (uma letra): ");
-    sucesso = scanf(" %c", &barco);
+    printf("\nIndicativo do barco: ");
+    sucesso = scanf(" %16s", barco);
     if (sucesso != 1) {
-        printf("Nome invalido.\n");
+        printf("Indicativo invalido.\n");
+        while (getchar() != '\n');
+        return;
+    }
+    if (strlen(barco) >= TAMANHO_INDICATIVO) {
+        printf("Indicativo demasiado longo.\n");
+        while (getchar() != '\n');
+        return;
+    }
+
+    imprimirVelocidadeBarco(listaFrames, barco);
+}
+
+/**
+ * @brief Pede ao utilizador um ficheiro e guarda nele o estado da simulação.
+ *
+ * O utilizador escolhe se o histórico é guardado; sem ele, a simulação retomada começa no
+ * frame atual (ver guardarEstado).
+ *
+ * @param listaFrames Ponteiro para o histórico de frames.
+ */
+void pedeGuardarEstado(ListaFrames *listaFrames) {
+    char ficheiro[256];
+    char resposta;
+
+    printf("\n=== Guardar Estado da Simulacao ===");
+    printf("\nFicheiro: ");
+    if (scanf(" %255s", ficheiro) != 1) {
+        printf("Ficheiro invalido.\n");
         while (getchar() != '\n');
         return;
     }
 
-    imprimirVelocidadeBarco(frameAtual, barco);
+    printf("Guardar o historico? (s/n): ");
+    if (scanf(" %c", &resposta) != 1) {
+        while (getchar() != '\n');
+        resposta = 'n';
+    }
+
+    if (guardarEstado(ficheiro, listaFrames, resposta == 's' || resposta == 'S'))
+        printf("Estado guardado em %s (frame %d)\n", ficheiro, listaFrames->tail->frame_atual_num);
+    else
+        printf("Erro ao guardar o estado em %s\n", ficheiro);
 }
 
 /**
 * @brief Insere um novo barco ou altera um existente no frame atual.
 *
-* Esta função solicita ao utilizador os dados de uma embarcação (nome, posição,
+* Esta função solicita ao utilizador os dados de uma embarcação (indicativo, posição,
 * ângulo, velocidade e tipo). Se o barco já existir no frame atual (identificado
-* pelo nome), os seus dados são atualizados. Caso contrário, um novo barco é
-* alocado e inserido na lista ligada de embarcações do frame atual.
+* pelo indicativo), os seus dados são atualizados. Caso contrário, um novo navio é
+* registado e a sua entidade é acrescentada ao fim dos arrays do frame atual.
+* O frame fica marcado como alterado (não pode voltar a ser obtido por simulação).
+* A alteração em si é feita por colocarOuAlterarBarco.
 *
 * @param linhas Número máximo de linhas da grelha (limite da latitude).
 * @param colunas Número máximo de colunas da grelha (limite da longitude).
 * @param frameAtual Ponteiro para o frame atual onde será inserido ou alterado o barco.
+* @param listaFrames Histórico de frames (o seu índice de trajetórias é atualizado).
 */
-void inserirOuAlterarBarco(int linhas, int colunas, BaseDados *frameAtual) {
-    char barco;
+void inserirOuAlterarBarco(int linhas, int colunas, BaseDados *frameAtual, ListaFrames *listaFrames) {
+    char barco[TAMANHO_INDICATIVO + 1];  // Mais um caracter para detetar indicativos demasiado longos
     int lat, lon, angulo, velocidade, tipo;
-    int vx, vy;
-    double rad;
     int sucesso;
 
-    EntidadeIED *atual;
-    EntidadeIED *anterior;
-    NoVessel *novoNavio;
-    EntidadeIED *novaEntidade;
-
     printf("\n=== Inserir/Alterar Barco ===\n");
 
-    // Ler nome do barco
-    printf("Nome do barco (uma letra): ");
-    sucesso = scanf(" %c", &barco);
+    // Ler indicativo do barco
+    printf("Indicativo do barco: ");
+    sucesso = scanf(" %16s", barco);
     if (sucesso != 1) {
-        printf("Nome invalido.\n");
+        printf("Indicativo invalido.\n");
+        while (getchar() != '\n');
+        return;
+    }
+    if (strlen(barco) >= TAMANHO_INDICATIVO) {
+        printf("Indicativo demasiado longo.\n");
         while (getchar() != '\n');
         return;
     }
@@ -148,60 +167,67 @@ void inserirOuAlterarBarco(int linhas, int colunas, BaseDados *frameAtual) {
         return;
     }
 
+    if (colocarOuAlterarBarco(frameAtual, listaFrames, barco, lat, lon, angulo, velocidade, tipo))
+        printf("Barco %s alterado com sucesso.\n", barco);
+    else
+        printf("Barco %s adicionado com sucesso.\n", barco);
+}
+
+/**
+ * @brief Coloca um barco no frame, alterando-o se já existir.
+ *
+ * Os valores não são validados (ver inserirOuAlterarBarco). Se o barco já existir no frame
+ * (identificado pelo indicativo, procurado no índice do registo com procurarEntidade), a posição
+ * e a velocidade são atualizadas e, se o tipo mudar, é registado um novo navio. Caso contrário,
+ * é registado um navio novo e a sua entidade é acrescentada ao fim dos arrays do frame.
+ * O frame fica marcado como alterado e a trajetória do barco é atualizada.
+ *
+ * @param frame Frame onde é colocado o barco (o frame atual do histórico).
+ * @param listaFrames Histórico de frames.
+ * @param barco Indicativo do barco.
+ * @param lat Latitude (linha) da posição.
+ * @param lon Longitude (coluna) da posição.
+ * @param angulo Ângulo da direção, em graus.
+ * @param velocidade Velocidade, em casas por frame.
+ * @param tipo Tipo do barco (1-13).
+ * @return 1 se o barco já existia e foi alterado, 0 se foi adicionado.
+ */
+int colocarOuAlterarBarco(BaseDados *frame, ListaFrames *listaFrames, const char *barco, int lat, int lon,
+                          int angulo, int velocidade, int tipo) {
+    EntidadesIED *barcos = &frame->barcos;
+    unsigned int id = obterIdNavio(frame->registo, barco);
+    int i = procurarEntidade(frame, id);
+    double rad;
+    int vx, vy;
+    int novoNavio;
+
     // Calcular velocidade em x e y
     rad = angulo * M_PI / 180.0;
     vx = (int)(round(cos(rad) * velocidade));
     vy = (int)(round(sin(rad) * velocidade));
 
-    // Procurar barco existente na lista
-    atual = frameAtual->barcos;
-    anterior = NULL;
-    while (atual != NULL) {
-        // Se barco existe na lista atualizo os seus dados
-        if (atual->no_nautico->nome == barco) {
-            atual->posicao[0] = lon;
-            atual->posicao[1] = lat;
-            atual->velocidade[0] = vx;
-            atual->velocidade[1] = vy;
-            atual->no_nautico->tipologia = tipo;
-            printf("Barco %c alterado com sucesso.\n", barco);
-            return;
-        }
-        anterior = atual;
-        atual = atual->seguinte;
-    }
-
-    // Caso não exista, crio novo barco
-    novoNavio = malloc(sizeof(NoVessel));
-    if (!novoNavio) {
-        perror("Erro ao alocar navio");
-        exit(1);
-    }
-    novoNavio->nome = barco;
-    novoNavio->tipologia = tipo;
-    novoNavio->isVisible = 1;
-
-    // Criar nova entidade no frame
-    novaEntidade = malloc(sizeof(EntidadeIED));
-    if (!novaEntidade) {
-        perror("Erro ao alocar entidade");
-        exit(1);
-    }
-    novaEntidade->posicao[0] = lon;
-    novaEntidade->posicao[1] = lat;
-    novaEntidade->velocidade[0] = vx;
-    novaEntidade->velocidade[1] = vy;
-    novaEntidade->no_nautico = novoNavio;
-    novaEntidade->seguinte = NULL;
-
-    // Inserir no inicio da lista se for o primeiro, se não no fim
-    if (anterior == NULL) {
-        frameAtual->barcos = novaEntidade;
-    } else {
-        anterior->seguinte = novaEntidade;
+    frame->alterado = 1;
+
+    // Se barco existe no frame atualizo os seus dados
+    if (i >= 0) {
+        barcos->posX[i] = lon;
+        barcos->posY[i] = lat;
+        barcos->velX[i] = vx;
+        barcos->velY[i] = vy;
+
+        // Um novo tipo dá origem a um novo navio no registo, para que os frames
+        // anteriores (que podem voltar a ser simulados) mantenham o tipo antigo
+        if (frame->registo->navios[barcos->navio[i]].tipologia != tipo)
+            barcos->navio[i] = registarNavio(frame->registo, id, tipo, frame->frame_atual_num);
+        atualizarTrajetoria(&listaFrames->trajetorias, frame, i);
+        return 1;
     }
 
-    printf("Barco %c adicionado com sucesso.\n", barco);
+    // Caso não exista, registo novo navio e crio a sua entidade no fim do frame
+    novoNavio = registarNavio(frame->registo, id, tipo, frame->frame_atual_num);
+    i = adicionarEntidade(frame, lon, lat, vx, vy, novoNavio, BARCO_VISIVEL);
+    atualizarTrajetoria(&listaFrames->trajetorias, frame, i);
+    return 0;
 }
 
 /**
@@ -220,7 +246,48 @@ void rastrearHistoricoReverso(BaseDados **frameAtual, ListaFrames *listaFrames)
         steps = -1;
     }
 
-    rewindFrames(frameAtual, listaFrames, steps);
+    rewindFrames(frameAtual, listaFrames, steps, 1);
+}
+
+/**
+ * @brief Calcula as estatísticas de um barco desde o primeiro até ao último frame em que aparece.
+ *
+ * O primeiro e o último frame, e as posições nesses frames, vêm do índice de trajetórias do
+ * histórico, pelo que o custo não depende do número de frames nem de barcos. A distância é
+ * medida entre a primeira e a última posição e a velocidade média é essa distância a dividir
+ * pelo número de frames decorridos.
+ *
+ * @param listaFrames Ponteiro para o histórico de frames (o último é o frame atual).
+ * @param barco Indicativo do barco a analisar.
+ * @param stats Estrutura onde são escritas as estatísticas.
+ * @return 1 se o barco foi encontrado em algum frame, 0 caso contrário.
+ */
+int calcularEstatisticasBarco(ListaFrames *listaFrames, const char *barco, EstatisticasBarco *stats) {
+    float dx, dy;
+    int framesPercorridos;
+
+    stats->posInicialX = -1;
+    stats->posInicialY = -1;
+    stats->posAtualX = -1;
+    stats->posAtualY = -1;
+    stats->primeiroFrame = -1;
+    stats->ultimoFrame = -1;
+    stats->distancia = 0.0f;
+    stats->velocidadeMedia = 0.0f;
+
+    // Um indicativo sem id nunca apareceu em nenhum frame
+    if (!procurarIdNavio(listaFrames->tail->registo, barco, &stats->id))
+        return 0;
+
+    if (!consultarTrajetoria(&listaFrames->trajetorias, stats->id, stats))
+        return 0;
+
+    dx = stats->posAtualX - stats->posInicialX;
+    dy = stats->posAtualY - stats->posInicialY;
+    stats->distancia = sqrtf(dx * dx + dy * dy);
+    framesPercorridos = stats->ultimoFrame - stats->primeiroFrame;
+    stats->velocidadeMedia = (framesPercorridos > 0) ? stats->distancia / framesPercorridos : 0.0;
+    return 1;
 }
 
 /**
@@ -228,73 +295,29 @@ void rastrearHistoricoReverso(BaseDados **frameAtual, ListaFrames *listaFrames)
 *
 * Esta função localiza o barco especificado tanto no frame inicial (frame 0) como no frame atual,
 * calcula a distância percorrida com base na variação de posição, e divide pelo número de frames
-* decorridos para determinar a velocidade média em casas por frame.
+* decorridos para determinar a velocidade média em casas por frame (ver calcularEstatisticasBarco).
 *
-* @param frameAtual Ponteiro duplo para o frame atual da simulação.
-* @param barco Carácter identificador do barco a ser analisado.
+* @param listaFrames Ponteiro para o histórico de frames (o último é o frame atual).
+* @param barco Indicativo do barco a ser analisado.
 */
-void imprimirVelocidadeBarco(BaseDados **frameAtual, char barco) {
-    BaseDados *frameZero;
-    int posInicialX, posInicialY;
-    int posAtualX, posAtualY;
-    int primeiroFrame, ultimoFrame;
-    BaseDados *ptr;
-    EntidadeIED *b;
-    float dx, dy, distancia;
-    int framesPercorridos;
-    float velocidadeMedia;
+void imprimirVelocidadeBarco(ListaFrames *listaFrames, const char *barco) {
+    EstatisticasBarco stats;
 
-    if (frameAtual == NULL || *frameAtual == NULL) {
+    if (listaFrames == NULL || listaFrames->tail == NULL) {
         printf("Frame atual inválido.\n");
         return;
     }
 
-    frameZero = *frameAtual;
-    while (frameZero->prev != NULL)
-        frameZero = frameZero->prev;
-
-    posInicialX = -1;
-    posInicialY = -1;
-    posAtualX = -1;
-    posAtualY = -1;
-    primeiroFrame = -1;
-    ultimoFrame = -1;
-
-    ptr = frameZero;
-    while (ptr != NULL && ptr->frame_atual_num <= (*frameAtual)->frame_atual_num) {
-        b = ptr->barcos;
-        while (b != NULL) {
-            if (b->no_nautico->nome == barco) {
-                if (primeiroFrame == -1) {
-                    posInicialX = b->posicao[0];
-                    posInicialY = b->posicao[1];
-                    primeiroFrame = ptr->frame_atual_num;
-                }
-                posAtualX = b->posicao[0];
-                posAtualY = b->posicao[1];
-                ultimoFrame = ptr->frame_atual_num;
-            }
-            b = b->seguinte;
-        }
-        ptr = ptr->next;
-    }
-
-    if (primeiroFrame == -1) {
-        printf("Barco %c não encontrado em nenhum frame.\n", barco);
+    if (!calcularEstatisticasBarco(listaFrames, barco, &stats)) {
+        printf("Barco %s não encontrado em nenhum frame.\n", barco);
         return;
     }
 
-    dx = posAtualX - posInicialX;
-    dy = posAtualY - posInicialY;
-    distancia = sqrtf(dx * dx + dy * dy);
-    framesPercorridos = ultimoFrame - primeiroFrame;
-    velocidadeMedia = (framesPercorridos > 0) ? distancia / framesPercorridos : 0.0;
-
-    printf("\nEstatísticas do barco %c:\n", barco);
-    printf("Frame inicial: %d\n", primeiroFrame);
-    printf("Frame final: %d\n", ultimoFrame);
-    printf("Posição inicial: (%d, %d)\n", posInicialX, posInicialY);
-    printf("Posição atual: (%d, %d)\n", posAtualX, posAtualY);
-    printf("Distância percorrida: %.2f casas\n", distancia);
-    printf("Velocidade média: %.2f casas/frame\n", velocidadeMedia);
+    printf("\nEstatísticas do barco %s:\n", barco);
+    printf("Frame inicial: %d\n", stats.primeiroFrame);
+    printf("Frame final: %d\n", stats.ultimoFrame);
+    printf("Posição inicial: (%d, %d)\n", stats.posInicialX, stats.posInicialY);
+    printf("Posição atual: (%d, %d)\n", stats.posAtualX, stats.posAtualY);
+    printf("Distância percorrida: %.2f casas\n", stats.distancia);
+    printf("Velocidade média: %.2f casas/frame\n", stats.velocidadeMedia);
 }
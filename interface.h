@@ -6,17 +6,33 @@
 /**
  * @brief Pergunta por um barco e imprime a velocidade média.
  */
-void pedeVelocidadeBarco(BaseDados **frameAtual);
+void pedeVelocidadeBarco(ListaFrames *listaFrames);
 
 /**
  * @brief Calcula e imprime a velocidade média de um barco.
  */
-void imprimirVelocidadeBarco(BaseDados **frameAtual, char barco);
+void imprimirVelocidadeBarco(ListaFrames *listaFrames, const char *barco);
+
+/**
+ * @brief Calcula as estatísticas de um barco ao longo do histórico. Retorna 0 se não for encontrado.
+ */
+int calcularEstatisticasBarco(ListaFrames *listaFrames, const char *barco, EstatisticasBarco *stats);
+
+/**
+ * @brief Pergunta por um ficheiro e guarda nele o estado da simulação.
+ */
+void pedeGuardarEstado(ListaFrames *listaFrames);
 
 /**
  * @brief Função para pedir os dados ao utilizador e inserir/alterar barco.
  */
-void inserirOuAlterarBarco(int lat, int lon, BaseDados *frameAtual);
+void inserirOuAlterarBarco(int lat, int lon, BaseDados *frameAtual, ListaFrames *listaFrames);
+
+/**
+ * @brief Coloca ou altera um barco num frame. Retorna 1 se o barco já existia.
+ */
+int colocarOuAlterarBarco(BaseDados *frame, ListaFrames *listaFrames, const char *barco, int lat, int lon,
+                          int angulo, int velocidade, int tipo);
 
 /**
  * @brief Pergunta ao utilizador quantos frames deve avançar.
@@ -0,0 +1,239 @@
+#include "modulo.h"
+
+// ================================================ LOTE ===============================================================
+
+#define LINHA_MAXIMA 256  // Tamanho máximo de uma linha do script
+
+/**
+ * @brief Escreve a linha de erro de um comando do script.
+ *
+ * @param linha Número da linha do script (a começar em 1).
+ * @param mensagem Descrição do erro.
+ */
+static void erroLote(int linha, const char *mensagem) {
+    printf("erro %d %s\n", linha, mensagem);
+}
+
+/**
+ * @brief Verifica se uma linha lida com fgets ficou completa e, se não ficou, descarta o resto dela.
+ *
+ * @param texto Linha lida.
+ * @param fp Script.
+ * @return 1 se a linha cabia no buffer, 0 se era mais longa (o resto da linha já foi lido).
+ */
+static int linhaCompleta(const char *texto, FILE *fp) {
+    int c;
+
+    if (strchr(texto, '\n') != NULL)
+        return 1;
+
+    // Sem '\n': ou o script acabou, ou a linha não coube no buffer
+    c = getc(fp);
+    if (c == EOF || c == '\n')
+        return 1;
+    while (c != EOF && c != '\n')
+        c = getc(fp);
+    return 0;
+}
+
+/**
+ * @brief Executa o comando "barco NOME LAT LON ANGULO VELOCIDADE TIPO".
+ *
+ * Os valores são validados com as mesmas regras que no menu (ver inserirOuAlterarBarco).
+ *
+ * @param argumentos Texto da linha a seguir ao comando.
+ * @param linha Número da linha do script.
+ * @param frameAtual Frame onde o barco é colocado.
+ * @param listaFrames Histórico de frames.
+ * @param latitudeMax Número máximo de linhas da grelha.
+ * @param longitudeMax Número máximo de colunas da grelha.
+ */
+static void comandoBarco(const char *argumentos, int linha, BaseDados *frameAtual, ListaFrames *listaFrames,
+                         int latitudeMax, int longitudeMax) {
+    char barco[TAMANHO_INDICATIVO + 1];  // Mais um caracter para detetar indicativos demasiado longos
+    int lat, lon, angulo, velocidade, tipo;
+    int lidos;
+
+    if (sscanf(argumentos, " %16s%n", barco, &lidos) != 1) {
+        erroLote(linha, "argumentos invalidos");
+        return;
+    }
+    if (strlen(barco) >= TAMANHO_INDICATIVO) {
+        erroLote(linha, "indicativo demasiado longo");
+        return;
+    }
+    if (sscanf(argumentos + lidos, "%d %d %d %d %d", &lat, &lon, &angulo, &velocidade, &tipo) != 5) {
+        erroLote(linha, "argumentos invalidos");
+        return;
+    }
+    if (lat < 0 || lon < 0 || lat >= latitudeMax || lon >= longitudeMax) {
+        erroLote(linha, "posicao invalida");
+        return;
+    }
+    if (angulo % 45 != 0 || angulo < 0 || angulo >= 360) {
+        erroLote(linha, "angulo invalido");
+        return;
+    }
+    if (velocidade < 0) {
+        erroLote(linha, "velocidade invalida");
+        return;
+    }
+    if (tipo < 1 || tipo > 13) {
+        erroLote(linha, "tipo invalido");
+        return;
+    }
+
+    if (colocarOuAlterarBarco(frameAtual, listaFrames, barco, lat, lon, angulo, velocidade, tipo))
+        printf("barco alterado %s\n", barco);
+    else
+        printf("barco adicionado %s\n", barco);
+}
+
+/**
+ * @brief Executa o comando "estatisticas NOME".
+ *
+ * Escreve "estatisticas <indicativo> <frame inicial> <frame final> <x inicial> <y inicial> <x final>
+ * <y final> <distancia> <velocidade media>".
+ *
+ * @param argumentos Texto da linha a seguir ao comando.
+ * @param linha Número da linha do script.
+ * @param listaFrames Histórico de frames.
+ */
+static void comandoEstatisticas(const char *argumentos, int linha, ListaFrames *listaFrames) {
+    EstatisticasBarco stats;
+    char barco[TAMANHO_INDICATIVO + 1];  // Mais um caracter para detetar indicativos demasiado longos
+
+    if (sscanf(argumentos, " %16s", barco) != 1) {
+        erroLote(linha, "argumentos invalidos");
+        return;
+    }
+    if (strlen(barco) >= TAMANHO_INDICATIVO) {
+        erroLote(linha, "indicativo demasiado longo");
+        return;
+    }
+    if (!calcularEstatisticasBarco(listaFrames, barco, &stats)) {
+        erroLote(linha, "barco nao encontrado");
+        return;
+    }
+
+    printf("estatisticas %s %d %d %d %d %d %d %.2f %.2f\n", barco, stats.primeiroFrame, stats.ultimoFrame,
+           stats.posInicialX, stats.posInicialY, stats.posAtualX, stats.posAtualY,
+           stats.distancia, stats.velocidadeMedia);
+}
+
+/**
+ * @brief Executa o comando "estado FICHEIRO [sem-historico]".
+ *
+ * @param argumentos Texto da linha a seguir ao comando.
+ * @param linha Número da linha do script.
+ * @param listaFrames Histórico de frames.
+ */
+static void comandoEstado(const char *argumentos, int linha, ListaFrames *listaFrames) {
+    char ficheiro[LINHA_MAXIMA], opcao[LINHA_MAXIMA];
+    int lidos = sscanf(argumentos, " %255s %255s", ficheiro, opcao);
+
+    if (lidos < 1 || (lidos == 2 && strcmp(opcao, "sem-historico") != 0)) {
+        erroLote(linha, "argumentos invalidos");
+        return;
+    }
+    if (!guardarEstado(ficheiro, listaFrames, lidos == 1)) {
+        erroLote(linha, "erro ao guardar o estado");
+        return;
+    }
+
+    printf("estado %d\n", listaFrames->tail->frame_atual_num);
+}
+
+/**
+ * @brief Executa as operações de um script sem interação com o utilizador.
+ *
+ * Cada linha do script tem um comando; as linhas vazias e as começadas por '#' são ignoradas.
+ * Não são impressas mensagens do menu: cada comando escreve uma linha com o seu resultado,
+ * com campos separados por espaços, para ser lida por outros programas:
+ * - "avancar N"          -> "avancar <frame atual>"
+ * - "barco NOME LAT LON ANGULO VELOCIDADE TIPO" -> "barco adicionado|alterado <nome>"
+ * - "prever"             -> uma linha "colisao <frame> <x> <y> <barco> <barco> ..." por colisão e "prever <colisoes>"
+ * - "recuar N"           -> "recuar <frame atual>"
+ * - "estatisticas NOME"  -> "estatisticas <nome> ..." (ver comandoEstatisticas)
+ * - "guardar"            -> "guardar <frame atual>" (o frame é escrito no ficheiro de saída)
+ * - "metricas"           -> tempos por fase e contadores (ver imprimirMetricas)
+ * - "memoria"            -> memória viva e máxima por categoria (ver imprimirMemoria)
+ * - "estado FICHEIRO [sem-historico]" -> "estado <frame atual>" (ver guardarEstado)
+ *
+ * Um comando inválido escreve "erro <linha> <mensagem>" e a execução continua na linha seguinte.
+ * Uma linha com mais de LINHA_MAXIMA - 1 caracteres não é executada e escreve
+ * "erro <linha> linha demasiado longa".
+ * Se o script não puder ser aberto, o programa termina com erro.
+ *
+ * @param ficheiro Caminho do script.
+ * @param frameAtual Ponteiro para o ponteiro do frame atual da simulação.
+ * @param listaFrames Ponteiro para o histórico de frames.
+ * @param latitudeMax Número máximo de linhas da grelha.
+ * @param longitudeMax Número máximo de colunas da grelha.
+ */
+void executarLote(const char *ficheiro, BaseDados **frameAtual, ListaFrames *listaFrames,
+                  int latitudeMax, int longitudeMax) {
+    char texto[LINHA_MAXIMA];
+    int linha = 0;
+    FILE *fp = fopen(ficheiro, "r");
+
+    if (fp == NULL) {
+        perror("Erro ao abrir o script");
+        exit(1);
+    }
+
+    while (fgets(texto, sizeof(texto), fp) != NULL) {
+        char comando[LINHA_MAXIMA];
+        const char *argumentos;
+        int lidos = 0;
+        int n;
+
+        linha++;
+
+        if (!linhaCompleta(texto, fp)) {
+            erroLote(linha, "linha demasiado longa");
+            continue;
+        }
+
+        // Linhas vazias e comentários
+        if (sscanf(texto, "%255s%n", comando, &lidos) != 1 || comando[0] == '#')
+            continue;
+        argumentos = texto + lidos;
+
+        if (strcmp(comando, "avancar") == 0) {
+            if (sscanf(argumentos, "%d", &n) != 1 || n < 0) {
+                erroLote(linha, "argumentos invalidos");
+                continue;
+            }
+            avancarFrame(frameAtual, listaFrames, n, latitudeMax, longitudeMax, 0);
+            printf("avancar %d\n", (*frameAtual)->frame_atual_num);
+        } else if (strcmp(comando, "barco") == 0) {
+            comandoBarco(argumentos, linha, *frameAtual, listaFrames, latitudeMax, longitudeMax);
+        } else if (strcmp(comando, "prever") == 0) {
+            n = previsaoDeColisoes(*frameAtual, latitudeMax, longitudeMax, SAIDA_LOTE);
+            printf("prever %d\n", n);
+        } else if (strcmp(comando, "recuar") == 0) {
+            if (sscanf(argumentos, "%d", &n) != 1 || n < 0) {
+                erroLote(linha, "argumentos invalidos");
+                continue;
+            }
+            rewindFrames(frameAtual, listaFrames, n, 0);
+            printf("recuar %d\n", (*frameAtual)->frame_atual_num);
+        } else if (strcmp(comando, "estatisticas") == 0) {
+            comandoEstatisticas(argumentos, linha, listaFrames);
+        } else if (strcmp(comando, "metricas") == 0) {
+            imprimirMetricas(SAIDA_LOTE);
+        } else if (strcmp(comando, "memoria") == 0) {
+            imprimirMemoria(SAIDA_LOTE);
+        } else if (strcmp(comando, "guardar") == 0) {
+            guardarFrameNoFicheiro(*frameAtual, 0);
+            printf("guardar %d\n", (*frameAtual)->frame_atual_num);
+        } else if (strcmp(comando, "estado") == 0) {
+            comandoEstado(argumentos, linha, listaFrames);
+        } else {
+            erroLote(linha, "comando desconhecido");
+        }
+    }
+
+    fclose(fp);
+}
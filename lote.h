@@ -0,0 +1,12 @@
+#ifndef LOTE_H
+#define LOTE_H
+
+// ================================================ LOTE ===============================================================
+
+/**
+ * @brief Executa as operações de um script sem interação, escrevendo um resultado por linha.
+ */
+void executarLote(const char *ficheiro, BaseDados **frameAtual, ListaFrames *listaFrames,
+                  int latitudeMax, int longitudeMax);
+
+#endif //LOTE_H
@@ -46,64 +46,28 @@
 // ================================================ MAIN ===============================================================
 
 // Compilar:
-// gcc main.c impressao.c input.c interface.c memoria.c simulacao.c -Wall -Wextra -g -Wvla -Wpedantic -Wdeclaration-after-statement -lm -o radar
+// gcc main.c impressao.c input.c interface.c memoria.c movimento.c paralelo.c historico.c previsao.c eventos.c simulacao.c lote.c metricas.c identificadores.c trajetorias.c estado.c saida.c -Wall -Wextra -g -Wvla -Wpedantic -Wdeclaration-after-statement -lm -lpthread -o radar
+
+// Com tempos por fase da simulação (opção 8 do menu): acrescentar -DRADAR_METRICAS
 
 // Run e Detetar leaks
 // leaks --atExit -- ./radar antes.txt 120x120 0 depois.txt
 
+// ========================================= LOOP MENU =================================================================
+
 /**
- * @brief Função principal da aplicação de simulação de radar marítimo.
+ * @brief Mostra o menu interativo e executa as opções escolhidas até o utilizador sair.
  *
- * Esta função coordena a leitura de argumentos, a criação dos frames iniciais,
- * a simulação dos movimentos das embarcações, e apresenta um menu interativo
- * para manipulação da simulação.
- *
- * @param argc Número de argumentos recebidos na linha de comandos.
- * @param argv Vetor de strings com os argumentos da linha de comandos.
- * @return int Código de saída da aplicação (0 em caso de sucesso).
+ * @param frameAtual Ponteiro para o ponteiro do frame atual da simulação.
+ * @param listaFrames Ponteiro para o histórico de frames.
+ * @param latitudeMax Número máximo de linhas da grelha.
+ * @param longitudeMax Número máximo de colunas da grelha.
+ * @param debugEnable Estado inicial do modo de debug.
  */
-int main(int argc, char *argv[]) {
-    // Variáveis
-    char *ficheiro_entrada, *ficheiro_saida;
-    int latitudeMax, longitudeMax, numFrames;
-    int debugEnable = 0;
+static void executarMenu(BaseDados **frameAtual, ListaFrames *listaFrames, int latitudeMax, int longitudeMax,
+                         int debugEnable) {
     int opcao;
 
-    // Estruturas de dados
-    BaseDados frameInicial = {.frame_atual_num = 0};
-    ListaFrames listaFrames = {0};
-    BaseDados *frameAtual = &frameInicial;
-
-    // Ler arumentos e ficheiro de input
-    lerArgsMain(argc, argv, &ficheiro_entrada, &latitudeMax, &longitudeMax,
-                &numFrames, &ficheiro_saida);
-    lerFicheiroInicial(ficheiro_entrada, &frameInicial);
-
-    // Imprimir info debug (leitura dos argumentos)
-    if (debugEnable) {
-        printf(YELLOW);
-        printf("--- DEBUG: Main args ---\n");
-        printf("%-20s %s\n", "Ficheiro entrada:", ficheiro_entrada);
-        printf("%-20s %d\n", "Linhas:", latitudeMax);
-        printf("%-20s %d\n", "Colunas:", longitudeMax);
-        printf("%-20s %d\n", "Numero de frames:", numFrames);
-        printf("%-21s %s\n\n", "Ficheiro saída:", ficheiro_saida);
-        printf(RESET);
-    }
-
-    // Inicio e fim da lista de frames
-    listaFrames.head = &frameInicial;
-    listaFrames.tail = &frameInicial;
-
-    // Avanaçar simulação de acordo com os argumentos da main
-    avancarFrame(&frameAtual, &listaFrames, numFrames, latitudeMax, longitudeMax, 1);
-    guardarFrameNoFicheiro(frameAtual, 1);
-
-    if (numFrames > 0)
-        printf("Simulação atualizada para o frame %d\n", frameAtual->frame_atual_num);
-
-    // ========================================= LOOP MENU =============================================================
-
     do {
         // Imprimo infos de debug
         char debug[20];
@@ -111,7 +75,7 @@ int main(int argc, char *argv[]) {
         printf(YELLOW);
         printf("\nDebug %s", debug);
         if (debugEnable) {
-            printf(" | Frame %d", frameAtual->frame_atual_num);
+            printf(" | Frame %d", (*frameAtual)->frame_atual_num);
         }
         printf(RESET);
 
@@ -128,34 +92,36 @@ int main(int argc, char *argv[]) {
         switch (opcao) {
             case 1:
                 // Pergunta quantos frames avançar na simulação, gera-os, avança e guarda o frame no ficheiro output
-                pedeAtualizarSimulacao(&frameAtual, &listaFrames, latitudeMax, longitudeMax);
-                guardarFrameNoFicheiro(frameAtual, 1);
+                pedeAtualizarSimulacao(frameAtual, listaFrames, latitudeMax, longitudeMax);
+                guardarFrameNoFicheiro(*frameAtual, 1);
                 break;
 
             case 2:
                 // Pergunta qual barco inserir ou alterar e insere/altera
-                inserirOuAlterarBarco(latitudeMax, longitudeMax, frameAtual);
+                inserirOuAlterarBarco(latitudeMax, longitudeMax, *frameAtual, listaFrames);
                 break;
 
             case 3:
                 // Mostra em quais frames haverão colisões e qual o ponto e barcos envolvidos
-                previsaoDeColisoes(&frameAtual, &listaFrames, latitudeMax, longitudeMax);
+                previsaoDeColisoes(*frameAtual, latitudeMax, longitudeMax, SAIDA_TEXTO);
                 break;
 
             case 4:
                 // Pergunta quantos frames recuar, recua esse número de frames, "apaga" os frames à frente desse
                 // e guarda o frame no ficheiro output
-                rastrearHistoricoReverso(&frameAtual, &listaFrames);
-                imprimirFrameAtual(frameAtual);
-                guardarFrameNoFicheiro(frameAtual, 1);
+                rastrearHistoricoReverso(frameAtual, listaFrames);
+                imprimirFrameAtual(*frameAtual);
+                guardarFrameNoFicheiro(*frameAtual, 1);
                 break;
 
             case 5:
                 // Pergunta qual barco e dá as suas estatísticas
-                pedeVelocidadeBarco(&frameAtual);
+                pedeVelocidadeBarco(listaFrames);
                 break;
 
             case 6: {
+                // O script lê o ficheiro de saída: espera que a thread de escrita o termine
+                esperarSaida();
                 system("python3 radarbarcos.py");
                 break;
             }
@@ -166,9 +132,20 @@ int main(int argc, char *argv[]) {
                 break;
             }
 
+            case 8:
+                // Mostra o tempo gasto em cada fase da simulação, os contadores e a memória usada
+                imprimirMetricas(SAIDA_TEXTO);
+                imprimirMemoria(SAIDA_TEXTO);
+                break;
+
+            case 9:
+                // Pergunta o ficheiro e guarda o estado da simulação, para ser retomada com --estado
+                pedeGuardarEstado(listaFrames);
+                break;
+
             case 0:
                 // Guarda o frame atual no ficheiro de output
-                guardarFrameNoFicheiro(frameAtual, 1);
+                guardarFrameNoFicheiro(*frameAtual, 1);
                 printf("A sair do programa...\n");
                 break;
 
@@ -180,15 +157,93 @@ int main(int argc, char *argv[]) {
         if (debugEnable) {
             printf(YELLOW);
             printf("\n--- DEBUG ---");
-            imprimirBarcosDebug(frameAtual);
+            imprimirBarcosDebug(*frameAtual);
             printf(RESET);
         }
     } while (opcao != 0);
+}
+
+/**
+ * @brief Função principal da aplicação de simulação de radar marítimo.
+ *
+ * Esta função coordena a leitura de argumentos, a criação dos frames iniciais,
+ * a simulação dos movimentos das embarcações, e apresenta um menu interativo
+ * para manipulação da simulação.
+ *
+ * @param argc Número de argumentos recebidos na linha de comandos.
+ * @param argv Vetor de strings com os argumentos da linha de comandos.
+ * @return int Código de saída da aplicação (0 em caso de sucesso).
+ */
+int main(int argc, char *argv[]) {
+    // Variáveis
+    char *ficheiro_entrada, *ficheiro_saida;
+    const char *ficheiro_lote, *ficheiro_estado;
+    int intervaloSaida;
+    int latitudeMax, longitudeMax, numFrames;
+    int debugEnable = 0;
+
+    // Estruturas de dados
+    RegistoNavios registoNavios = {0};
+    BaseDados frameInicial = {.frame_atual_num = 0, .registo = &registoNavios};
+    ListaFrames listaFrames = {0};
+    BaseDados *frameAtual = &frameInicial;
+
+    // Ler arumentos e ficheiro de input
+    lerArgsMain(argc, argv, &ficheiro_entrada, &latitudeMax, &longitudeMax,
+                &numFrames, &ficheiro_saida, &listaFrames.config, &ficheiro_lote, &ficheiro_estado,
+                &intervaloSaida);
+
+    // No modo em lote o stdout é escrito em blocos grandes, e não a cada linha
+    if (ficheiro_lote != NULL)
+        setvbuf(stdout, NULL, _IOFBF, 1 << 16);
+
+    // Retoma uma simulação guardada, ou começa uma nova a partir do ficheiro de entrada
+    if (ficheiro_estado != NULL) {
+        frameAtual = carregarEstado(ficheiro_estado, &frameInicial, &listaFrames, &latitudeMax, &longitudeMax);
+    } else {
+        lerFicheiroInicial(ficheiro_entrada, &frameInicial);
+        iniciarHistorico(&listaFrames, &frameInicial, latitudeMax, longitudeMax);
+    }
+    abrirSaida(ficheiro_saida, intervaloSaida, frameAtual);
+
+    // Imprimir info debug (leitura dos argumentos)
+    if (debugEnable) {
+        printf(YELLOW);
+        printf("--- DEBUG: Main args ---\n");
+        printf("%-20s %s\n", "Ficheiro entrada:", ficheiro_entrada);
+        printf("%-20s %d\n", "Linhas:", latitudeMax);
+        printf("%-20s %d\n", "Colunas:", longitudeMax);
+        printf("%-20s %d\n", "Numero de frames:", numFrames);
+        printf("%-21s %s\n\n", "Ficheiro saída:", ficheiro_saida);
+        printf(RESET);
+    }
+
+    // Avanaçar simulação de acordo com os argumentos da main
+    avancarFrame(&frameAtual, &listaFrames, numFrames, latitudeMax, longitudeMax, ficheiro_lote == NULL);
+
+    if (ficheiro_lote != NULL) {
+        // Modo em lote: executa o script e guarda o frame final, sem menu
+        executarLote(ficheiro_lote, &frameAtual, &listaFrames, latitudeMax, longitudeMax);
+        guardarFrameNoFicheiro(frameAtual, 0);
+    } else {
+        guardarFrameNoFicheiro(frameAtual, 1);
+        if (numFrames > 0)
+            printf("Simulação atualizada para o frame %d\n", frameAtual->frame_atual_num);
+
+        executarMenu(&frameAtual, &listaFrames, latitudeMax, longitudeMax, debugEnable);
+    }
+    fecharSaida();
 
     // Volta para o frame 0 (liberta todos os proximos)
-    rewindFrames(&frameAtual, &listaFrames, frameAtual->frame_atual_num);
-    // Liberto o frame 0
+    rewindFrames(&frameAtual, &listaFrames, frameAtual->frame_atual_num, 0);
+    libertarHistorico(&listaFrames);
+    // Liberto o frame 0 e o registo de navios
     limparFrameInicial(&frameInicial);
 
+    // Termino as threads usadas no cálculo dos frames
+    terminarThreads();
+    // Liberto as arenas guardadas para reaproveitar
+    libertarArenas();
+
     return 0;
 }
@@ -5,82 +5,26 @@
 /**
 * @brief Remove todos os frames futuros da simulação a partir do frame atual.
 *
-* Esta função percorre os frames seguintes ao frame atual, libertando a memória associada
-* às entidades (EntidadeIED) e, quando apropriado, aos navios (NoVessel) não reutilizados
-* em frames anteriores. Garante que os dados dos frames futuros são corretamente eliminados
-* e atualiza os ponteiros da estrutura ListaFrames.
+* Esta função percorre os frames seguintes ao frame atual e liberta a memória associada
+* a cada um deles (entidades e o próprio frame). Os navios (NoVessel) pertencem ao registo
+* partilhado: os registados nos frames apagados são descartados por `recuarHistorico` (ver
+* `descartarNaviosFuturos`) e os restantes são libertados no fim da simulação, em `limparFrameInicial`.
+* No final atualiza os ponteiros da estrutura ListaFrames.
 *
 * @param frameAtual Ponteiro duplo para o frame atual da simulação.
 * @param listaFrames Ponteiro para a lista de todos os frames da simulação.
 */
 void apagarFramesFuturos(BaseDados **frameAtual, ListaFrames *listaFrames) {
     BaseDados *atual = (*frameAtual)->next;  // Começo no frame seguinte ao atual
-    NoVessel *jaLibertados[100];             // Lista para controlar os NoVessel já libertados
-    int jaLibertadosCount = 0;               // Contador de NoVessel libertados
 
     while (atual != NULL) {
         BaseDados *aRemover = atual;
-        EntidadeIED *barco = aRemover->barcos;
-        EntidadeIED *entidades[100];         // Lista temporária de entidades a libertar
-        NoVessel *vessels[100];              // Lista temporária dos navios associados
-        int count = 0;
 
         // Avanço antes de remover
         atual = atual->next;
 
-        // Guardo as entidades e os respetivos navios
-        while (barco != NULL && count < 100) {
-            entidades[count] = barco;
-            vessels[count] = barco->no_nautico;
-            barco = barco->seguinte;
-            count++;
-        }
-
-        // Libertar a memoria das entidades
-        for (int i = 0; i < count; i++) {
-            free(entidades[i]);
-        }
-
-        // Verificar e libertar os NoVessel se não forem usados nos frames anteriores
-        for (int i = 0; i < count; i++) {
-            int jaFoiLibertado = 0;
-            int encontrado = 0;
-            BaseDados *frameCheck;
-
-            if (vessels[i] == NULL) continue;
-
-            // Aqui verifico se ja foi libertado (para os casos de inserção em frames que não 0)
-            for (int j = 0; j < jaLibertadosCount; j++) {
-                if (jaLibertados[j] == vessels[i]) {
-                    jaFoiLibertado = 1;
-                    break;
-                }
-            }
-            if (jaFoiLibertado) continue;
-
-            // Verifico se o navio ainda é usado em frames anteriores
-            frameCheck = (*frameAtual);
-            while (frameCheck != NULL && !encontrado) {
-                EntidadeIED *e = frameCheck->barcos;
-                while (e != NULL) {
-                    if (e->no_nautico == vessels[i]) {
-                        encontrado = 1;
-                        break;
-                    }
-                    e = e->seguinte;
-                }
-                frameCheck = frameCheck->prev;
-            }
-
-            // Se nao foi encontrado já posso libertar
-            if (!encontrado) {
-                free(vessels[i]);
-                jaLibertados[jaLibertadosCount++] = vessels[i];
-            }
-        }
-
-        // Libertar a memoria do frame atual
-        free(aRemover);
+        // Libertar a memoria do frame e das suas entidades
+        libertarFrame(aRemover);
         listaFrames->total_frames--;
     }
 
@@ -90,102 +34,664 @@ void apagarFramesFuturos(BaseDados **frameAtual, ListaFrames *listaFrames) {
 }
 
 /**
- * @brief Guarda os dados do frame atual no ficheiro "depois.txt".
+ * @brief Liberta toda a memória associada aos barcos do frame inicial.
  *
- * Esta função percorre todos os barcos presentes no frame atual e escreve no ficheiro
- * "depois.txt" os seus dados: identificador, posição (latitude, longitude),
- * ângulo de deslocação, velocidade escalar e tipo.
- * Submarinos invisíveis (tipo 3 e isVisible == 0) são ignorados.
+ * Esta função liberta a arena do frame zero (e com ela as suas entidades) e o
+ * registo de navios (`NoVessel`) partilhado por todos os frames.
  *
- * O ficheiro é sobrescrito em cada chamada. Se ativado, mostra mensagem de confirmação.
+ * Deve ser chamada após a função `rewindFrames`, que garante que o
+ * frame inicial é o único restante e que já nenhum outro frame
+ * referencia o registo.
  *
- * @param frameAtual Ponteiro para o frame atual cujos dados serão guardados.
- * @param showOutput Valor booleano (0 ou 1) que indica se deve mostrar mensagem de sucesso.
+ * @param frameZero Ponteiro para o frame inicial da simulação.
  */
-void guardarFrameNoFicheiro(BaseDados *frameAtual, int showOutput) {
-    EntidadeIED *atual = frameAtual->barcos;  // Aponta para o início da lista de barcos
-    char id;
+void limparFrameInicial(BaseDados *frameZero) {
+    if (frameZero->arena != NULL)
+        devolverArena(frameZero->arena);
 
-    // Abrir o ficheiro para escrita
-    FILE *fp = fopen("depois.txt", "w");
-    if (!fp) {
-        perror("Erro ao abrir depois.txt");
+    frameZero->arena = NULL;
+    memset(&frameZero->barcos, 0, sizeof(EntidadesIED));
+
+    if (frameZero->registo != NULL)
+        libertarRegisto(frameZero->registo);
+}
+
+/**
+ * @brief Garante que os arrays de entidades de um frame têm espaço para 'capacidade' entidades.
+ *
+ * Os arrays são alocados na arena do frame (ver reservarEntidadesNaArena).
+ *
+ * @param frame Frame cujas entidades são redimensionadas.
+ * @param capacidade Número mínimo de entidades que devem caber nos arrays.
+ */
+void reservarEntidades(BaseDados *frame, int capacidade) {
+    if (capacidade <= frame->barcos.capacidade)
+        return;
+
+    if (frame->arena == NULL)
+        frame->arena = obterArena();
+
+    reservarEntidadesNaArena(frame->arena, &frame->barcos, capacidade);
+}
+
+/**
+ * @brief Garante que um conjunto de entidades tem espaço para 'capacidade' entidades.
+ *
+ * Todos os arrays vivem num único bloco de memória, alocado na arena indicada. Quando é
+ * preciso crescer, é alocado um bloco novo (pelo menos o dobro do anterior) e as entidades
+ * existentes são copiadas; o bloco antigo só é recuperado quando a arena é libertada.
+ *
+ * @param arena Arena onde os arrays são alocados.
+ * @param entidades Entidades a redimensionar.
+ * @param capacidade Número mínimo de entidades que devem caber nos arrays.
+ */
+void reservarEntidadesNaArena(Arena *arena, EntidadesIED *entidades, int capacidade) {
+    int novaCapacidade;
+    size_t bytesInteiros;
+    char *bloco;
+    EntidadesIED novo;
+
+    if (capacidade <= entidades->capacidade)
         return;
+
+    // Crescimento geométrico, arredondado a múltiplos de 8 entidades
+    novaCapacidade = entidades->capacidade * 2;
+    if (novaCapacidade < capacidade)
+        novaCapacidade = capacidade;
+    novaCapacidade = (novaCapacidade + 7) & ~7;
+
+    bytesInteiros = (size_t) novaCapacidade * sizeof(int);
+    bloco = alocarArenaCategoria(arena, bytesInteiros * 5 + (size_t) novaCapacidade, MEMORIA_ENTIDADES);
+
+    // Divide o bloco pelos vários arrays
+    novo.posX = (int *) bloco;
+    novo.posY = (int *) (bloco + bytesInteiros);
+    novo.velX = (int *) (bloco + bytesInteiros * 2);
+    novo.velY = (int *) (bloco + bytesInteiros * 3);
+    novo.navio = (int *) (bloco + bytesInteiros * 4);
+    novo.flags = (unsigned char *) (bloco + bytesInteiros * 5);
+    novo.total = entidades->total;
+    novo.capacidade = novaCapacidade;
+
+    // Copia as entidades existentes para o novo bloco
+    if (entidades->total > 0)
+        copiarEntidades(&novo, 0, entidades, 0, entidades->total);
+
+    *entidades = novo;
+}
+
+/**
+ * @brief Copia 'n' entidades de um conjunto para outro.
+ *
+ * @param destino Entidades de destino (com capacidade suficiente).
+ * @param inicioDestino Índice da primeira entidade escrita no destino.
+ * @param origem Entidades de origem.
+ * @param inicioOrigem Índice da primeira entidade lida na origem.
+ * @param n Número de entidades a copiar.
+ */
+void copiarEntidades(EntidadesIED *destino, int inicioDestino, const EntidadesIED *origem, int inicioOrigem, int n) {
+    size_t bytes = (size_t) n * sizeof(int);
+
+    if (n <= 0)
+        return;
+
+    memcpy(destino->posX + inicioDestino, origem->posX + inicioOrigem, bytes);
+    memcpy(destino->posY + inicioDestino, origem->posY + inicioOrigem, bytes);
+    memcpy(destino->velX + inicioDestino, origem->velX + inicioOrigem, bytes);
+    memcpy(destino->velY + inicioDestino, origem->velY + inicioOrigem, bytes);
+    memcpy(destino->navio + inicioDestino, origem->navio + inicioOrigem, bytes);
+    memcpy(destino->flags + inicioDestino, origem->flags + inicioOrigem, (size_t) n);
+}
+
+/**
+ * @brief Acrescenta uma entidade no fim dos arrays de um frame.
+ *
+ * @param frame Frame onde a entidade é acrescentada.
+ * @param x Posição no eixo x (longitude).
+ * @param y Posição no eixo y (latitude).
+ * @param vx Velocidade no eixo x.
+ * @param vy Velocidade no eixo y.
+ * @param navio Índice do navio no registo.
+ * @param flags Flags da entidade (ex: BARCO_VISIVEL).
+ * @return Índice da nova entidade.
+ */
+int adicionarEntidade(BaseDados *frame, int x, int y, int vx, int vy, int navio, unsigned char flags) {
+    EntidadesIED *entidades = &frame->barcos;
+    int i = entidades->total;
+
+    reservarEntidades(frame, i + 1);
+
+    entidades->posX[i] = x;
+    entidades->posY[i] = y;
+    entidades->velX[i] = vx;
+    entidades->velY[i] = vy;
+    entidades->navio[i] = navio;
+    entidades->flags[i] = flags;
+    entidades->total++;
+    indexarEntidade(frame, i);
+
+    return i;
+}
+
+/**
+ * @brief Acrescenta um navio ao registo de navios.
+ *
+ * @param registo Ponteiro para o registo.
+ * @param id Id do barco (ver obterIdNavio).
+ * @param tipologia Tipo do navio.
+ * @param frame Número do frame atual, onde o navio é registado.
+ * @return Índice do navio no registo.
+ */
+int registarNavio(RegistoNavios *registo, unsigned int id, int tipologia, int frame) {
+    if (registo->total == registo->capacidade) {
+        int novaCapacidade = registo->capacidade ? registo->capacidade * 2 : 16;
+        NoVessel *novos = realloc(registo->navios, (size_t) novaCapacidade * sizeof(NoVessel));
+        if (!novos) {
+            perror("Erro ao alocar navio");
+            exit(1);
+        }
+        registarMemoria(MEMORIA_NAVIOS, (long long) (novaCapacidade - registo->capacidade) * (long long) sizeof(NoVessel));
+        registo->navios = novos;
+        registo->capacidade = novaCapacidade;
     }
 
-    // Percorrer todos os barcos do frame
-    while (atual != NULL) {
-        int tipo = atual->no_nautico->tipologia;
-        int visivel = atual->no_nautico->isVisible;
-        int lat;
-        int lon;
-        int vx;
-        int vy;
-        double angulo_rad;
-        int angulo_deg;
-        int velocidade;
-
-        // Ignoro os submarinos invisíveis
-        if (tipo == 3 && visivel == 0) {
-            atual = atual->seguinte;
-            continue;
+    registo->navios[registo->total].id = id;
+    registo->navios[registo->total].tipologia = tipologia;
+    registo->navios[registo->total].frame = frame;
+
+    return registo->total++;
+}
+
+/**
+ * @brief Descarta os navios registados depois de um frame, ao recuar para esse frame.
+ *
+ * Um navio só é referenciado pelo frame em que foi registado e pelos seguintes, e o registo
+ * está ordenado pelo frame de registo, por isso basta retirar navios do fim do array até
+ * encontrar um registado no frame pretendido ou antes. O custo é proporcional ao número de
+ * navios descartados; os seus índices voltam a ser usados pelos próximos navios registados.
+ * A capacidade do array não diminui.
+ *
+ * @param registo Ponteiro para o registo.
+ * @param numFrame Número do novo frame atual.
+ */
+void descartarNaviosFuturos(RegistoNavios *registo, int numFrame) {
+    while (registo->total > 0 && registo->navios[registo->total - 1].frame > numFrame)
+        registo->total--;
+}
+
+/**
+ * @brief Liberta todos os navios do registo, as suas identidades e índices.
+ *
+ * @param registo Ponteiro para o registo.
+ */
+void libertarRegisto(RegistoNavios *registo) {
+    libertarIdentificadores(registo);
+    registarMemoria(MEMORIA_NAVIOS, -(long long) registo->capacidade * (long long) sizeof(NoVessel));
+    free(registo->navios);
+    registo->navios = NULL;
+    registo->total = 0;
+    registo->capacidade = 0;
+}
+
+/**
+ * @brief Aloca um frame vazio no início de uma arena (ver criarFrame).
+ */
+static BaseDados *iniciarFrameNaArena(Arena *arena, BaseDados *anterior, int capacidade) {
+    BaseDados *frame = alocarArenaCategoria(arena, sizeof(BaseDados), MEMORIA_FRAMES);
+
+    memset(frame, 0, sizeof(BaseDados));
+    frame->arena = arena;
+    frame->frame_atual_num = anterior->frame_atual_num + 1;
+    frame->registo = anterior->registo;
+    reservarEntidades(frame, capacidade);
+
+    return frame;
+}
+
+/**
+ * @brief Cria um novo frame, sem entidades, a seguir ao frame anterior.
+ *
+ * O frame é o primeiro objeto alocado numa arena nova (ou reaproveitada), que passa a ser
+ * sua: as entidades e os registos de colisão do frame vêm da mesma arena. O frame criado
+ * tem o número seguinte ao do frame anterior, partilha o mesmo registo de navios e já tem
+ * espaço reservado para 'capacidade' entidades. Os ponteiros prev/next ficam a NULL:
+ * ligar o frame à lista é responsabilidade de quem o cria.
+ *
+ * @param anterior Frame a partir do qual o novo frame é gerado.
+ * @param capacidade Número de entidades a reservar.
+ * @return Ponteiro para o novo frame.
+ */
+BaseDados *criarFrame(BaseDados *anterior, int capacidade) {
+    return iniciarFrameNaArena(obterArena(), anterior, capacidade);
+}
+
+/**
+ * @brief Reaproveita um frame que já não é preciso como o frame seguinte a outro.
+ *
+ * A arena do frame é esvaziada mas mantém os seus blocos, pelo que, se o frame antigo
+ * tinha pelo menos 'capacidade' entidades, não é feita nenhuma alocação.
+ *
+ * @param frame Frame a reaproveitar (criado com criarFrame; deixa de ser válido).
+ * @param anterior Frame a partir do qual o novo frame é gerado.
+ * @param capacidade Número de entidades a reservar.
+ * @return Ponteiro para o frame reaproveitado.
+ */
+BaseDados *reciclarFrame(BaseDados *frame, BaseDados *anterior, int capacidade) {
+    Arena *arena = frame->arena;
+    MarcaArena vazia = {0};
+
+    invalidarIndice(frame);
+    restaurarArena(arena, vazia);
+    return iniciarFrameNaArena(arena, anterior, capacidade);
+}
+
+
+/**
+ * @brief Liberta um frame, devolvendo a sua arena de uma só vez.
+ *
+ * @param frame Frame a libertar (criado com criarFrame).
+ */
+void libertarFrame(BaseDados *frame) {
+    invalidarIndice(frame);
+
+    // O próprio frame vive na arena, por isso não pode ser usado depois disto
+    devolverArena(frame->arena);
+}
+
+/**
+ * @brief Aloca memória na arena de um frame.
+ *
+ * Frames que não foram criados com criarFrame (por exemplo o frame 0, que vive na pilha
+ * da main) recebem uma arena na primeira alocação.
+ *
+ * @param frame Frame dono da memória.
+ * @param bytes Número de bytes a alocar.
+ * @param categoria Categoria em que a memória é contabilizada.
+ * @return Ponteiro para a memória alocada (válida até o frame ser libertado).
+ */
+void *alocarNoFrame(BaseDados *frame, size_t bytes, CategoriaMemoria categoria) {
+    if (frame->arena == NULL)
+        frame->arena = obterArena();
+
+    return alocarArenaCategoria(frame->arena, bytes, categoria);
+}
+
+// ================================================ ARENAS =============================================================
+
+// Alinhamento de todas as alocações das arenas
+#define ALINHAMENTO_ARENA 16
+
+// Tamanho mínimo dos blocos das arenas
+#define BLOCO_ARENA_MINIMO 4096
+
+// Número máximo de arenas livres guardadas para reaproveitar
+#define MAX_ARENAS_LIVRES 1024
+
+// Tamanho do cabeçalho dos blocos, arredondado ao alinhamento
+#define CABECALHO_BLOCO ((sizeof(BlocoArena) + ALINHAMENTO_ARENA - 1) & ~(size_t) (ALINHAMENTO_ARENA - 1))
+
+/*
+ * As arenas devolvidas ficam numa lista de arenas livres, com os seus blocos, e são
+ * reaproveitadas pela próxima obterArena. Assim, depois de a simulação aquecer, criar e
+ * apagar frames (por exemplo em ciclos de recuar/avançar) já não chama malloc.
+ * Estas funções só devem ser usadas pela thread principal.
+ */
+static Arena *arenasLivres = NULL;
+static int numArenasLivres = 0;
+static Arena *temporaria = NULL;
+
+/**
+ * @brief Aloca um bloco com pelo menos 'bytes' de capacidade.
+ */
+static BlocoArena *novoBlocoArena(size_t bytes) {
+    BlocoArena *bloco;
+
+    if (bytes < BLOCO_ARENA_MINIMO)
+        bytes = BLOCO_ARENA_MINIMO;
+
+    bloco = malloc(CABECALHO_BLOCO + bytes);
+    if (!bloco) {
+        perror("Erro ao alocar bloco de memoria");
+        exit(1);
+    }
+    CONTAR(CONTADOR_BLOCOS, 1);
+    registarMemoria(MEMORIA_ARENAS, (long long) (CABECALHO_BLOCO + bytes));
+
+    bloco->seguinte = NULL;
+    bloco->capacidade = bytes;
+    bloco->usado = 0;
+    return bloco;
+}
+
+/**
+ * @brief Liberta um bloco de uma arena.
+ */
+static void libertarBlocoArena(BlocoArena *bloco) {
+    registarMemoria(MEMORIA_ARENAS, -(long long) (CABECALHO_BLOCO + bloco->capacidade));
+    free(bloco);
+}
+
+/**
+ * @brief Desconta da contabilidade de memória tudo o que foi alocado numa arena depois de uma marca.
+ */
+static void descontarArena(Arena *arena, const size_t *bytesMarca) {
+    for (int c = 0; c < NUM_CATEGORIAS_MEMORIA; c++) {
+        size_t marca = bytesMarca != NULL ? bytesMarca[c] : 0;
+
+        registarMemoria((CategoriaMemoria) c, -(long long) (arena->bytesCategoria[c] - marca));
+        arena->bytesCategoria[c] = marca;
+    }
+}
+
+/**
+ * @brief Liberta uma arena e todos os seus blocos.
+ */
+static void destruirArena(Arena *arena) {
+    BlocoArena *bloco = arena->primeiro;
+
+    descontarArena(arena, NULL);
+    while (bloco != NULL) {
+        BlocoArena *seguinte = bloco->seguinte;
+        libertarBlocoArena(bloco);
+        bloco = seguinte;
+    }
+    free(arena);
+}
+
+/**
+ * @brief Obtém uma arena vazia.
+ *
+ * Reaproveita uma arena da lista de arenas livres (com os blocos que já tinha) ou, se não
+ * houver nenhuma, cria uma nova sem blocos.
+ *
+ * @return Arena vazia.
+ */
+Arena *obterArena(void) {
+    Arena *arena = arenasLivres;
+
+    if (arena != NULL) {
+        arenasLivres = arena->proximaLivre;
+        numArenasLivres--;
+        arena->proximaLivre = NULL;
+        return arena;
+    }
+
+    arena = calloc(1, sizeof(Arena));
+    if (!arena) {
+        perror("Erro ao alocar arena");
+        exit(1);
+    }
+    return arena;
+}
+
+/**
+ * @brief Devolve uma arena, libertando de uma vez tudo o que foi alocado nela.
+ *
+ * Se a arena tinha vários blocos, são substituídos por um único bloco com a soma das
+ * capacidades, para que a próxima utilização caiba num só bloco. A arena fica na lista
+ * de arenas livres (até MAX_ARENAS_LIVRES; as restantes são destruídas).
+ *
+ * @param arena Arena a devolver (pode ser NULL).
+ */
+void devolverArena(Arena *arena) {
+    if (arena == NULL)
+        return;
+
+    if (numArenasLivres >= MAX_ARENAS_LIVRES) {
+        destruirArena(arena);
+        return;
+    }
+
+    descontarArena(arena, NULL);
+
+    // Junta os blocos num só
+    if (arena->primeiro != NULL && arena->primeiro->seguinte != NULL) {
+        size_t total = 0;
+        BlocoArena *bloco = arena->primeiro;
+        while (bloco != NULL) {
+            BlocoArena *seguinte = bloco->seguinte;
+            total += bloco->capacidade;
+            libertarBlocoArena(bloco);
+            bloco = seguinte;
         }
+        arena->primeiro = novoBlocoArena(total);
+    }
 
-        // Guardar os dados do barco
-        id = atual->no_nautico->nome;
-        lat = atual->posicao[1];
-        lon = atual->posicao[0];
-        vx = atual->velocidade[0];
-        vy = atual->velocidade[1];
+    if (arena->primeiro != NULL)
+        arena->primeiro->usado = 0;
+    arena->atual = arena->primeiro;
 
-        // Calculo dos dados de cada barco
-        angulo_rad = atan2(vy, vx);  // radianos
-        angulo_deg = (int) round(angulo_rad * 180.0 / M_PI);
-        if (angulo_deg < 0)
-            angulo_deg += 360;
+    arena->proximaLivre = arenasLivres;
+    arenasLivres = arena;
+    numArenasLivres++;
+}
 
-        velocidade = (int) round(sqrt(vx * vx + vy * vy));
+/**
+ * @brief Aloca memória numa arena.
+ *
+ * Avança o cursor do bloco atual. Se o pedido não couber, passa para o bloco seguinte
+ * (que pode ter ficado livre depois de restaurarArena) ou acrescenta um bloco novo com
+ * pelo menos o dobro da capacidade do atual. Em caso de falha o programa termina.
+ *
+ * @param arena Arena onde alocar.
+ * @param bytes Número de bytes a alocar.
+ * @return Ponteiro para a memória, alinhado a ALINHAMENTO_ARENA bytes.
+ */
+void *alocarArena(Arena *arena, size_t bytes) {
+    BlocoArena *bloco = arena->atual;
+    void *ptr;
 
-        // Escreve no ficheiro
-        fprintf(fp, "%c %d %d %d %d %d\n", id, lat, lon, angulo_deg, velocidade, tipo);
+    bytes = (bytes + ALINHAMENTO_ARENA - 1) & ~(size_t) (ALINHAMENTO_ARENA - 1);
+    CONTAR(CONTADOR_ALOCACOES, 1);
 
-        // Avança para o próximo barco
-        atual = atual->seguinte;
+    if (bloco == NULL) {
+        // Arena sem blocos
+        bloco = novoBlocoArena(bytes);
+        arena->primeiro = bloco;
+    } else if (bloco->usado + bytes > bloco->capacidade) {
+        if (bloco->seguinte != NULL && bloco->seguinte->capacidade >= bytes) {
+            // Reaproveita o bloco seguinte, que está livre
+            bloco = bloco->seguinte;
+            bloco->usado = 0;
+        } else {
+            // Insere um bloco novo a seguir ao atual
+            BlocoArena *novo = novoBlocoArena(bytes > bloco->capacidade * 2 ? bytes : bloco->capacidade * 2);
+            novo->seguinte = bloco->seguinte;
+            bloco->seguinte = novo;
+            bloco = novo;
+        }
     }
-    fclose(fp);
 
-    // Mostra mensagem de confirmação se pedido
-    if (showOutput) {
-        printf("Frame %d guardado com sucesso em depois.txt\n", frameAtual->frame_atual_num);
+    arena->atual = bloco;
+    ptr = (char *) bloco + CABECALHO_BLOCO + bloco->usado;
+    bloco->usado += bytes;
+    return ptr;
+}
+
+/**
+ * @brief Aloca memória numa arena e contabiliza-a numa categoria de memória.
+ *
+ * A memória deixa de contar como viva quando a arena é devolvida ou restaurada para uma
+ * marca anterior à alocação.
+ *
+ * @param arena Arena onde alocar.
+ * @param bytes Número de bytes a alocar.
+ * @param categoria Categoria da memória alocada.
+ * @return Ponteiro para a memória (ver alocarArena).
+ */
+void *alocarArenaCategoria(Arena *arena, size_t bytes, CategoriaMemoria categoria) {
+    arena->bytesCategoria[categoria] += bytes;
+    registarMemoria(categoria, (long long) bytes);
+    return alocarArena(arena, bytes);
+}
+
+/**
+ * @brief Calcula a memória ocupada por uma arena (todos os blocos, usados ou não).
+ *
+ * @param arena Arena a medir (pode ser NULL).
+ * @return Número de bytes reservados pela arena.
+ */
+size_t memoriaArena(const Arena *arena) {
+    size_t total;
+
+    if (arena == NULL)
+        return 0;
+
+    total = sizeof(Arena);
+    for (const BlocoArena *bloco = arena->primeiro; bloco != NULL; bloco = bloco->seguinte)
+        total += CABECALHO_BLOCO + bloco->capacidade;
+    return total;
+}
+
+/**
+ * @brief Marca a posição atual de uma arena.
+ *
+ * @param arena Arena a marcar.
+ * @return Marca a passar a restaurarArena.
+ */
+MarcaArena marcarArena(Arena *arena) {
+    MarcaArena marca;
+
+    marca.bloco = arena->atual;
+    marca.usado = arena->atual != NULL ? arena->atual->usado : 0;
+    memcpy(marca.bytesCategoria, arena->bytesCategoria, sizeof(marca.bytesCategoria));
+    return marca;
+}
+
+/**
+ * @brief Liberta tudo o que foi alocado numa arena depois da marca.
+ *
+ * Os blocos acrescentados depois da marca não são libertados: ficam disponíveis para as
+ * próximas alocações.
+ *
+ * @param arena Arena a restaurar.
+ * @param marca Marca obtida com marcarArena.
+ */
+void restaurarArena(Arena *arena, MarcaArena marca) {
+    descontarArena(arena, marca.bloco != NULL ? marca.bytesCategoria : NULL);
+
+    if (marca.bloco == NULL) {
+        // A marca foi feita com a arena vazia
+        arena->atual = arena->primeiro;
+        if (arena->atual != NULL)
+            arena->atual->usado = 0;
+        return;
     }
+
+    arena->atual = marca.bloco;
+    marca.bloco->usado = marca.usado;
 }
 
 /**
- * @brief Liberta toda a memória associada aos barcos do frame inicial.
+ * @brief Devolve a arena partilhada para memória temporária.
  *
- * Esta função percorre a lista de entidades (barcos) do frame zero e
- * liberta, de forma segura, tanto os nós da lista (`EntidadeIED`) como
- * as estruturas associadas (`NoVessel`), assumindo que já não existem
- * outros frames a referenciar os mesmos ponteiros.
+ * Usada para os dados auxiliares dos cálculos (grelha espacial, tabelas de colisões, ...).
+ * Quem a usa deve marcá-la antes e restaurá-la no fim.
  *
- * Deve ser chamada após a função `rewindFrames`, que garante que o
- * frame inicial é o único restante e que não há duplicação de
- * ponteiros `no_nautico` em memória.
+ * @return Arena temporária.
+ */
+Arena *arenaTemporaria(void) {
+    if (temporaria == NULL)
+        temporaria = obterArena();
+
+    return temporaria;
+}
+
+/**
+ * @brief Liberta todas as arenas livres e a arena temporária.
  *
- * @param frameZero Ponteiro para o frame inicial da simulação.
+ * Deve ser chamada no fim do programa, depois de libertados todos os frames.
  */
-void limparFrameInicial(BaseDados *frameZero) {
-    EntidadeIED *barco = frameZero->barcos;
-    while (barco != NULL) {
-        EntidadeIED *seguinte = barco->seguinte;
+void libertarArenas(void) {
+    while (arenasLivres != NULL) {
+        Arena *seguinte = arenasLivres->proximaLivre;
+        destruirArena(arenasLivres);
+        arenasLivres = seguinte;
+    }
+    numArenasLivres = 0;
 
-        if (barco->no_nautico != NULL)
-            free(barco->no_nautico);
+    if (temporaria != NULL) {
+        destruirArena(temporaria);
+        temporaria = NULL;
+    }
+}
 
-        free(barco);
-        barco = seguinte;
+// ================================================ CONTABILIDADE ======================================================
+
+static const char *nomesCategoriasMemoria[NUM_CATEGORIAS_MEMORIA] = {
+    "frames", "entidades", "navios", "colisoes", "barcos_colisao", "trajetorias", "arenas", "historico",
+    "auxiliar"
+};
+
+// Bytes vivos e máximos de cada categoria
+static ContabilidadeMemoria contabilidade;
+
+/**
+ * @brief Regista uma alocação (bytes > 0) ou libertação (bytes < 0) numa categoria de memória.
+ *
+ * Tal como as arenas, só deve ser usada pela thread principal.
+ *
+ * @param categoria Categoria da memória.
+ * @param bytes Variação do número de bytes vivos.
+ */
+void registarMemoria(CategoriaMemoria categoria, long long bytes) {
+    if (bytes == 0)
+        return;
+
+    contabilidade.vivos[categoria] += bytes;
+    if (bytes > 0) {
+        contabilidade.alocacoes[categoria]++;
+        if (contabilidade.vivos[categoria] > contabilidade.pico[categoria])
+            contabilidade.pico[categoria] = contabilidade.vivos[categoria];
     }
+}
+
+/**
+ * @brief Guarda os bytes vivos de cada categoria no início de um avanço da simulação.
+ */
+void iniciarAvancoMemoria(void) {
+    memcpy(contabilidade.inicioAvanco, contabilidade.vivos, sizeof(contabilidade.vivos));
+}
 
-    frameZero->barcos = NULL;
+/**
+ * @brief Regista a variação da memória viva desde iniciarAvancoMemoria.
+ *
+ * @param frames Número de frames avançados.
+ */
+void terminarAvancoMemoria(int frames) {
+    for (int c = 0; c < NUM_CATEGORIAS_MEMORIA; c++)
+        contabilidade.crescimento[c] = contabilidade.vivos[c] - contabilidade.inicioAvanco[c];
+    contabilidade.framesAvanco = frames;
 }
 
+/**
+ * @brief Imprime a memória viva e máxima de cada categoria e o crescimento por frame do último avanço.
+ *
+ * No modo em lote escreve uma linha "memoria <categoria> <vivos> <pico> <alocacoes> <bytes por frame>"
+ * por categoria, seguida de "memoria_avanco <frames do último avanço>".
+ *
+ * @param formato Formato da saída.
+ */
+void imprimirMemoria(FormatoSaida formato) {
+    int frames = contabilidade.framesAvanco;
+
+    if (formato == SAIDA_NENHUMA)
+        return;
+
+    if (formato == SAIDA_LOTE) {
+        for (int c = 0; c < NUM_CATEGORIAS_MEMORIA; c++)
+            printf("memoria %s %lld %lld %lld %.1f\n", nomesCategoriasMemoria[c], contabilidade.vivos[c],
+                   contabilidade.pico[c], contabilidade.alocacoes[c],
+                   frames > 0 ? (double) contabilidade.crescimento[c] / frames : 0.0);
+        printf("memoria_avanco %d\n", frames);
+        return;
+    }
+
+    printf("\n=== Memoria ===\n");
+    printf("%-15s %14s %14s %12s %14s\n", "Categoria", "Vivos (B)", "Pico (B)", "Alocacoes", "B/frame");
+    for (int c = 0; c < NUM_CATEGORIAS_MEMORIA; c++)
+        printf("%-15s %14lld %14lld %12lld %14.1f\n", nomesCategoriasMemoria[c], contabilidade.vivos[c],
+               contabilidade.pico[c], contabilidade.alocacoes[c],
+               frames > 0 ? (double) contabilidade.crescimento[c] / frames : 0.0);
+    printf("(B/frame: crescimento no último avanço, de %d frames)\n", frames);
+}
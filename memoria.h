@@ -3,11 +3,6 @@
 
 // ================================================ MEMORIA ============================================================
 
-/**
- * @brief Guarda o estado atual num ficheiro.
- */
-void guardarFrameNoFicheiro(BaseDados *frameAtual, int showOutput);
-
 /**
  * @brief Liberta toda a memória alocada dinamicamente a partir do frame 0.
  */
@@ -18,4 +13,126 @@ void limparFrameInicial(BaseDados *frameZero);
  */
 void apagarFramesFuturos(BaseDados **frameAtual, ListaFrames *listaFrames);
 
+/**
+ * @brief Garante espaço para pelo menos 'capacidade' entidades, mantendo as existentes.
+ */
+void reservarEntidades(BaseDados *frame, int capacidade);
+
+/**
+ * @brief Garante espaço para pelo menos 'capacidade' entidades, alocando-as numa arena.
+ */
+void reservarEntidadesNaArena(Arena *arena, EntidadesIED *entidades, int capacidade);
+
+/**
+ * @brief Copia 'n' entidades de um conjunto para outro.
+ */
+void copiarEntidades(EntidadesIED *destino, int inicioDestino, const EntidadesIED *origem, int inicioOrigem, int n);
+
+/**
+ * @brief Acrescenta uma entidade ao fim dos arrays do frame. Retorna o seu índice.
+ */
+int adicionarEntidade(BaseDados *frame, int x, int y, int vx, int vy, int navio, unsigned char flags);
+
+/**
+ * @brief Regista um novo navio. Retorna o seu índice no registo.
+ */
+int registarNavio(RegistoNavios *registo, unsigned int id, int tipologia, int frame);
+
+/**
+ * @brief Descarta os navios registados depois de um frame, ao recuar para esse frame.
+ */
+void descartarNaviosFuturos(RegistoNavios *registo, int numFrame);
+
+/**
+ * @brief Liberta todos os navios do registo.
+ */
+void libertarRegisto(RegistoNavios *registo);
+
+/**
+ * @brief Aloca um frame vazio, seguinte ao frame anterior e com o mesmo registo de navios.
+ */
+BaseDados *criarFrame(BaseDados *anterior, int capacidade);
+
+/**
+ * @brief Reaproveita a memória de um frame antigo para o frame seguinte a 'anterior'.
+ */
+BaseDados *reciclarFrame(BaseDados *frame, BaseDados *anterior, int capacidade);
+
+/**
+ * @brief Liberta um frame e tudo o que foi alocado na sua arena.
+ */
+void libertarFrame(BaseDados *frame);
+
+/**
+ * @brief Aloca memória na arena do frame (criando-a se ainda não existir).
+ */
+void *alocarNoFrame(BaseDados *frame, size_t bytes, CategoriaMemoria categoria);
+
+/**
+ * @brief Obtém uma arena vazia, reaproveitada sempre que possível.
+ */
+Arena *obterArena(void);
+
+/**
+ * @brief Devolve uma arena ao conjunto de arenas livres.
+ */
+void devolverArena(Arena *arena);
+
+/**
+ * @brief Aloca memória numa arena.
+ */
+void *alocarArena(Arena *arena, size_t bytes);
+
+/**
+ * @brief Memória ocupada por uma arena, em bytes.
+ */
+size_t memoriaArena(const Arena *arena);
+
+/**
+ * @brief Marca a posição atual de uma arena.
+ */
+MarcaArena marcarArena(Arena *arena);
+
+/**
+ * @brief Liberta tudo o que foi alocado numa arena depois da marca.
+ */
+void restaurarArena(Arena *arena, MarcaArena marca);
+
+/**
+ * @brief Arena partilhada para memória temporária dos cálculos.
+ */
+Arena *arenaTemporaria(void);
+
+/**
+ * @brief Liberta todas as arenas livres e a arena temporária.
+ */
+void libertarArenas(void);
+
+// ================================================ CONTABILIDADE ======================================================
+
+/**
+ * @brief Aloca memória numa arena, contabilizada na categoria indicada.
+ */
+void *alocarArenaCategoria(Arena *arena, size_t bytes, CategoriaMemoria categoria);
+
+/**
+ * @brief Regista a alocação (bytes > 0) ou libertação (bytes < 0) de memória de uma categoria.
+ */
+void registarMemoria(CategoriaMemoria categoria, long long bytes);
+
+/**
+ * @brief Marca o início de um avanço, para medir o crescimento da memória por frame.
+ */
+void iniciarAvancoMemoria(void);
+
+/**
+ * @brief Regista o crescimento da memória desde iniciarAvancoMemoria.
+ */
+void terminarAvancoMemoria(int frames);
+
+/**
+ * @brief Imprime a memória viva, máxima e o crescimento por frame de cada categoria.
+ */
+void imprimirMemoria(FormatoSaida formato);
+
 #endif //MEMORIA_H
@@ -0,0 +1,109 @@
+#include "modulo.h"
+#include <time.h>
+
+// ================================================ METRICAS ===========================================================
+
+static const char *nomesFases[NUM_FASES] = {
+    "direto", "saltos", "grelha", "comportamento", "movimento", "juncao", "colisoes", "historico"
+};
+
+static const char *nomesContadores[NUM_CONTADORES] = {
+    "frames", "barcos", "vizinhos", "colisoes", "alocacoes", "blocos"
+};
+
+// Tempos e contadores acumulados
+static Metricas metricas;
+
+/**
+ * @brief Devolve o instante atual do relógio monotónico, em nanossegundos.
+ */
+static long long instanteAtual(void) {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (long long) t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+/**
+ * @brief Começa a medir o tempo de uma fase.
+ *
+ * As fases são medidas apenas na thread principal; uma fase pode conter outras (por exemplo,
+ * o avanço direto calcula frames passo a passo), mas não pode conter-se a si própria.
+ *
+ * @param fase Fase a medir.
+ */
+void iniciarFase(FaseMetricas fase) {
+    metricas.inicioFase[fase] = instanteAtual();
+}
+
+/**
+ * @brief Termina a medição em curso de uma fase e acumula o tempo decorrido.
+ *
+ * @param fase Fase medida (iniciada com iniciarFase).
+ */
+void terminarFase(FaseMetricas fase) {
+    metricas.tempoFase[fase] += instanteAtual() - metricas.inicioFase[fase];
+    metricas.medicoesFase[fase]++;
+}
+
+/**
+ * @brief Soma um valor a um contador.
+ *
+ * A soma é atómica, pelo que pode ser feita pelas threads de executarEmParalelo.
+ *
+ * @param contador Contador a atualizar.
+ * @param n Valor a somar.
+ */
+void contarMetrica(ContadorMetricas contador, long long n) {
+    __atomic_fetch_add(&metricas.contadores[contador], n, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Põe a zero todos os tempos e contadores.
+ */
+void reiniciarMetricas(void) {
+    memset(&metricas, 0, sizeof(metricas));
+}
+
+/**
+ * @brief Imprime os tempos de cada fase e os contadores acumulados.
+ *
+ * No formato de texto mostra uma tabela. No modo em lote escreve uma linha
+ * "fase <nome> <medicoes> <tempo em ms>" por fase e "contador <nome> <valor>" por contador,
+ * seguidas de "metricas <1 se ativas, 0 se não foram compiladas>".
+ *
+ * @param formato Formato da saída.
+ */
+void imprimirMetricas(FormatoSaida formato) {
+#ifdef RADAR_METRICAS
+    int ativas = 1;
+#else
+    int ativas = 0;
+#endif
+
+    if (formato == SAIDA_NENHUMA)
+        return;
+
+    if (formato == SAIDA_LOTE) {
+        for (int f = 0; f < NUM_FASES; f++)
+            printf("fase %s %lld %.3f\n", nomesFases[f], metricas.medicoesFase[f], metricas.tempoFase[f] / 1e6);
+        for (int c = 0; c < NUM_CONTADORES; c++)
+            printf("contador %s %lld\n", nomesContadores[c], metricas.contadores[c]);
+        printf("metricas %d\n", ativas);
+        return;
+    }
+
+    printf("\n=== Métricas de Desempenho ===\n");
+    if (!ativas) {
+        printf("Métricas desativadas (compilar com -DRADAR_METRICAS).\n");
+        return;
+    }
+
+    printf("%-15s %12s %14s\n", "Fase", "Medicoes", "Tempo (ms)");
+    for (int f = 0; f < NUM_FASES; f++)
+        printf("%-15s %12lld %14.3f\n", nomesFases[f], metricas.medicoesFase[f], metricas.tempoFase[f] / 1e6);
+
+    printf("\n%-15s %12s\n", "Contador", "Valor");
+    for (int c = 0; c < NUM_CONTADORES; c++)
+        printf("%-15s %12lld\n", nomesContadores[c], metricas.contadores[c]);
+}
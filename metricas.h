@@ -0,0 +1,45 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+// ================================================ METRICAS ===========================================================
+
+/*
+ * As medições só são compiladas com -DRADAR_METRICAS. Sem essa opção as macros não geram código
+ * e imprimirMetricas indica que as métricas estão desativadas.
+ */
+#ifdef RADAR_METRICAS
+#define INICIAR_FASE(fase) iniciarFase(fase)
+#define TERMINAR_FASE(fase) terminarFase(fase)
+#define CONTAR(contador, n) contarMetrica(contador, n)
+#else
+#define INICIAR_FASE(fase) ((void) 0)
+#define TERMINAR_FASE(fase) ((void) 0)
+#define CONTAR(contador, n) ((void) (n))
+#endif
+
+/**
+ * @brief Começa a medir o tempo de uma fase.
+ */
+void iniciarFase(FaseMetricas fase);
+
+/**
+ * @brief Termina a medição em curso de uma fase e acumula o tempo decorrido.
+ */
+void terminarFase(FaseMetricas fase);
+
+/**
+ * @brief Soma um valor a um contador (pode ser chamada por várias threads).
+ */
+void contarMetrica(ContadorMetricas contador, long long n);
+
+/**
+ * @brief Põe a zero todos os tempos e contadores.
+ */
+void reiniciarMetricas(void);
+
+/**
+ * @brief Imprime os tempos e contadores acumulados no formato pedido.
+ */
+void imprimirMetricas(FormatoSaida formato);
+
+#endif //METRICAS_H
@@ -7,11 +7,23 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <limits.h>
 #include "estruturas.h"
 #include "input.h"
 #include "simulacao.h"
 #include "impressao.h"
 #include "interface.h"
 #include "memoria.h"
+#include "movimento.h"
+#include "paralelo.h"
+#include "historico.h"
+#include "previsao.h"
+#include "eventos.h"
+#include "lote.h"
+#include "metricas.h"
+#include "identificadores.h"
+#include "trajetorias.h"
+#include "estado.h"
+#include "saida.h"
 
 #endif
@@ -0,0 +1,219 @@
+#include "modulo.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MOVIMENTO_X86
+#endif
+
+// ================================================ MOVIMENTO ==========================================================
+
+/*
+ * Kernel de movimento: novaPos = pos + desl, seguido do teste de saída do radar e da
+ * compactação (stream compaction) dos barcos que continuam dentro dos limites.
+ *
+ * Há três implementações com resultados idênticos: escalar (qualquer plataforma), SSE2 e
+ * AVX2 (apenas x86). A implementação é escolhida na primeira chamada, conforme o
+ * processador, e pode ser forçada com a variável de ambiente RADAR_KERNEL
+ * ("escalar", "sse2" ou "avx2").
+ *
+ * Em todas as implementações cada escrita nos arrays de saída acontece numa posição
+ * k <= i, onde i é o índice de entrada, pelo que os arrays de saída só precisam de ter
+ * 'total' posições.
+ */
+
+/** @brief Assinatura comum às implementações do kernel. */
+typedef int (*KernelMovimento)(const int *, const int *, const int *, const int *, int,
+                               int, int, int *, int *, int *);
+
+/**
+ * @brief Implementação escalar do kernel, também usada para os elementos finais das versões SIMD.
+ */
+static int moverEscalar(const int *posX, const int *posY, const int *deslX, const int *deslY, int inicio,
+                        int total, int latitudeMax, int longitudeMax, int *novoX, int *novoY,
+                        int *sobreviventes, int k) {
+    for (int i = inicio; i < total; i++) {
+        int x = posX[i] + deslX[i];
+        int y = posY[i] + deslY[i];
+
+        // Escrita incondicional; só avança se o barco continua no radar
+        novoX[k] = x;
+        novoY[k] = y;
+        sobreviventes[k] = i;
+        k += (x >= 0) & (x < longitudeMax) & (y >= 0) & (y < latitudeMax);
+    }
+    return k;
+}
+
+static int kernelEscalar(const int *posX, const int *posY, const int *deslX, const int *deslY, int total,
+                         int latitudeMax, int longitudeMax, int *novoX, int *novoY, int *sobreviventes) {
+    return moverEscalar(posX, posY, deslX, deslY, 0, total, latitudeMax, longitudeMax,
+                        novoX, novoY, sobreviventes, 0);
+}
+
+#ifdef MOVIMENTO_X86
+
+/**
+ * @brief Implementação SSE2: 4 barcos por iteração, compactação sem saltos condicionais.
+ */
+__attribute__((target("sse2")))
+static int kernelSSE2(const int *posX, const int *posY, const int *deslX, const int *deslY, int total,
+                      int latitudeMax, int longitudeMax, int *novoX, int *novoY, int *sobreviventes) {
+    const __m128i menosUm = _mm_set1_epi32(-1);
+    const __m128i limiteX = _mm_set1_epi32(longitudeMax);
+    const __m128i limiteY = _mm_set1_epi32(latitudeMax);
+    int k = 0;
+    int i = 0;
+
+    for (; i + 4 <= total; i += 4) {
+        int tmpX[4], tmpY[4];
+        __m128i x = _mm_add_epi32(_mm_loadu_si128((const __m128i *) (posX + i)),
+                                  _mm_loadu_si128((const __m128i *) (deslX + i)));
+        __m128i y = _mm_add_epi32(_mm_loadu_si128((const __m128i *) (posY + i)),
+                                  _mm_loadu_si128((const __m128i *) (deslY + i)));
+        __m128i dentro = _mm_and_si128(
+            _mm_and_si128(_mm_cmpgt_epi32(x, menosUm), _mm_cmpgt_epi32(limiteX, x)),
+            _mm_and_si128(_mm_cmpgt_epi32(y, menosUm), _mm_cmpgt_epi32(limiteY, y)));
+        int mascara = _mm_movemask_ps(_mm_castsi128_ps(dentro));
+
+        _mm_storeu_si128((__m128i *) tmpX, x);
+        _mm_storeu_si128((__m128i *) tmpY, y);
+
+        for (int l = 0; l < 4; l++) {
+            novoX[k] = tmpX[l];
+            novoY[k] = tmpY[l];
+            sobreviventes[k] = i + l;
+            k += (mascara >> l) & 1;
+        }
+    }
+
+    return moverEscalar(posX, posY, deslX, deslY, i, total, latitudeMax, longitudeMax,
+                        novoX, novoY, sobreviventes, k);
+}
+
+// Para cada máscara de 8 bits, índices das pistas ativas seguidos das restantes
+static int permutacoesAVX2[256][8];
+
+/**
+ * @brief Preenche a tabela de permutações usada pela compactação AVX2.
+ */
+static void prepararPermutacoesAVX2(void) {
+    for (int mascara = 0; mascara < 256; mascara++) {
+        int k = 0;
+        for (int l = 0; l < 8; l++)
+            if (mascara & (1 << l))
+                permutacoesAVX2[mascara][k++] = l;
+        for (int l = 0; l < 8; l++)
+            if (!(mascara & (1 << l)))
+                permutacoesAVX2[mascara][k++] = l;
+    }
+}
+
+/**
+ * @brief Implementação AVX2: 8 barcos por iteração, compactação com permutação de pistas.
+ */
+__attribute__((target("avx2,popcnt")))
+static int kernelAVX2(const int *posX, const int *posY, const int *deslX, const int *deslY, int total,
+                      int latitudeMax, int longitudeMax, int *novoX, int *novoY, int *sobreviventes) {
+    const __m256i menosUm = _mm256_set1_epi32(-1);
+    const __m256i limiteX = _mm256_set1_epi32(longitudeMax);
+    const __m256i limiteY = _mm256_set1_epi32(latitudeMax);
+    const __m256i pistas = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    int k = 0;
+    int i = 0;
+
+    for (; i + 8 <= total; i += 8) {
+        __m256i x = _mm256_add_epi32(_mm256_loadu_si256((const __m256i *) (posX + i)),
+                                     _mm256_loadu_si256((const __m256i *) (deslX + i)));
+        __m256i y = _mm256_add_epi32(_mm256_loadu_si256((const __m256i *) (posY + i)),
+                                     _mm256_loadu_si256((const __m256i *) (deslY + i)));
+        __m256i dentro = _mm256_and_si256(
+            _mm256_and_si256(_mm256_cmpgt_epi32(x, menosUm), _mm256_cmpgt_epi32(limiteX, x)),
+            _mm256_and_si256(_mm256_cmpgt_epi32(y, menosUm), _mm256_cmpgt_epi32(limiteY, y)));
+        int mascara = _mm256_movemask_ps(_mm256_castsi256_ps(dentro));
+        __m256i perm = _mm256_loadu_si256((const __m256i *) permutacoesAVX2[mascara]);
+        __m256i indices = _mm256_add_epi32(_mm256_set1_epi32(i), pistas);
+
+        // Junta as pistas ativas no início e escreve as 8 (as restantes são sobrepostas depois)
+        _mm256_storeu_si256((__m256i *) (novoX + k), _mm256_permutevar8x32_epi32(x, perm));
+        _mm256_storeu_si256((__m256i *) (novoY + k), _mm256_permutevar8x32_epi32(y, perm));
+        _mm256_storeu_si256((__m256i *) (sobreviventes + k), _mm256_permutevar8x32_epi32(indices, perm));
+        k += _mm_popcnt_u32((unsigned int) mascara);
+    }
+
+    return moverEscalar(posX, posY, deslX, deslY, i, total, latitudeMax, longitudeMax,
+                        novoX, novoY, sobreviventes, k);
+}
+
+#endif
+
+static KernelMovimento kernelAtivo = NULL;
+static const char *nomeKernelAtivo = "escalar";
+
+/**
+ * @brief Escolhe a implementação do kernel conforme o processador e RADAR_KERNEL.
+ */
+static void escolherKernel(void) {
+    const char *pedido = getenv("RADAR_KERNEL");
+
+    kernelAtivo = kernelEscalar;
+    nomeKernelAtivo = "escalar";
+
+    if (pedido != NULL && strcmp(pedido, "escalar") == 0)
+        return;
+
+#ifdef MOVIMENTO_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt") &&
+        (pedido == NULL || strcmp(pedido, "avx2") == 0)) {
+        prepararPermutacoesAVX2();
+        kernelAtivo = kernelAVX2;
+        nomeKernelAtivo = "avx2";
+    } else if (__builtin_cpu_supports("sse2")) {
+        kernelAtivo = kernelSSE2;
+        nomeKernelAtivo = "sse2";
+    }
+#endif
+}
+
+/**
+ * @brief Move os barcos e compacta os que continuam dentro do radar.
+ *
+ * Para cada barco i calcula (posX[i] + deslX[i], posY[i] + deslY[i]). Os barcos cuja nova
+ * posição está dentro de [0, longitudeMax) x [0, latitudeMax) são escritos de forma
+ * contígua, pela ordem original, em novoX/novoY, e o seu índice original em sobreviventes.
+ *
+ * Os arrays de saída devem ter espaço para 'total' elementos e não podem coincidir com os
+ * de entrada.
+ *
+ * @param posX Posições atuais no eixo x.
+ * @param posY Posições atuais no eixo y.
+ * @param deslX Deslocamento de cada barco no eixo x.
+ * @param deslY Deslocamento de cada barco no eixo y.
+ * @param total Número de barcos.
+ * @param latitudeMax Número máximo de linhas (altura da grelha).
+ * @param longitudeMax Número máximo de colunas (largura da grelha).
+ * @param novoX Saída: novas posições no eixo x dos barcos que ficam no radar.
+ * @param novoY Saída: novas posições no eixo y dos barcos que ficam no radar.
+ * @param sobreviventes Saída: índice original de cada barco que fica no radar.
+ * @return Número de barcos que ficam no radar.
+ */
+int moverECompactar(const int *posX, const int *posY, const int *deslX, const int *deslY, int total,
+                    int latitudeMax, int longitudeMax, int *novoX, int *novoY, int *sobreviventes) {
+    if (kernelAtivo == NULL)
+        escolherKernel();
+
+    return kernelAtivo(posX, posY, deslX, deslY, total, latitudeMax, longitudeMax,
+                       novoX, novoY, sobreviventes);
+}
+
+/**
+ * @brief Devolve o nome da implementação do kernel de movimento em uso.
+ *
+ * @return "escalar", "sse2" ou "avx2".
+ */
+const char *kernelMovimentoAtivo(void) {
+    if (kernelAtivo == NULL)
+        escolherKernel();
+
+    return nomeKernelAtivo;
+}
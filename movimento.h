@@ -0,0 +1,17 @@
+#ifndef MOVIMENTO_H
+#define MOVIMENTO_H
+
+// ================================================ MOVIMENTO ==========================================================
+
+/**
+ * @brief Move os barcos e compacta os que continuam no radar. Retorna quantos sobreviveram.
+ */
+int moverECompactar(const int *posX, const int *posY, const int *deslX, const int *deslY, int total,
+                    int latitudeMax, int longitudeMax, int *novoX, int *novoY, int *sobreviventes);
+
+/**
+ * @brief Indica o nome da implementação do kernel de movimento em uso.
+ */
+const char *kernelMovimentoAtivo(void);
+
+#endif //MOVIMENTO_H
@@ -0,0 +1,188 @@
+#include "modulo.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+
+// ================================================ PARALELO ===========================================================
+
+/*
+ * Conjunto de threads auxiliares, criado na primeira tarefa paralela e reutilizado até
+ * ao fim do programa. A thread principal executa sempre a parte 0 de cada tarefa e a
+ * auxiliar t executa a parte t, pelo que a divisão do trabalho é determinística.
+ *
+ * O número de threads é o número de processadores disponíveis, ou o valor da variável
+ * de ambiente RADAR_THREADS (1 desativa o paralelismo).
+ */
+
+static pthread_mutex_t mutexThreads = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t condTrabalho = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t condFim = PTHREAD_COND_INITIALIZER;
+
+static pthread_t *auxiliares = NULL;  // Threads auxiliares (numThreads - 1)
+static int numThreads = 0;            // 0 enquanto não foi configurado
+static int auxiliaresCriadas = 0;
+
+static unsigned long geracao = 0;     // Incrementa a cada nova tarefa
+static int pendentes = 0;             // Partes ainda em execução nas auxiliares
+static int terminar = 0;
+
+static TarefaParalela tarefaAtual;
+static void *contextoAtual;
+static int totalAtual;
+static int partesAtuais;
+
+/**
+ * @brief Calcula o intervalo da parte 'parte' quando [0, total) é dividido em 'partes'.
+ *
+ * As partes têm tamanho múltiplo de 8 (exceto a última), para não partir os blocos
+ * processados pelos kernels SIMD.
+ */
+static void intervaloDaParte(int total, int partes, int parte, int *inicio, int *fim) {
+    int tamanho = ((total + partes - 1) / partes + 7) & ~7;
+
+    *inicio = parte * tamanho < total ? parte * tamanho : total;
+    *fim = *inicio + tamanho < total ? *inicio + tamanho : total;
+}
+
+/**
+ * @brief Ciclo de cada thread auxiliar: espera por uma tarefa, executa a sua parte e avisa.
+ */
+static void *cicloAuxiliar(void *argumento) {
+    int parte = (int) (intptr_t) argumento;
+    unsigned long vista = 0;
+
+    while (1) {
+        TarefaParalela tarefa;
+        void *contexto;
+        int inicio, fim;
+
+        pthread_mutex_lock(&mutexThreads);
+        while (geracao == vista && !terminar)
+            pthread_cond_wait(&condTrabalho, &mutexThreads);
+        if (terminar) {
+            pthread_mutex_unlock(&mutexThreads);
+            return NULL;
+        }
+        vista = geracao;
+        tarefa = tarefaAtual;
+        contexto = contextoAtual;
+        intervaloDaParte(totalAtual, partesAtuais, parte, &inicio, &fim);
+        pthread_mutex_unlock(&mutexThreads);
+
+        if (parte < partesAtuais)
+            tarefa(contexto, parte, inicio, fim);
+
+        pthread_mutex_lock(&mutexThreads);
+        if (--pendentes == 0)
+            pthread_cond_signal(&condFim);
+        pthread_mutex_unlock(&mutexThreads);
+    }
+}
+
+/**
+ * @brief Devolve o número de threads (incluindo a principal) usadas nas tarefas paralelas.
+ *
+ * @return Número de threads, pelo menos 1.
+ */
+int numeroThreads(void) {
+    if (numThreads == 0) {
+        const char *pedido = getenv("RADAR_THREADS");
+        long disponiveis = sysconf(_SC_NPROCESSORS_ONLN);
+
+        numThreads = pedido != NULL ? atoi(pedido) : (int) disponiveis;
+        if (numThreads < 1)
+            numThreads = 1;
+    }
+    return numThreads;
+}
+
+/**
+ * @brief Divide [0, total) em partes e executa a tarefa em paralelo.
+ *
+ * O número de partes é o menor entre o número de threads e total / minimoPorParte, para
+ * que tarefas pequenas corram diretamente na thread principal. A função só retorna
+ * depois de todas as partes terminarem.
+ *
+ * @param tarefa Função a executar para cada parte.
+ * @param contexto Dados partilhados, passados a todas as partes.
+ * @param total Número de elementos a processar.
+ * @param minimoPorParte Número mínimo de elementos que justifica uma parte.
+ * @return Número de partes em que o trabalho foi dividido (as partes vão de 0 a n-1).
+ */
+int executarEmParalelo(TarefaParalela tarefa, void *contexto, int total, int minimoPorParte) {
+    int partes = numeroThreads();
+    int inicio, fim;
+
+    if (minimoPorParte > 0 && total / minimoPorParte < partes)
+        partes = total / minimoPorParte;
+
+    // Trabalho pequeno ou sem threads: corre diretamente
+    if (partes <= 1) {
+        tarefa(contexto, 0, 0, total);
+        return 1;
+    }
+
+    pthread_mutex_lock(&mutexThreads);
+
+    // Cria as auxiliares na primeira utilização
+    if (!auxiliaresCriadas) {
+        auxiliares = malloc((size_t) (numThreads - 1) * sizeof(pthread_t));
+        if (!auxiliares) {
+            perror("Erro ao alocar threads");
+            exit(1);
+        }
+        for (int t = 1; t < numThreads; t++) {
+            if (pthread_create(&auxiliares[t - 1], NULL, cicloAuxiliar, (void *) (intptr_t) t) != 0) {
+                perror("Erro ao criar thread");
+                exit(1);
+            }
+        }
+        auxiliaresCriadas = 1;
+    }
+
+    // Publica a tarefa para todas as auxiliares
+    tarefaAtual = tarefa;
+    contextoAtual = contexto;
+    totalAtual = total;
+    partesAtuais = partes;
+    pendentes = numThreads - 1;
+    geracao++;
+    pthread_cond_broadcast(&condTrabalho);
+    pthread_mutex_unlock(&mutexThreads);
+
+    // A thread principal trata da parte 0
+    intervaloDaParte(total, partes, 0, &inicio, &fim);
+    tarefa(contexto, 0, inicio, fim);
+
+    pthread_mutex_lock(&mutexThreads);
+    while (pendentes > 0)
+        pthread_cond_wait(&condFim, &mutexThreads);
+    pthread_mutex_unlock(&mutexThreads);
+
+    return partes;
+}
+
+/**
+ * @brief Termina as threads auxiliares e espera que saiam.
+ *
+ * Deve ser chamada antes de o programa terminar. Pode ser chamada mesmo que nenhuma
+ * tarefa paralela tenha sido executada.
+ */
+void terminarThreads(void) {
+    pthread_mutex_lock(&mutexThreads);
+    if (!auxiliaresCriadas) {
+        pthread_mutex_unlock(&mutexThreads);
+        return;
+    }
+    terminar = 1;
+    pthread_cond_broadcast(&condTrabalho);
+    pthread_mutex_unlock(&mutexThreads);
+
+    for (int t = 1; t < numThreads; t++)
+        pthread_join(auxiliares[t - 1], NULL);
+
+    free(auxiliares);
+    auxiliares = NULL;
+    auxiliaresCriadas = 0;
+    terminar = 0;
+}
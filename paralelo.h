@@ -0,0 +1,26 @@
+#ifndef PARALELO_H
+#define PARALELO_H
+
+// ================================================ PARALELO ===========================================================
+
+/**
+ * @brief Tarefa executada por cada thread sobre o intervalo [inicio, fim) da parte indicada.
+ */
+typedef void (*TarefaParalela)(void *contexto, int parte, int inicio, int fim);
+
+/**
+ * @brief Número de threads (incluindo a principal) usadas nas tarefas paralelas.
+ */
+int numeroThreads(void);
+
+/**
+ * @brief Divide [0, total) em partes e executa a tarefa em paralelo. Retorna o número de partes.
+ */
+int executarEmParalelo(TarefaParalela tarefa, void *contexto, int total, int minimoPorParte);
+
+/**
+ * @brief Termina e espera pelas threads auxiliares.
+ */
+void terminarThreads(void);
+
+#endif //PARALELO_H
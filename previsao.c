@@ -0,0 +1,529 @@
+#include "modulo.h"
+
+// ================================================ PREVISAO ===========================================================
+
+/*
+ * Previsão analítica de colisões. Quando nenhum barco muda de velocidade ou de visibilidade
+ * (não há Cruzadores, Submarinos nem Rebocadores), a posição de cada barco no frame t é
+ * p + t * v até sair do radar ou colidir. Dois barcos de classes de velocidade va e vb só se
+ * encontram se pb - pa = t * (va - vb), pelo que os encontros possíveis se obtêm agrupando os
+ * barcos pela reta em que estão relativamente a (va - vb). Os encontros são depois processados
+ * por ordem cronológica, sem gerar frames.
+ */
+
+/**
+ * @brief Divisão inteira arredondada para baixo.
+ *
+ * @param a Dividendo.
+ * @param b Divisor (diferente de zero).
+ * @return O maior inteiro menor ou igual a a / b.
+ */
+long long dividirPorBaixo(long long a, long long b) {
+    long long q = a / b;
+
+    if ((a % b != 0) && ((a < 0) != (b < 0)))
+        q--;
+    return q;
+}
+
+/**
+ * @brief Calcula os frames t >= 1 em que uma coordenada c + t * w está dentro de [0, limite).
+ *
+ * @param c Coordenada inicial.
+ * @param w Velocidade nesse eixo.
+ * @param limite Dimensão do radar nesse eixo.
+ * @param inicio Primeiro frame do intervalo.
+ * @param fim Último frame do intervalo (SEM_SAIDA se não tem fim; menor que inicio se é vazio).
+ */
+static void intervaloNoEixo(int c, int w, int limite, long long *inicio, long long *fim) {
+    if (w == 0) {
+        *inicio = 1;
+        *fim = (c >= 0 && c < limite) ? SEM_SAIDA : 0;
+    } else if (w > 0) {
+        *inicio = -dividirPorBaixo(c, w);
+        *fim = dividirPorBaixo((long long) limite - 1 - c, w);
+    } else {
+        *inicio = -dividirPorBaixo((long long) limite - 1 - c, -w);
+        *fim = dividirPorBaixo(c, -w);
+    }
+}
+
+/**
+ * @brief Calcula o primeiro frame em que um barco com movimento linear já não está no radar.
+ *
+ * Tal como em moverECompactar, um barco fica no radar no frame t se 0 <= x < longitudeMax e
+ * 0 <= y < latitudeMax depois de se mover; a partir do primeiro frame em que isso falha é removido.
+ *
+ * @param x Posição inicial no eixo x.
+ * @param y Posição inicial no eixo y.
+ * @param vx Velocidade no eixo x.
+ * @param vy Velocidade no eixo y.
+ * @param latitudeMax Número máximo de linhas da grelha.
+ * @param longitudeMax Número máximo de colunas da grelha.
+ * @return Frame de saída (>= 1), ou SEM_SAIDA se o barco nunca sai.
+ */
+int frameDeSaida(int x, int y, int vx, int vy, int latitudeMax, int longitudeMax) {
+    long long inicioX, fimX, inicioY, fimY, inicio, fim;
+
+    intervaloNoEixo(x, vx, longitudeMax, &inicioX, &fimX);
+    intervaloNoEixo(y, vy, latitudeMax, &inicioY, &fimY);
+    inicio = inicioX > inicioY ? inicioX : inicioY;
+    fim = fimX < fimY ? fimX : fimY;
+
+    // Fora do radar logo no primeiro frame
+    if (inicio > 1 || fim < 1)
+        return 1;
+
+    return fim >= SEM_SAIDA ? SEM_SAIDA : (int) (fim + 1);
+}
+
+/**
+ * @brief Calcula a fase de um ponto na reta de direção (dx, dy) onde está.
+ *
+ * Dois pontos da mesma reta distam um múltiplo inteiro de (dx, dy) se e só se têm a mesma fase.
+ *
+ * @param x Posição no eixo x.
+ * @param y Posição no eixo y.
+ * @param dx Direção no eixo x.
+ * @param dy Direção no eixo y (diferente de zero se dx é zero).
+ * @return Resto da divisão de x por |dx| (ou de y por |dy| se dx é zero).
+ */
+static int faseNaReta(long long x, long long y, int dx, int dy) {
+    long long passo = dx != 0 ? (dx < 0 ? -dx : dx) : (dy < 0 ? -dy : dy);
+    long long c = dx != 0 ? x : y;
+
+    return (int) (c - dividirPorBaixo(c, passo) * passo);
+}
+
+/**
+ * @brief Calcula a posição de uma chave numa tabela de dispersão.
+ *
+ * @param chave Primeira parte da chave.
+ * @param chave2 Segunda parte da chave.
+ * @param chave3 Terceira parte da chave.
+ * @param mascara Capacidade da tabela menos um (a capacidade é uma potência de 2).
+ * @return Posição inicial da procura.
+ */
+static int posicaoNaTabela(long long chave, int chave2, int chave3, int mascara) {
+    unsigned long long h = (unsigned long long) chave * 0x9E3779B97F4A7C15ULL;
+
+    h ^= (unsigned long long) (unsigned int) chave2 * 0xC2B2AE3D27D4EB4FULL;
+    h ^= (unsigned long long) (unsigned int) chave3 * 0x165667B19E3779F9ULL;
+    h ^= h >> 29;
+    return (int) (h & (unsigned long long) mascara);
+}
+
+/**
+ * @brief Cria uma tabela de dispersão vazia na arena temporária.
+ *
+ * @param entradas Número máximo de chaves que vão ser inseridas.
+ * @param mascara Devolve a capacidade da tabela menos um.
+ * @return Ponteiro para a tabela.
+ */
+static EntradaPrevisao *criarTabela(int entradas, int *mascara) {
+    EntradaPrevisao *tabela;
+    int capacidade = 16;
+
+    while (capacidade < entradas * 2)
+        capacidade *= 2;
+
+    tabela = alocarArena(arenaTemporaria(), (size_t) capacidade * sizeof(EntradaPrevisao));
+    for (int i = 0; i < capacidade; i++)
+        tabela[i].valor = -1;
+
+    *mascara = capacidade - 1;
+    return tabela;
+}
+
+/**
+ * @brief Procura uma chave na tabela, criando a entrada (com valor -1) se ainda não existir.
+ *
+ * @param tabela Tabela de dispersão.
+ * @param mascara Capacidade da tabela menos um.
+ * @param chave Primeira parte da chave.
+ * @param chave2 Segunda parte da chave.
+ * @param chave3 Terceira parte da chave.
+ * @param nova Devolve 1 se a entrada foi criada agora.
+ * @return Ponteiro para a entrada.
+ */
+static EntradaPrevisao *entradaNaTabela(EntradaPrevisao *tabela, int mascara, long long chave, int chave2,
+                                        int chave3, int *nova) {
+    int h = posicaoNaTabela(chave, chave2, chave3, mascara);
+
+    while (tabela[h].valor != -1) {
+        if (tabela[h].chave == chave && tabela[h].chave2 == chave2 && tabela[h].chave3 == chave3) {
+            *nova = 0;
+            return &tabela[h];
+        }
+        h = (h + 1) & mascara;
+    }
+
+    tabela[h].chave = chave;
+    tabela[h].chave2 = chave2;
+    tabela[h].chave3 = chave3;
+    *nova = 1;
+    return &tabela[h];
+}
+
+/**
+ * @brief Procura uma chave na tabela.
+ *
+ * @param tabela Tabela de dispersão.
+ * @param mascara Capacidade da tabela menos um.
+ * @param chave Primeira parte da chave.
+ * @param chave2 Segunda parte da chave.
+ * @param chave3 Terceira parte da chave.
+ * @return Valor associado à chave, ou -1 se não existir.
+ */
+static int procurarNaTabela(const EntradaPrevisao *tabela, int mascara, long long chave, int chave2, int chave3) {
+    int h = posicaoNaTabela(chave, chave2, chave3, mascara);
+
+    while (tabela[h].valor != -1) {
+        if (tabela[h].chave == chave && tabela[h].chave2 == chave2 && tabela[h].chave3 == chave3)
+            return tabela[h].valor;
+        h = (h + 1) & mascara;
+    }
+    return -1;
+}
+
+/**
+ * @brief Acrescenta um encontro à lista de encontros previstos, aumentando-a se necessário.
+ *
+ * @param encontros Ponteiro para o array de encontros.
+ * @param num Ponteiro para o número de encontros.
+ * @param capacidade Ponteiro para a capacidade do array.
+ * @param t Número de frames até ao encontro.
+ * @param x Posição do encontro no eixo x.
+ * @param y Posição do encontro no eixo y.
+ * @param a Índice de um dos barcos.
+ * @param b Índice do outro barco (-1 se o encontro só indica a presença de a).
+ */
+static void acrescentarEncontro(EncontroPrevisto **encontros, int *num, int *capacidade, int t, int x, int y,
+                                int a, int b) {
+    if (*num == *capacidade) {
+        int novaCapacidade = *capacidade == 0 ? 256 : *capacidade * 2;
+        EncontroPrevisto *novos = realloc(*encontros, (size_t) novaCapacidade * sizeof(EncontroPrevisto));
+        if (!novos) {
+            perror("Erro ao alocar encontros previstos");
+            exit(1);
+        }
+        registarMemoria(MEMORIA_AUXILIAR, (long long) (novaCapacidade - *capacidade) *
+                                          (long long) sizeof(EncontroPrevisto));
+        *encontros = novos;
+        *capacidade = novaCapacidade;
+    }
+
+    (*encontros)[*num].t = t;
+    (*encontros)[*num].x = x;
+    (*encontros)[*num].y = y;
+    (*encontros)[*num].a = a;
+    (*encontros)[*num].b = b;
+    (*num)++;
+}
+
+/**
+ * @brief Compara dois encontros por frame e depois por posição (para qsort).
+ */
+static int compararEncontros(const void *a, const void *b) {
+    const EncontroPrevisto *ea = a, *eb = b;
+
+    if (ea->t != eb->t) return ea->t < eb->t ? -1 : 1;
+    if (ea->x != eb->x) return ea->x < eb->x ? -1 : 1;
+    if (ea->y != eb->y) return ea->y < eb->y ? -1 : 1;
+    return 0;
+}
+
+/**
+ * @brief Compara duas colisões previstas pela ordem em que são impressas (para qsort).
+ */
+static int compararColisoesPrevistas(const void *a, const void *b) {
+    const ColisaoPrevista *ca = a, *cb = b;
+
+    return (ca->ordem > cb->ordem) - (ca->ordem < cb->ordem);
+}
+
+/**
+ * @brief Compara dois inteiros (para qsort).
+ */
+static int compararInteiros(const void *a, const void *b) {
+    int ia = *(const int *) a, ib = *(const int *) b;
+
+    return (ia > ib) - (ia < ib);
+}
+
+/**
+ * @brief Indica se algum barco do frame tem um comportamento que não é linear.
+ *
+ * Os Cruzadores e os Rebocadores mudam de velocidade consoante os vizinhos e os Submarinos
+ * alternam a visibilidade, pelo que com algum destes barcos a previsão tem de avançar frame a frame.
+ *
+ * @param frame Frame a analisar.
+ * @return 1 se existe algum Cruzador, Submarino ou Rebocador, 0 caso contrário.
+ */
+int temMovimentoNaoLinear(BaseDados *frame) {
+    EntidadesIED *barcos = &frame->barcos;
+    NoVessel *navios = frame->registo->navios;
+
+    for (int i = 0; i < barcos->total; i++) {
+        int tipo = navios[barcos->navio[i]].tipologia;
+        if (tipo == 2 || tipo == 3 || tipo == 10)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Prevê analiticamente as colisões a partir de um frame em que todos os barcos têm movimento linear.
+ *
+ * O resultado é o mesmo que avançar frame a frame até não haver barcos em movimento: para cada
+ * barco calcula-se o frame em que sai do radar e, para cada par de classes de velocidade, os
+ * encontros possíveis entre barcos. Os encontros são processados por ordem de frame e posição;
+ * os barcos de todos os encontros numa posição são os que lá estão nesse frame (incluindo os que
+ * não colidem, que contam para a ordem de impressão, tal como em removerBarcosEmColisao).
+ *
+ * As colisões são impressas no mesmo formato que em previsaoDeColisoes. O frame não é alterado.
+ *
+ * @param frame Frame de partida (sem Cruzadores, Submarinos nem Rebocadores).
+ * @param latitudeMax Número máximo de linhas da grelha.
+ * @param longitudeMax Número máximo de colunas da grelha.
+ * @param formato Formato em que as colisões são impressas.
+ * @param numColisoes Contador incrementado por cada colisão prevista.
+ * @return Número de frames que a previsão frame a frame teria avançado.
+ */
+int preverColisoesLineares(BaseDados *frame, int latitudeMax, int longitudeMax, FormatoSaida formato,
+                           int *numColisoes) {
+    EntidadesIED *barcos = &frame->barcos;
+    NoVessel *navios = frame->registo->navios;
+    int n = barcos->total;
+    Arena *temporaria = arenaTemporaria();
+    MarcaArena marca = marcarArena(temporaria);
+    int maiorSaida = (latitudeMax > longitudeMax ? latitudeMax : longitudeMax) + 1;
+    int *saida, *colidiu, *elegivel, *proximo, *classe, *membros, *inicioClasse, *porSaida;
+    int *classeX, *classeY, *livre, *visto, *presentes, *envolvidos;
+    unsigned int *ids;
+    ColisaoPrevista *previstas;
+    EntradaPrevisao *classes, *posicoes;
+    int mascaraClasses, mascaraPosicoes;
+    int numClasses = 0;
+    EncontroPrevisto *encontros = NULL;
+    int numEncontros = 0, capacidadeEncontros = 0;
+    int ultimaSaida, ultimaColisao = 0;
+    int numFrames;
+
+    if (n == 0) {
+        restaurarArena(temporaria, marca);
+        return 0;
+    }
+
+    saida = alocarArena(temporaria, (size_t) n * sizeof(int));
+    colidiu = alocarArena(temporaria, (size_t) n * sizeof(int));
+    elegivel = alocarArena(temporaria, (size_t) n * sizeof(int));
+    proximo = alocarArena(temporaria, (size_t) n * sizeof(int));
+    classe = alocarArena(temporaria, (size_t) n * sizeof(int));
+    membros = alocarArena(temporaria, (size_t) n * sizeof(int));
+    visto = alocarArena(temporaria, (size_t) n * sizeof(int));
+    presentes = alocarArena(temporaria, (size_t) n * sizeof(int));
+    envolvidos = alocarArena(temporaria, (size_t) n * sizeof(int));
+    ids = alocarArena(temporaria, (size_t) n * sizeof(unsigned int));
+    previstas = alocarArena(temporaria, (size_t) (n / 2 + 1) * sizeof(ColisaoPrevista));
+    porSaida = alocarArena(temporaria, (size_t) (maiorSaida + 1) * sizeof(int));
+    memset(porSaida, 0, (size_t) (maiorSaida + 1) * sizeof(int));
+
+    // Classes de velocidade e frame de saída de cada barco
+    classes = criarTabela(n, &mascaraClasses);
+    for (int i = 0; i < n; i++) {
+        int nova;
+        EntradaPrevisao *e = entradaNaTabela(classes, mascaraClasses, barcos->velX[i], barcos->velY[i], 0, &nova);
+
+        if (nova) e->valor = numClasses++;
+        classe[i] = e->valor;
+        saida[i] = frameDeSaida(barcos->posX[i], barcos->posY[i], barcos->velX[i], barcos->velY[i],
+                                latitudeMax, longitudeMax);
+        elegivel[i] = navios[barcos->navio[i]].tipologia != 1;
+        colidiu[i] = 0;
+        visto[i] = -1;
+
+        // Barcos em movimento, contados pelo frame de saída (nunca maior que maiorSaida)
+        if (barcos->velX[i] != 0 || barcos->velY[i] != 0)
+            porSaida[saida[i]]++;
+    }
+
+    classeX = alocarArena(temporaria, (size_t) numClasses * sizeof(int));
+    classeY = alocarArena(temporaria, (size_t) numClasses * sizeof(int));
+    inicioClasse = alocarArena(temporaria, (size_t) (numClasses + 1) * sizeof(int));
+    memset(inicioClasse, 0, (size_t) (numClasses + 1) * sizeof(int));
+
+    // Barcos agrupados por classe, por ordem de índice
+    for (int i = 0; i < n; i++) {
+        classeX[classe[i]] = barcos->velX[i];
+        classeY[classe[i]] = barcos->velY[i];
+        inicioClasse[classe[i] + 1]++;
+    }
+    for (int k = 0; k < numClasses; k++)
+        inicioClasse[k + 1] += inicioClasse[k];
+    livre = alocarArena(temporaria, (size_t) numClasses * sizeof(int));
+    memcpy(livre, inicioClasse, (size_t) numClasses * sizeof(int));
+    for (int i = 0; i < n; i++)
+        membros[livre[classe[i]]++] = i;
+
+    // Barcos de cada classe encadeados pela posição inicial, por ordem de índice
+    posicoes = criarTabela(n, &mascaraPosicoes);
+    for (int i = n - 1; i >= 0; i--) {
+        int nova;
+        EntradaPrevisao *e = entradaNaTabela(posicoes, mascaraPosicoes, barcos->posX[i], barcos->posY[i],
+                                             classe[i], &nova);
+
+        proximo[i] = e->valor;
+        e->valor = i;
+    }
+
+    // Barcos da mesma classe na mesma posição estão juntos desde o primeiro frame
+    for (int h = 0; h <= mascaraPosicoes; h++) {
+        int contagem = 0, k = posicoes[h].chave3;
+
+        for (int i = posicoes[h].valor; i != -1; i = proximo[i])
+            if (elegivel[i] && saida[i] > 1) contagem++;
+        if (contagem < 2)
+            continue;
+
+        for (int i = posicoes[h].valor; i != -1; i = proximo[i])
+            if (saida[i] > 1)
+                acrescentarEncontro(&encontros, &numEncontros, &capacidadeEncontros, 1,
+                                    (int) posicoes[h].chave + classeX[k], posicoes[h].chave2 + classeY[k], i, -1);
+    }
+
+    // Encontros entre barcos de classes diferentes: pb - pa = t * (va - vb)
+    for (int ka = 0; ka < numClasses; ka++) {
+        for (int kb = ka + 1; kb < numClasses; kb++) {
+            int dx = classeX[ka] - classeX[kb];
+            int dy = classeY[ka] - classeY[kb];
+            int numB = inicioClasse[kb + 1] - inicioClasse[kb];
+            MarcaArena marcaPar;
+            EntradaPrevisao *retas;
+            int mascaraRetas;
+
+            if (numB == 0 || inicioClasse[ka + 1] == inicioClasse[ka])
+                continue;
+
+            // Barcos da classe kb agrupados pela reta de direção (dx, dy) onde estão
+            marcaPar = marcarArena(temporaria);
+            retas = criarTabela(numB, &mascaraRetas);
+            for (int j = inicioClasse[kb + 1] - 1; j >= inicioClasse[kb]; j--) {
+                int b = membros[j], nova;
+                long long x = barcos->posX[b], y = barcos->posY[b];
+                int fase = faseNaReta(x, y, dx, dy);
+                EntradaPrevisao *e = entradaNaTabela(retas, mascaraRetas, x * dy - y * dx, fase, 0, &nova);
+
+                proximo[b] = e->valor;
+                e->valor = b;
+            }
+
+            for (int j = inicioClasse[ka]; j < inicioClasse[ka + 1]; j++) {
+                int a = membros[j];
+                long long x = barcos->posX[a], y = barcos->posY[a];
+                int fase = faseNaReta(x, y, dx, dy);
+
+                for (int b = procurarNaTabela(retas, mascaraRetas, x * dy - y * dx, fase, 0); b != -1; b = proximo[b]) {
+                    int t = dx != 0 ? (barcos->posX[b] - barcos->posX[a]) / dx
+                                    : (barcos->posY[b] - barcos->posY[a]) / dy;
+
+                    // Os encontros com barcos que não colidem só servem para a ordem de impressão
+                    if ((elegivel[a] || elegivel[b]) && t >= 1 && t < saida[a] && t < saida[b])
+                        acrescentarEncontro(&encontros, &numEncontros, &capacidadeEncontros, t,
+                                            barcos->posX[a] + t * classeX[ka], barcos->posY[a] + t * classeY[ka],
+                                            a, b);
+                }
+            }
+            restaurarArena(temporaria, marcaPar);
+        }
+    }
+
+    if (numEncontros > 1)
+        qsort(encontros, (size_t) numEncontros, sizeof(EncontroPrevisto), compararEncontros);
+
+    // Processar os encontros frame a frame (só os frames com encontros)
+    ultimaSaida = maiorSaida;
+    for (int inicio = 0; inicio < numEncontros;) {
+        int t = encontros[inicio].t;
+        int fim = inicio;
+        int numPrevistas = 0, numEnvolvidos = 0;
+
+        while (fim < numEncontros && encontros[fim].t == t)
+            fim++;
+
+        // A previsão frame a frame só chega ao frame t se no frame t - 1 ainda há barcos em movimento
+        while (ultimaSaida > 0 && porSaida[ultimaSaida] == 0)
+            ultimaSaida--;
+        if (ultimaSaida < t)
+            break;
+
+        for (int e = inicio; e < fim;) {
+            int x = encontros[e].x, y = encontros[e].y;
+            int numPresentes = 0, primeiro = n;
+            int grupo = e;
+
+            // Barcos que no frame t estão nesta posição (todos os encontros da posição são consecutivos)
+            for (; e < fim && encontros[e].x == x && encontros[e].y == y; e++) {
+                int par[2];
+
+                par[0] = encontros[e].a;
+                par[1] = encontros[e].b;
+                for (int j = 0; j < 2; j++) {
+                    int i = par[j];
+
+                    if (i == -1 || visto[i] == grupo) continue;
+                    visto[i] = grupo;
+                    if (colidiu[i]) continue;
+                    if (i < primeiro) primeiro = i;
+                    if (elegivel[i]) presentes[numPresentes++] = i;
+                }
+            }
+
+            if (numPresentes >= 2) {
+                ColisaoPrevista *c = &previstas[numPrevistas++];
+
+                qsort(presentes, (size_t) numPresentes, sizeof(int), compararInteiros);
+                c->ordem = primeiro;
+                c->x = x;
+                c->y = y;
+                c->inicio = numEnvolvidos;
+                c->numBarcos = numPresentes;
+                memcpy(envolvidos + numEnvolvidos, presentes, (size_t) numPresentes * sizeof(int));
+                numEnvolvidos += numPresentes;
+            }
+        }
+
+        if (numPrevistas > 1)
+            qsort(previstas, (size_t) numPrevistas, sizeof(ColisaoPrevista), compararColisoesPrevistas);
+
+        for (int c = 0; c < numPrevistas; c++) {
+            for (int j = 0; j < previstas[c].numBarcos; j++) {
+                int i = envolvidos[previstas[c].inicio + j];
+
+                ids[j] = navios[barcos->navio[i]].id;
+
+                // O barco sai da previsão neste frame
+                colidiu[i] = t;
+                if (barcos->velX[i] != 0 || barcos->velY[i] != 0) {
+                    porSaida[saida[i]]--;
+                    ultimaColisao = t;
+                }
+            }
+            imprimirColisaoPrevista(frame->registo, frame->frame_atual_num + t, previstas[c].x, previstas[c].y,
+                                    ids, previstas[c].numBarcos, formato);
+            (*numColisoes)++;
+        }
+
+        inicio = fim;
+    }
+
+    // A previsão termina no primeiro frame sem barcos em movimento
+    while (ultimaSaida > 0 && porSaida[ultimaSaida] == 0)
+        ultimaSaida--;
+    numFrames = ultimaSaida > ultimaColisao ? ultimaSaida : ultimaColisao;
+
+    registarMemoria(MEMORIA_AUXILIAR, -(long long) capacidadeEncontros * (long long) sizeof(EncontroPrevisto));
+    free(encontros);
+    restaurarArena(temporaria, marca);
+    return numFrames;
+}
@@ -0,0 +1,31 @@
+#ifndef PREVISAO_H
+#define PREVISAO_H
+
+// ================================================ PREVISAO ===========================================================
+
+// Frame de saída de um barco que nunca sai do radar (ver frameDeSaida)
+#define SEM_SAIDA INT_MAX
+
+/**
+ * @brief Divisão inteira arredondada para baixo.
+ */
+long long dividirPorBaixo(long long a, long long b);
+
+/**
+ * @brief Primeiro frame t >= 1 em que um barco na posição (x, y) a mover-se (vx, vy) por frame já saiu do radar.
+ */
+int frameDeSaida(int x, int y, int vx, int vy, int latitudeMax, int longitudeMax);
+
+/**
+ * @brief Indica se o frame tem barcos cujo movimento não é linear (Cruzadores, Submarinos ou Rebocadores).
+ */
+int temMovimentoNaoLinear(BaseDados *frame);
+
+/**
+ * @brief Prevê e imprime as colisões de um frame só com barcos de movimento linear, sem gerar frames.
+ * Retorna o número de frames da previsão.
+ */
+int preverColisoesLineares(BaseDados *frame, int latitudeMax, int longitudeMax, FormatoSaida formato,
+                           int *numColisoes);
+
+#endif //PREVISAO_H
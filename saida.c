@@ -0,0 +1,504 @@
+#include "modulo.h"
+#include <pthread.h>
+#include <stdarg.h>
+
+// ================================================ SAIDA ==============================================================
+
+#define TAMANHO_BUFFER_SAIDA (1 << 20)  // Buffer do registo contínuo (1 MiB)
+#define MENSAGENS_SAIDA 8               // Mensagens em circulação entre a thread principal e a de escrita
+#define BYTES_BARCO_MENSAGEM (TAMANHO_INDICATIVO + 5 * (long long) sizeof(int))  // Por barco de uma mensagem
+
+// Ficheiro de saída da simulação, partilhado por todo o programa como o stdout
+static SaidaSimulacao saida = {"depois.txt", NULL, NULL, 0, -1};
+
+/*
+ * Escrita em segundo plano. A thread principal copia os dados a escrever para as mensagens da fila
+ * circular 'mensagensSaida' e a thread de escrita formata-os e escreve-os pela mesma ordem. Com a
+ * fila cheia, a thread principal espera que uma mensagem seja escrita.
+ */
+static pthread_mutex_t mutexSaida = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t condMensagemPronta = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t condMensagemLivre = PTHREAD_COND_INITIALIZER;
+
+static MensagemSaida mensagensSaida[MENSAGENS_SAIDA];
+static int mensagensProduzidas = 0;      // Mensagens entregues pela thread principal
+static int mensagensConsumidas = 0;      // Mensagens já escritas pela thread de escrita
+static int escritaAtiva = 0;             // A thread de escrita foi criada e ainda não terminou
+static int erroEscrita = 0;              // O ficheiro de saída ficou incompleto por um erro de escrita
+static pthread_t escritora;
+
+/**
+ * @brief Escreve os barcos de uma mensagem, um por linha.
+ *
+ * Cada linha tem o indicativo, a posição (latitude, longitude), o ângulo de deslocação, a
+ * velocidade escalar e o tipo.
+ *
+ * @param fp Ficheiro onde escrever.
+ * @param mensagem Mensagem com os barcos copiados de um frame.
+ */
+static void escreverBarcos(FILE *fp, const MensagemSaida *mensagem) {
+    // Percorrer todos os barcos copiados do frame
+    for (int i = 0; i < mensagem->total; i++) {
+        int lat;
+        int lon;
+        int vx;
+        int vy;
+        double angulo_rad;
+        int angulo_deg;
+        int velocidade;
+
+        // Guardar os dados do barco
+        lat = mensagem->posY[i];
+        lon = mensagem->posX[i];
+        vx = mensagem->velX[i];
+        vy = mensagem->velY[i];
+
+        // Calculo dos dados de cada barco
+        angulo_rad = atan2(vy, vx);  // radianos
+        angulo_deg = (int) round(angulo_rad * 180.0 / M_PI);
+        if (angulo_deg < 0)
+            angulo_deg += 360;
+
+        velocidade = (int) round(sqrt(vx * vx + vy * vy));
+
+        // Escreve no ficheiro
+        fprintf(fp, "%s %d %d %d %d %d\n", mensagem->indicativo[i], lat, lon, angulo_deg, velocidade,
+                mensagem->tipologia[i]);
+    }
+}
+
+/**
+ * @brief Executa uma mensagem na thread de escrita.
+ *
+ * Os erros são indicados no stderr. Os erros do registo contínuo são detetados quando o buffer é
+ * despejado (MENSAGEM_DESPEJAR) e limpos depois de indicados, para não serem repetidos.
+ *
+ * @param mensagem Mensagem a escrever.
+ * @return 1 se a mensagem foi escrita, 0 em caso de erro.
+ */
+static int escreverMensagem(const MensagemSaida *mensagem) {
+    FILE *fp;
+
+    switch (mensagem->tipo) {
+        case MENSAGEM_FICHEIRO:
+            // Abrir o ficheiro para escrita
+            fp = fopen(saida.ficheiro, "w");
+            if (!fp) {
+                fprintf(stderr, "Erro ao abrir %s: ", saida.ficheiro);
+                perror(NULL);
+                return 0;
+            }
+            escreverBarcos(fp, mensagem);
+            if (ferror(fp) | fclose(fp)) {
+                fprintf(stderr, "Erro ao escrever %s\n", saida.ficheiro);
+                return 0;
+            }
+            break;
+        case MENSAGEM_FRAME:
+            fprintf(saida.fp, "frame %d\n", mensagem->frame);
+            escreverBarcos(saida.fp, mensagem);
+            break;
+        case MENSAGEM_TEXTO:
+            fwrite(mensagem->texto, 1, mensagem->tamanhoTexto, saida.fp);
+            break;
+        case MENSAGEM_DESPEJAR:
+            if (fflush(saida.fp) != 0 || ferror(saida.fp)) {
+                fprintf(stderr, "Erro ao escrever %s\n", saida.ficheiro);
+                clearerr(saida.fp);
+                return 0;
+            }
+            break;
+        case MENSAGEM_FIM:
+            break;
+    }
+    return 1;
+}
+
+/**
+ * @brief Corpo da thread de escrita: escreve as mensagens pela ordem de entrega, até MENSAGEM_FIM.
+ */
+static void *escreverEmSegundoPlano(void *argumento) {
+    (void) argumento;
+
+    for (;;) {
+        MensagemSaida *mensagem;
+        int escrita;
+        int fim;
+
+        pthread_mutex_lock(&mutexSaida);
+        while (mensagensConsumidas == mensagensProduzidas)
+            pthread_cond_wait(&condMensagemPronta, &mutexSaida);
+        pthread_mutex_unlock(&mutexSaida);
+
+        mensagem = &mensagensSaida[mensagensConsumidas % MENSAGENS_SAIDA];
+        escrita = escreverMensagem(mensagem);
+        fim = mensagem->tipo == MENSAGEM_FIM;
+
+        // Depois disto a mensagem pode ser preenchida de novo pela thread principal
+        pthread_mutex_lock(&mutexSaida);
+        if (!escrita)
+            erroEscrita = 1;
+        else if (mensagem->tipo == MENSAGEM_FICHEIRO)
+            erroEscrita = 0;    // O ficheiro foi reescrito por inteiro
+        mensagensConsumidas++;
+        pthread_cond_signal(&condMensagemLivre);
+        pthread_mutex_unlock(&mutexSaida);
+
+        if (fim)
+            return NULL;
+    }
+}
+
+/**
+ * @brief Devolve a próxima mensagem a preencher, esperando que haja uma livre na fila.
+ *
+ * @param tipo Tipo da mensagem.
+ * @return Mensagem a preencher (vazia).
+ */
+static MensagemSaida *mensagemParaPreencher(TipoMensagemSaida tipo) {
+    MensagemSaida *mensagem;
+
+    pthread_mutex_lock(&mutexSaida);
+    while (mensagensProduzidas - mensagensConsumidas == MENSAGENS_SAIDA)
+        pthread_cond_wait(&condMensagemLivre, &mutexSaida);
+    pthread_mutex_unlock(&mutexSaida);
+
+    mensagem = &mensagensSaida[mensagensProduzidas % MENSAGENS_SAIDA];
+    mensagem->tipo = tipo;
+    mensagem->total = 0;
+    mensagem->tamanhoTexto = 0;
+    return mensagem;
+}
+
+/**
+ * @brief Entrega à thread de escrita a mensagem preenchida por último.
+ */
+static void entregarMensagem(void) {
+    pthread_mutex_lock(&mutexSaida);
+    mensagensProduzidas++;
+    pthread_cond_signal(&condMensagemPronta);
+    pthread_mutex_unlock(&mutexSaida);
+}
+
+/**
+ * @brief Copia para uma mensagem os barcos visíveis de um frame.
+ *
+ * Submarinos invisíveis (tipo 3 sem a flag BARCO_VISIVEL) são ignorados.
+ *
+ * @param mensagem Mensagem a preencher.
+ * @param frame Frame a copiar.
+ */
+static void copiarFrame(MensagemSaida *mensagem, BaseDados *frame) {
+    EntidadesIED *barcos = &frame->barcos;
+    NoVessel *navios = frame->registo->navios;
+    int n = 0;
+
+    if (barcos->total > mensagem->capacidade) {
+        int nova = barcos->total;
+
+        mensagem->indicativo = realloc(mensagem->indicativo, (size_t) nova * TAMANHO_INDICATIVO);
+        mensagem->posX = realloc(mensagem->posX, (size_t) nova * sizeof(int));
+        mensagem->posY = realloc(mensagem->posY, (size_t) nova * sizeof(int));
+        mensagem->velX = realloc(mensagem->velX, (size_t) nova * sizeof(int));
+        mensagem->velY = realloc(mensagem->velY, (size_t) nova * sizeof(int));
+        mensagem->tipologia = realloc(mensagem->tipologia, (size_t) nova * sizeof(int));
+        if (!mensagem->indicativo || !mensagem->posX || !mensagem->posY || !mensagem->velX || !mensagem->velY ||
+            !mensagem->tipologia) {
+            perror("Erro ao alocar mensagem de saída");
+            exit(1);
+        }
+        registarMemoria(MEMORIA_AUXILIAR, (long long) (nova - mensagem->capacidade) * BYTES_BARCO_MENSAGEM);
+        mensagem->capacidade = nova;
+    }
+
+    for (int i = 0; i < barcos->total; i++) {
+        NoVessel *navio = &navios[barcos->navio[i]];
+
+        // Ignoro os submarinos invisíveis
+        if (navio->tipologia == 3 && !(barcos->flags[i] & BARCO_VISIVEL))
+            continue;
+
+        memcpy(mensagem->indicativo[n], indicativoNavio(frame->registo, navio->id), TAMANHO_INDICATIVO);
+        mensagem->posX[n] = barcos->posX[i];
+        mensagem->posY[n] = barcos->posY[i];
+        mensagem->velX[n] = barcos->velX[i];
+        mensagem->velY[n] = barcos->velY[i];
+        mensagem->tipologia[n] = navio->tipologia;
+        n++;
+    }
+
+    mensagem->frame = frame->frame_atual_num;
+    mensagem->total = n;
+}
+
+/**
+ * @brief Acrescenta texto formatado (como printf) ao texto de uma mensagem.
+ *
+ * @param mensagem Mensagem MENSAGEM_TEXTO a preencher.
+ * @param formato Formato do texto.
+ */
+static void acrescentarTexto(MensagemSaida *mensagem, const char *formato, ...) {
+    va_list argumentos;
+    int tamanho;
+
+    va_start(argumentos, formato);
+    tamanho = vsnprintf(NULL, 0, formato, argumentos);
+    va_end(argumentos);
+
+    if (mensagem->tamanhoTexto + (size_t) tamanho + 1 > mensagem->capacidadeTexto) {
+        size_t nova = mensagem->capacidadeTexto ? mensagem->capacidadeTexto : 256;
+
+        while (nova < mensagem->tamanhoTexto + (size_t) tamanho + 1)
+            nova *= 2;
+        mensagem->texto = realloc(mensagem->texto, nova);
+        if (!mensagem->texto) {
+            perror("Erro ao alocar mensagem de saída");
+            exit(1);
+        }
+        registarMemoria(MEMORIA_AUXILIAR, (long long) (nova - mensagem->capacidadeTexto));
+        mensagem->capacidadeTexto = nova;
+    }
+
+    va_start(argumentos, formato);
+    vsnprintf(mensagem->texto + mensagem->tamanhoTexto, (size_t) tamanho + 1, formato, argumentos);
+    va_end(argumentos);
+    mensagem->tamanhoTexto += (size_t) tamanho;
+}
+
+/**
+ * @brief Entrega à thread de escrita uma cópia de um frame.
+ *
+ * @param tipo MENSAGEM_FICHEIRO ou MENSAGEM_FRAME.
+ * @param frame Frame a escrever.
+ */
+static void entregarFrame(TipoMensagemSaida tipo, BaseDados *frame) {
+    copiarFrame(mensagemParaPreencher(tipo), frame);
+    entregarMensagem();
+    if (tipo == MENSAGEM_FRAME)
+        saida.ultimoFrame = frame->frame_atual_num;
+}
+
+/**
+ * @brief Configura o ficheiro de saída e inicia a thread que o escreve.
+ *
+ * Toda a escrita (formatação incluída) é feita pela thread de escrita, a partir de cópias dos
+ * frames, para que a simulação não espere pelo disco; se a escrita se atrasar MENSAGENS_SAIDA
+ * mensagens, a simulação espera por ela. Ver esperarSaida e fecharSaida.
+ *
+ * Com registo contínuo o ficheiro é aberto uma única vez e começa com o frame inicial; depois
+ * são-lhe acrescentados os frames simulados cujo número é múltiplo de 'intervalo' (ver
+ * registarFrameSaida), as colisões (ver registarColisoesSaida) e os recuos (ver registarRecuoSaida),
+ * através de um buffer de TAMANHO_BUFFER_SAIDA bytes. Assim uma execução inteira pode ser analisada
+ * depois sem ser simulada de novo. Se o ficheiro não puder ser aberto, o programa termina com erro.
+ *
+ * @param ficheiro Caminho do ficheiro de saída (tem de existir até ao fim do programa).
+ * @param intervalo Intervalo entre os frames do registo contínuo, ou 0 para não o usar.
+ * @param frameInicial Frame em que a simulação começa.
+ */
+void abrirSaida(const char *ficheiro, int intervalo, BaseDados *frameInicial) {
+    saida.ficheiro = ficheiro;
+    saida.intervalo = intervalo;
+
+    if (intervalo > 0) {
+        saida.fp = fopen(ficheiro, "w");
+        saida.buffer = malloc(TAMANHO_BUFFER_SAIDA);
+        if (!saida.fp || !saida.buffer) {
+            perror("Erro ao abrir o ficheiro de saída");
+            exit(1);
+        }
+        registarMemoria(MEMORIA_AUXILIAR, TAMANHO_BUFFER_SAIDA);
+        setvbuf(saida.fp, saida.buffer, _IOFBF, TAMANHO_BUFFER_SAIDA);
+    }
+
+    mensagensProduzidas = 0;
+    mensagensConsumidas = 0;
+    if (pthread_create(&escritora, NULL, escreverEmSegundoPlano, NULL) != 0) {
+        perror("Erro ao criar thread");
+        exit(1);
+    }
+    escritaAtiva = 1;
+
+    if (saida.fp != NULL)
+        entregarFrame(MENSAGEM_FRAME, frameInicial);
+}
+
+/**
+ * @brief Indica se o registo contínuo está ativo.
+ *
+ * @return 1 se os frames simulados são escritos no ficheiro de saída, 0 caso contrário.
+ */
+int registoContinuo(void) {
+    return saida.fp != NULL;
+}
+
+/**
+ * @brief Limita um avanço sem eventos para que termine no próximo frame do registo contínuo.
+ *
+ * Os frames que o histórico completo deixa implícitos não passam pelo registo, por isso os
+ * avanços diretos param nos frames que têm de ser escritos.
+ *
+ * @param frame Número do frame atual.
+ * @param maximo Número de frames que se quer avançar.
+ * @return Número de frames a avançar (entre 1 e 'maximo').
+ */
+int framesAteRegisto(int frame, int maximo) {
+    int ateProximo;
+
+    if (saida.fp == NULL)
+        return maximo;
+
+    ateProximo = saida.intervalo - frame % saida.intervalo;
+    return ateProximo < maximo ? ateProximo : maximo;
+}
+
+/**
+ * @brief Acrescenta um frame simulado ao registo contínuo, se o seu número for múltiplo do intervalo.
+ *
+ * @param frame Frame acabado de simular.
+ */
+void registarFrameSaida(BaseDados *frame) {
+    if (saida.fp != NULL && frame->frame_atual_num % saida.intervalo == 0)
+        entregarFrame(MENSAGEM_FRAME, frame);
+}
+
+/**
+ * @brief Acrescenta ao registo contínuo as colisões de um frame simulado.
+ *
+ * Cada colisão é uma linha "colisao <frame> <x> <y> <barco> <barco> ...", como na previsão de
+ * colisões do modo em lote. As colisões são escritas em todos os frames, mesmo nos que não são
+ * múltiplos do intervalo.
+ *
+ * @param frame Frame em que as colisões ocorreram.
+ * @param colisoes Lista de colisões do frame.
+ */
+void registarColisoesSaida(BaseDados *frame, Colisao *colisoes) {
+    MensagemSaida *mensagem;
+
+    if (saida.fp == NULL || colisoes == NULL)
+        return;
+
+    mensagem = mensagemParaPreencher(MENSAGEM_TEXTO);
+    for (Colisao *c = colisoes; c != NULL; c = c->seguinte) {
+        acrescentarTexto(mensagem, "colisao %d %d %d", frame->frame_atual_num, c->x, c->y);
+        for (BarcosEmColisao *b = c->barcos; b != NULL; b = b->seguinte)
+            acrescentarTexto(mensagem, " %s", indicativoNavio(frame->registo, b->id));
+        acrescentarTexto(mensagem, "\n");
+    }
+    entregarMensagem();
+}
+
+/**
+ * @brief Acrescenta ao registo contínuo uma linha "recuar <frame>".
+ *
+ * Os frames escritos depois desta linha substituem os que tinham o mesmo número.
+ *
+ * @param frame Número do frame para onde se recuou.
+ */
+void registarRecuoSaida(int frame) {
+    if (saida.fp == NULL)
+        return;
+
+    acrescentarTexto(mensagemParaPreencher(MENSAGEM_TEXTO), "recuar %d\n", frame);
+    entregarMensagem();
+    saida.ultimoFrame = -1;
+}
+
+/**
+ * @brief Guarda os dados do frame atual no ficheiro de saída.
+ *
+ * Sem registo contínuo, o ficheiro é sobrescrito e fica só com os barcos do frame (ver
+ * escreverBarcos). Com registo contínuo, o frame é acrescentado ao registo, a menos que tenha
+ * sido o último escrito e não tenha sido alterado pelo utilizador, e o buffer é despejado para
+ * o ficheiro. A escrita é feita pela thread de escrita e os erros são indicados no stderr. Sem
+ * confirmação a função só espera se a fila estiver cheia; com confirmação espera que o frame esteja
+ * escrito (ver esperarSaida) e não a mostra se o ficheiro ficou incompleto; no registo contínuo
+ * isso acontece com qualquer erro de escrita.
+ *
+ * @param frameAtual Ponteiro para o frame atual cujos dados serão guardados.
+ * @param showOutput Valor booleano (0 ou 1) que indica se deve mostrar mensagem de sucesso.
+ */
+void guardarFrameNoFicheiro(BaseDados *frameAtual, int showOutput) {
+    if (saida.fp == NULL) {
+        entregarFrame(MENSAGEM_FICHEIRO, frameAtual);
+    } else {
+        if (frameAtual->frame_atual_num != saida.ultimoFrame || frameAtual->alterado)
+            entregarFrame(MENSAGEM_FRAME, frameAtual);
+        mensagemParaPreencher(MENSAGEM_DESPEJAR);
+        entregarMensagem();
+    }
+
+    // Mostra mensagem de confirmação se pedido, só depois de o frame estar no ficheiro
+    if (showOutput && esperarSaida()) {
+        printf("Frame %d guardado com sucesso em %s\n", frameAtual->frame_atual_num, saida.ficheiro);
+    }
+}
+
+/**
+ * @brief Espera que a thread de escrita escreva todas as mensagens entregues.
+ *
+ * Com registo contínuo, o buffer também é despejado para o ficheiro. Deve ser chamada antes de
+ * outro programa ler o ficheiro de saída.
+ *
+ * @return 1 se o ficheiro de saída está completo, 0 se houve um erro de escrita que não foi
+ *         corrigido por reescrever o ficheiro por inteiro.
+ */
+int esperarSaida(void) {
+    int escrito;
+
+    if (!escritaAtiva)
+        return 1;
+
+    if (saida.fp != NULL) {
+        mensagemParaPreencher(MENSAGEM_DESPEJAR);
+        entregarMensagem();
+    }
+
+    pthread_mutex_lock(&mutexSaida);
+    while (mensagensConsumidas != mensagensProduzidas)
+        pthread_cond_wait(&condMensagemLivre, &mutexSaida);
+    escrito = !erroEscrita;
+    pthread_mutex_unlock(&mutexSaida);
+
+    return escrito;
+}
+
+/**
+ * @brief Escreve tudo o que falta, termina a thread de escrita e fecha o registo contínuo.
+ *
+ * Deve ser chamada antes de o programa terminar, para que nada do que foi guardado se perca, e
+ * antes de a simulação ser desfeita no fim do programa, para que esse recuo não fique no registo.
+ * Um erro de escrita é indicado no stderr.
+ */
+void fecharSaida(void) {
+    if (!escritaAtiva)
+        return;
+
+    mensagemParaPreencher(MENSAGEM_FIM);
+    entregarMensagem();
+    pthread_join(escritora, NULL);
+    escritaAtiva = 0;
+
+    for (int m = 0; m < MENSAGENS_SAIDA; m++) {
+        MensagemSaida *mensagem = &mensagensSaida[m];
+
+        registarMemoria(MEMORIA_AUXILIAR, -((long long) mensagem->capacidade * BYTES_BARCO_MENSAGEM +
+                                            (long long) mensagem->capacidadeTexto));
+        free(mensagem->indicativo);
+        free(mensagem->posX);
+        free(mensagem->posY);
+        free(mensagem->velX);
+        free(mensagem->velY);
+        free(mensagem->tipologia);
+        free(mensagem->texto);
+        memset(mensagem, 0, sizeof(MensagemSaida));
+    }
+
+    if (saida.fp != NULL) {
+        if (ferror(saida.fp) | fclose(saida.fp))
+            fprintf(stderr, "Erro ao escrever %s\n", saida.ficheiro);
+        registarMemoria(MEMORIA_AUXILIAR, -(long long) TAMANHO_BUFFER_SAIDA);
+        free(saida.buffer);
+        saida.fp = NULL;
+        saida.buffer = NULL;
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef SAIDA_H
+#define SAIDA_H
+
+// ================================================ SAIDA ==============================================================
+
+/**
+ * @brief Configura o ficheiro de saída, inicia a thread de escrita e abre o registo contínuo se 'intervalo' > 0.
+ */
+void abrirSaida(const char *ficheiro, int intervalo, BaseDados *frameInicial);
+
+/**
+ * @brief Indica se os frames simulados são escritos no ficheiro de saída.
+ */
+int registoContinuo(void);
+
+/**
+ * @brief Limita um avanço sem eventos para que termine no próximo frame do registo contínuo.
+ */
+int framesAteRegisto(int frame, int maximo);
+
+/**
+ * @brief Acrescenta um frame simulado ao registo contínuo, se for múltiplo do intervalo.
+ */
+void registarFrameSaida(BaseDados *frame);
+
+/**
+ * @brief Acrescenta ao registo contínuo as colisões de um frame simulado.
+ */
+void registarColisoesSaida(BaseDados *frame, Colisao *colisoes);
+
+/**
+ * @brief Acrescenta ao registo contínuo um recuo para um frame.
+ */
+void registarRecuoSaida(int frame);
+
+/**
+ * @brief Guarda o frame atual no ficheiro de saída.
+ */
+void guardarFrameNoFicheiro(BaseDados *frameAtual, int showOutput);
+
+/**
+ * @brief Espera que todas as mensagens entregues estejam escritas. Retorna 0 se houve um erro de escrita.
+ */
+int esperarSaida(void);
+
+/**
+ * @brief Escreve tudo o que falta, termina a thread de escrita e fecha o registo contínuo.
+ */
+void fecharSaida(void);
+
+#endif //SAIDA_H
@@ -2,6 +2,74 @@
 
 // ================================================ SIMULACAO ==========================================================
 
+// Lado mínimo das células da grelha espacial (igual ao maior raio de proximidade usado, o do Rebocador)
+#define TAMANHO_CELULA 5
+
+// Número mínimo de barcos por thread para dividir o cálculo de um frame
+#define LIMIAR_PARALELO 4096
+
+// Número mínimo de frames de um avanço para os frames intermédios não serem guardados (ver avancarDireto)
+#define LIMIAR_AVANCO_DIRETO 256
+
+/**
+ * @brief Avança um número de frames sem eventos, calculando-os diretamente.
+ *
+ * No histórico completo só é guardado o último frame: os frames intermédios ficam implícitos
+ * e são calculados quando forem pedidos (ver recuarHistorico e percorrerHistorico). Nos
+ * outros modos cada frame tem de passar pelo histórico, pelo que é extrapolado um a um.
+ * Com o registo contínuo, os frames a escrever no ficheiro de saída também são guardados
+ * (ver framesAteRegisto).
+ *
+ * @param frameAtual Ponteiro para o ponteiro do frame atual da simulação.
+ * @param listaFrames Histórico de frames.
+ * @param numFrames Número de frames a avançar (não maior que framesSemEventos do frame atual).
+ */
+static void avancarSemEventos(BaseDados **frameAtual, ListaFrames *listaFrames, int numFrames) {
+    int passo;
+
+    for (int avancados = 0; avancados < numFrames; avancados += passo) {
+        BaseDados *novoFrame = novoFrameHistorico(listaFrames, *frameAtual, (*frameAtual)->barcos.total);
+
+        passo = listaFrames->config.modo == HISTORICO_COMPLETO ?
+                framesAteRegisto((*frameAtual)->frame_atual_num, numFrames - avancados) : 1;
+        extrapolarFrame(*frameAtual, novoFrame, passo);
+        acrescentarFrame(listaFrames, novoFrame);
+        registarFrameSaida(novoFrame);
+        *frameAtual = novoFrame;
+    }
+}
+
+/**
+ * @brief Calcula quantos frames de um avanço podem ser calculados diretamente, sem ficarem no histórico.
+ *
+ * No histórico completo os frames que não são guardados ficam implícitos e no modo anel só os
+ * últimos frames ficam no anel. Os modos delta e de pontos de controlo precisam de todos, e o
+ * registo contínuo também (as colisões do avanço direto não ficam associadas a um frame).
+ *
+ * @param listaFrames Histórico de frames.
+ * @param numFrames Número de frames do avanço.
+ * @return Número de frames a calcular com avancarDireto (0 se o avanço não é longo o suficiente).
+ */
+static int framesDiretos(ListaFrames *listaFrames, int numFrames) {
+    int diretos;
+
+    if (registoContinuo())
+        return 0;
+
+    switch (listaFrames->config.modo) {
+        case HISTORICO_COMPLETO:
+            diretos = numFrames;
+            break;
+        case HISTORICO_ANEL:
+            diretos = numFrames - listaFrames->config.profundidade;
+            break;
+        default:
+            return 0;
+    }
+
+    return diretos >= LIMIAR_AVANCO_DIRETO ? diretos : 0;
+}
+
 /**
  * @brief Avança a simulação um número específico de frames.
  *
@@ -11,6 +79,16 @@
  * automaticamente barcos em colisão. Os frames gerados são ligados à lista
  * de frames existente, e a memória é corretamente alocada.
  *
+ * Os frames em que nenhum barco interage, sai do radar ou colide são calculados diretamente
+ * a partir do último frame (ver saltoSemEventos e avancarSemEventos), em vez de passo a passo.
+ * Num avanço longo, os frames que não ficam no histórico são todos calculados de uma vez com
+ * avancarDireto, que só calcula passo a passo os barcos que interagem com outros.
+ *
+ * Os registos de colisão são alocados na arena do frame em que ocorreram, pelo que
+ * a lista devolvida é válida enquanto esses frames existirem e não deve ser libertada.
+ * Com um histórico compacto os frames mais antigos deixam de estar em memória, por isso
+ * nesse caso só são devolvidas as colisões do último frame gerado.
+ *
  * Ao final, o último frame gerado é guardado em ficheiro, e é devolvida a lista
  * de colisões registadas ao longo dos frames criados.
  *
@@ -26,112 +104,61 @@ Colisao *avancarFrame(BaseDados **frameAtual, ListaFrames *listaFrames, int numF
                       int longitudeMax, int showOutput) {
     Colisao *colisoes = NULL;           // Lista global de colisões acumuladas
     Colisao *ultimaColisao = NULL;      // Ponteiro para a última colisão da lista
+    ProcuraEventos procura;             // Estado da procura de frames sem eventos
+    int diretos = framesDiretos(listaFrames, numFrames);
+    int pedidos = numFrames;            // Frames pedidos (para o crescimento da memória por frame)
 
-    // Gera numFrames frames novos
-    for (int i = 0; i < numFrames; i++) {
-        // Cria novo frame
-        BaseDados *novoFrame = malloc(sizeof(BaseDados));
-        EntidadeIED *anterior = (*frameAtual)->barcos;  // Lista de barcos do frame anterior
-        EntidadeIED *novaLista = NULL;                  // Nova lista para o novo frame
-        EntidadeIED *ultima = NULL;                     // Último elemento da nova lista
-        Colisao *colisoesFrame;                         // Colisões
-        if (!novoFrame) {
-            perror("Erro ao alocar novo frame");
-            exit(1);
-        }
+    iniciarAvancoMemoria();
 
-        novoFrame->barcos = NULL;
-        novoFrame->prev = *frameAtual;
-        novoFrame->next = NULL;
-        novoFrame->frame_atual_num = (*frameAtual)->frame_atual_num + 1;
-
-        // Processar cada barco do frame anterior
-        while (anterior != NULL) {
-            int tipo = anterior->no_nautico->tipologia;
-            int novaX, novaY;
-            EntidadeIED *novo;
-
-            // Comportamento específico por tipo de barco
-            switch (tipo) {
-                case 1:  // ProfPaiMau - Movimento padrão
-                    novaX = anterior->posicao[0] + anterior->velocidade[0];
-                    novaY = anterior->posicao[1] + anterior->velocidade[1];
-                    break;
-                case 2:  // Cruzador - Duplica velocidade se ninguém perto
-                    if (!temBarcosADistancia(*frameAtual, anterior, 4)) {
-                        novaX = anterior->posicao[0] + anterior->velocidade[0] * 2;
-                        novaY = anterior->posicao[1] + anterior->velocidade[1] * 2;
-                    } else {
-                        novaX = anterior->posicao[0] + anterior->velocidade[0];
-                        novaY = anterior->posicao[1] + anterior->velocidade[1];
-                    }
-                    break;
-                case 3:  // Submarino - Alterna visibilidade a cada 5 frames
-                    if ((novoFrame->frame_atual_num % 5) == 0)
-                        anterior->no_nautico->isVisible = !anterior->no_nautico->isVisible;
-                    novaX = anterior->posicao[0] + anterior->velocidade[0];
-                    novaY = anterior->posicao[1] + anterior->velocidade[1];
-                    break;
-                case 10: // Rebocador - Move 1 casa se estiver próximo de outro barco
-                    if (temBarcosADistancia(*frameAtual, anterior, 5)) {
-                        int dirX = anterior->velocidade[0];
-                        int dirY = anterior->velocidade[1];
-                        int vx = (dirX == 0) ? 0 : (dirX > 0 ? 1 : -1);
-                        int vy = (dirY == 0) ? 0 : (dirY > 0 ? 1 : -1);
-                        novaX = anterior->posicao[0] + vx;
-                        novaY = anterior->posicao[1] + vy;
-                        anterior->velocidade[0] = vx;
-                        anterior->velocidade[1] = vy;
-                    } else {
-                        novaX = anterior->posicao[0] + anterior->velocidade[0];
-                        novaY = anterior->posicao[1] + anterior->velocidade[1];
-                    }
-                    break;
-                default: // Comportamento genérico
-                    novaX = anterior->posicao[0] + anterior->velocidade[0];
-                    novaY = anterior->posicao[1] + anterior->velocidade[1];
-                    break;
-            }
+    // Avanço longo: os frames que não ficam no histórico são calculados diretamente
+    if (diretos > 0) {
+        BaseDados *novoFrame = novoFrameHistorico(listaFrames, *frameAtual, (*frameAtual)->barcos.total);
 
-            // Se barco saiu fora do radar é ignorado
-            if (novaX < 0 || novaX >= longitudeMax || novaY < 0 || novaY >= latitudeMax) {
-                if (showOutput)
-                    printf("\033[1;31mBarco %c saiu do radar\033[0m\n", anterior->no_nautico->nome);
-                anterior = anterior->seguinte;
-                continue;
-            }
+        INICIAR_FASE(FASE_DIRETO);
+        colisoes = avancarDireto(*frameAtual, novoFrame, diretos, latitudeMax, longitudeMax, showOutput,
+                                 &listaFrames->trajetorias);
+        TERMINAR_FASE(FASE_DIRETO);
+        ultimaColisao = colisoes;
+        while (ultimaColisao != NULL && ultimaColisao->seguinte != NULL)
+            ultimaColisao = ultimaColisao->seguinte;
 
-            // Aloca nova entidade para este frame
-            novo = malloc(sizeof(EntidadeIED));
-            if (!novo) {
-                perror("Erro ao alocar barco");
-                exit(1);
-            }
+        acrescentarFrame(listaFrames, novoFrame);
+        *frameAtual = novoFrame;
+        numFrames -= diretos;
+    }
 
-            // Copia os dados
-            novo->posicao[0] = novaX;
-            novo->posicao[1] = novaY;
-            novo->velocidade[0] = anterior->velocidade[0];
-            novo->velocidade[1] = anterior->velocidade[1];
-            novo->no_nautico = anterior->no_nautico;
-            novo->seguinte = NULL;
-
-            // Adiciono à lista ligada
-            if (novaLista == NULL)
-                novaLista = novo;
-            else
-                ultima->seguinte = novo;
+    iniciarProcuraEventos(&procura);
 
-            ultima = novo;
-            anterior = anterior->seguinte;
+    // Gera numFrames frames novos
+    for (int i = 0; i < numFrames; i++) {
+        BaseDados *novoFrame;
+        Colisao *colisoesFrame;
+        int saltados;
+
+        // Salta os frames em que nenhum barco interage
+        INICIAR_FASE(FASE_SALTOS);
+        saltados = saltoSemEventos(&procura, *frameAtual, numFrames - i, latitudeMax, longitudeMax);
+        if (saltados > 0)
+            avancarSemEventos(frameAtual, listaFrames, saltados);
+        TERMINAR_FASE(FASE_SALTOS);
+        if (saltados > 0) {
+            i += saltados - 1;
+            continue;
         }
 
-        // Remove barcos que colidiram neste frame e obtém a lista de colisões
-        colisoesFrame = removerBarcosEmColisao(&novaLista, showOutput);
+        // Cria novo frame com espaço para todos os barcos do frame anterior
+        INICIAR_FASE(FASE_HISTORICO);
+        novoFrame = novoFrameHistorico(listaFrames, *frameAtual, (*frameAtual)->barcos.total);
+        TERMINAR_FASE(FASE_HISTORICO);
+
+        // Calcula as novas posições e remove os barcos em colisão
+        colisoesFrame = calcularFrameSeguinte(*frameAtual, novoFrame, latitudeMax, longitudeMax, showOutput);
 
-        // Junta colisões detetadas à lista global
-        if (colisoes == NULL) {
+        // Junta colisões detetadas à lista global (ou recomeça-a, se os frames anteriores
+        // vão deixar de estar em memória)
+        if (colisoes == NULL || listaFrames->config.modo != HISTORICO_COMPLETO) {
             colisoes = colisoesFrame;
+            ultimaColisao = NULL;
         } else {
             ultimaColisao->seguinte = colisoesFrame;
         }
@@ -144,71 +171,410 @@ Colisao *avancarFrame(BaseDados **frameAtual, ListaFrames *listaFrames, int numF
             ultimaColisao = tmp;
         }
 
-        // Liga o novo frame à lista de frames
-        novoFrame->barcos = novaLista;
-        (*frameAtual)->next = novoFrame;
-        novoFrame->prev = *frameAtual;
+        // Liga o novo frame ao histórico
+        INICIAR_FASE(FASE_HISTORICO);
+        acrescentarFrame(listaFrames, novoFrame);
+        TERMINAR_FASE(FASE_HISTORICO);
         *frameAtual = novoFrame;
-        listaFrames->tail = novoFrame;
-        listaFrames->total_frames++;
+
+        // Acrescenta as colisões e o frame ao registo contínuo, se ativo
+        registarColisoesSaida(novoFrame, colisoesFrame);
+        registarFrameSaida(novoFrame);
     }
 
+    terminarAvancoMemoria(pedidos);
+
     // Retorna lista completa de colisões detetadas
     return colisoes;
 }
 
+
+/**
+ * @brief Fase 1 do cálculo de um frame, para os barcos [inicio, fim).
+ *
+ * Determina o deslocamento, a velocidade e as flags de cada barco no novo frame. Por omissão
+ * cada barco desloca-se a sua velocidade e mantém velocidade e flags; só o Cruzador, o
+ * Submarino e o Rebocador precisam de tratamento próprio. O frame anterior não é alterado.
+ */
+static void calcularComportamentos(void *contexto, int parte, int inicio, int fim) {
+    PassoFrame *passo = contexto;
+    EntidadesIED *origem = &passo->anterior->barcos;
+    EntidadesIED *destino = &passo->novo->barcos;
+    NoVessel *navios = passo->anterior->registo->navios;
+    size_t n = (size_t) (fim - inicio);
+    int consultas = 0;  // Verificações de proximidade, para as métricas
+    (void) parte;
+
+    memcpy(passo->deslX + inicio, origem->velX + inicio, n * sizeof(int));
+    memcpy(passo->deslY + inicio, origem->velY + inicio, n * sizeof(int));
+    memcpy(destino->velX + inicio, origem->velX + inicio, n * sizeof(int));
+    memcpy(destino->velY + inicio, origem->velY + inicio, n * sizeof(int));
+    memcpy(destino->navio + inicio, origem->navio + inicio, n * sizeof(int));
+    memcpy(destino->flags + inicio, origem->flags + inicio, n);
+
+    for (int i = inicio; i < fim; i++) {
+        switch (navios[origem->navio[i]].tipologia) {
+            case 2:  // Cruzador - Duplica velocidade se ninguém perto
+                consultas++;
+                if (!temBarcosADistancia(passo->anterior, i, 4, passo->alterna ? i : 0)) {
+                    passo->deslX[i] *= 2;
+                    passo->deslY[i] *= 2;
+                }
+                break;
+            case 3:  // Submarino - Alterna visibilidade a cada 5 frames
+                if (passo->alterna)
+                    destino->flags[i] ^= BARCO_VISIVEL;
+                break;
+            case 10: // Rebocador - Move 1 casa se estiver próximo de outro barco
+                consultas++;
+                if (temBarcosADistancia(passo->anterior, i, 5, passo->alterna ? i : 0)) {
+                    int vx = origem->velX[i];
+                    int vy = origem->velY[i];
+                    vx = (vx == 0) ? 0 : (vx > 0 ? 1 : -1);
+                    vy = (vy == 0) ? 0 : (vy > 0 ? 1 : -1);
+
+                    // A nova velocidade fica apenas no novo frame
+                    passo->deslX[i] = destino->velX[i] = vx;
+                    passo->deslY[i] = destino->velY[i] = vy;
+                }
+                break;
+            default: // ProfPaiMau e restantes - Movimento padrão
+                break;
+        }
+    }
+
+    CONTAR(CONTADOR_VIZINHOS, consultas);
+}
+
+/**
+ * @brief Fase 2 do cálculo de um frame, para os barcos [inicio, fim).
+ *
+ * Move os barcos com o kernel de movimento e compacta os que continuam no radar no início
+ * da própria parte, nos arrays do novo frame. Guarda quantos sobreviveram nesta parte.
+ */
+static void moverParte(void *contexto, int parte, int inicio, int fim) {
+    PassoFrame *passo = contexto;
+    EntidadesIED *origem = &passo->anterior->barcos;
+    EntidadesIED *destino = &passo->novo->barcos;
+    int *sobreviventes = passo->sobreviventes + inicio;
+    int numSobreviventes;
+
+    numSobreviventes = moverECompactar(origem->posX + inicio, origem->posY + inicio,
+                                       passo->deslX + inicio, passo->deslY + inicio, fim - inicio,
+                                       passo->latitudeMax, passo->longitudeMax,
+                                       destino->posX + inicio, destino->posY + inicio, sobreviventes);
+
+    // Compacta os restantes dados (cada sobrevivente k veio de um índice >= k)
+    for (int k = 0; k < numSobreviventes; k++) {
+        int i = inicio + sobreviventes[k];
+        destino->velX[inicio + k] = destino->velX[i];
+        destino->velY[inicio + k] = destino->velY[i];
+        destino->navio[inicio + k] = destino->navio[i];
+        destino->flags[inicio + k] = destino->flags[i];
+        sobreviventes[k] = i;
+    }
+
+    passo->inicioParte[parte] = inicio;
+    passo->sobreviventesParte[parte] = numSobreviventes;
+}
+
+/**
+ * @brief Calcula o conteúdo de um frame a partir do frame anterior.
+ *
+ * O cálculo é feito em três fases:
+ * 1. Para cada barco do frame anterior determina, com base na sua tipologia, o deslocamento
+ *    deste passo, a velocidade e as flags com que fica no novo frame.
+ * 2. O kernel de movimento (moverECompactar) soma os deslocamentos às posições e compacta
+ *    os barcos que continuam no radar.
+ * 3. Os sobreviventes são juntados pela ordem original e os barcos em colisão removidos.
+ *
+ * Em frames grandes as fases 1 e 2 são divididas pelas threads de executarEmParalelo. O
+ * frame anterior só é lido (tem dois buffers: o anterior e o novo), pelo que o resultado
+ * é igual ao do cálculo numa só thread.
+ *
+ * Os submarinos alternam a visibilidade nos frames múltiplos de 5. Tal como quando a
+ * visibilidade era partilhada por todos os frames, as verificações de proximidade de
+ * um barco já veem alternados os submarinos que estão antes dele no frame.
+ *
+ * @param anterior Frame de origem (já completo).
+ * @param novo Frame de destino, vazio, com o número do frame seguinte.
+ * @param latitudeMax Número máximo de linhas (altura da grelha).
+ * @param longitudeMax Número máximo de colunas (largura da grelha).
+ * @param showOutput Se for diferente de zero, imprime os barcos que saem do radar e as colisões.
+ * @return Lista de colisões detetadas no novo frame.
+ */
+Colisao *calcularFrameSeguinte(BaseDados *anterior, BaseDados *novo, int latitudeMax, int longitudeMax,
+                               int showOutput) {
+    EntidadesIED *origem = &anterior->barcos;  // Barcos do frame anterior
+    EntidadesIED *destino = &novo->barcos;     // Barcos do novo frame
+    NoVessel *navios = anterior->registo->navios;
+    int total = origem->total;
+    int threads = numeroThreads();
+    PassoFrame passo;
+    int partes;
+    int numSobreviventes = 0;
+    Arena *temp = arenaTemporaria();
+    MarcaArena marca;
+    Colisao *colisoes;
+
+    reservarEntidades(novo, total);
+    destino->total = 0;
+    if (total == 0)
+        return NULL;
+
+    CONTAR(CONTADOR_FRAMES, 1);
+    CONTAR(CONTADOR_BARCOS, total);
+
+    passo.anterior = anterior;
+    passo.novo = novo;
+    passo.latitudeMax = latitudeMax;
+    passo.longitudeMax = longitudeMax;
+    passo.alterna = (novo->frame_atual_num % 5) == 0;
+
+    // Arrays auxiliares (deslocamentos, sobreviventes e resultado de cada parte) e grelha
+    // vivem na arena temporária até ao fim do passo
+    marca = marcarArena(temp);
+    passo.deslX = alocarArena(temp, ((size_t) total * 3 + (size_t) threads * 2) * sizeof(int));
+    passo.deslY = passo.deslX + total;
+    passo.sobreviventes = passo.deslY + total;
+    passo.inicioParte = passo.sobreviventes + total;
+    passo.sobreviventesParte = passo.inicioParte + threads;
+
+    // A grelha do frame anterior serve todas as verificações de proximidade deste passo
+    INICIAR_FASE(FASE_GRELHA);
+    construirGrelha(anterior, latitudeMax, longitudeMax);
+    TERMINAR_FASE(FASE_GRELHA);
+
+    // Fase 1: comportamento específico por tipo de barco
+    INICIAR_FASE(FASE_COMPORTAMENTO);
+    executarEmParalelo(calcularComportamentos, &passo, total, LIMIAR_PARALELO);
+    TERMINAR_FASE(FASE_COMPORTAMENTO);
+
+    libertarGrelha(anterior);
+
+    // Fase 2: move todos os barcos e compacta os que continuam no radar, por partes
+    INICIAR_FASE(FASE_MOVIMENTO);
+    kernelMovimentoAtivo();  // Escolhe o kernel antes de as threads o usarem
+    partes = executarEmParalelo(moverParte, &passo, total, LIMIAR_PARALELO);
+    TERMINAR_FASE(FASE_MOVIMENTO);
+
+    // Fase 3: junta os sobreviventes de cada parte, pela ordem original
+    INICIAR_FASE(FASE_JUNCAO);
+    for (int p = 0; p < partes; p++) {
+        int inicio = passo.inicioParte[p];
+        size_t n = (size_t) passo.sobreviventesParte[p];
+
+        if (inicio != numSobreviventes) {
+            memmove(destino->posX + numSobreviventes, destino->posX + inicio, n * sizeof(int));
+            memmove(destino->posY + numSobreviventes, destino->posY + inicio, n * sizeof(int));
+            memmove(destino->velX + numSobreviventes, destino->velX + inicio, n * sizeof(int));
+            memmove(destino->velY + numSobreviventes, destino->velY + inicio, n * sizeof(int));
+            memmove(destino->navio + numSobreviventes, destino->navio + inicio, n * sizeof(int));
+            memmove(destino->flags + numSobreviventes, destino->flags + inicio, n);
+            memmove(passo.sobreviventes + numSobreviventes, passo.sobreviventes + inicio, n * sizeof(int));
+        }
+        numSobreviventes += (int) n;
+    }
+    destino->total = numSobreviventes;
+
+    // Barcos que saíram fora do radar (os que não estão na lista de sobreviventes)
+    if (showOutput) {
+        for (int k = 0, i = 0; i < total; i++) {
+            if (k < numSobreviventes && passo.sobreviventes[k] == i)
+                k++;
+            else
+                printf("\033[1;31mBarco %s saiu do radar\033[0m\n",
+                       indicativoNavio(anterior->registo, navios[origem->navio[i]].id));
+        }
+    }
+
+    TERMINAR_FASE(FASE_JUNCAO);
+
+    restaurarArena(temp, marca);
+
+    // Remove barcos que colidiram neste frame e devolve a lista de colisões
+    INICIAR_FASE(FASE_COLISOES);
+    colisoes = removerBarcosEmColisao(novo, showOutput);
+    TERMINAR_FASE(FASE_COLISOES);
+    return colisoes;
+}
+
+/**
+ * @brief Converte uma coordenada no índice da célula da grelha que a contém.
+ *
+ * Coordenadas fora do radar são encostadas à primeira ou última célula, o que mantém
+ * a ordem entre coordenadas e garante que as pesquisas por intervalo não perdem barcos.
+ */
+static int celulaDaCoordenada(int coordenada, int tamanhoCelula, int numCelulas) {
+    int celula;
+
+    if (coordenada < 0)
+        return 0;
+
+    celula = coordenada / tamanhoCelula;
+    return celula < numCelulas ? celula : numCelulas - 1;
+}
+
+/**
+ * @brief Constrói a grelha espacial das entidades de um frame.
+ *
+ * Divide a área do radar (latitudeMax x longitudeMax) em células de TAMANHO_CELULA casas
+ * e agrupa os índices das entidades por célula, numa única passagem de contagem seguida
+ * de outra de distribuição. Se o radar for muito maior do que o número de barcos, as
+ * células são alargadas para que a grelha não tenha mais células do que ~4 por barco.
+ * A grelha é alocada na arena temporária e fica em frame->grelha até libertarGrelha;
+ * a memória só é recuperada quando quem a construiu restaura a arena temporária.
+ *
+ * @param frame Frame cujas entidades são indexadas.
+ * @param latitudeMax Número máximo de linhas (altura da grelha).
+ * @param longitudeMax Número máximo de colunas (largura da grelha).
+ */
+void construirGrelha(BaseDados *frame, int latitudeMax, int longitudeMax) {
+    EntidadesIED *barcos = &frame->barcos;
+    GrelhaEspacial *grelha;
+    long limiteCelulas = 4L * barcos->total + 16;
+    long largura = longitudeMax > 0 ? longitudeMax : 1;
+    long altura = latitudeMax > 0 ? latitudeMax : 1;
+    int tamanho = TAMANHO_CELULA;
+    int numCelulas;
+
+    libertarGrelha(frame);
+
+    // Alarga as células até a grelha ter um tamanho proporcional ao número de barcos
+    while (((largura + tamanho - 1) / tamanho) * ((altura + tamanho - 1) / tamanho) > limiteCelulas)
+        tamanho *= 2;
+
+    grelha = alocarArena(arenaTemporaria(), sizeof(GrelhaEspacial));
+
+    grelha->tamanhoCelula = tamanho;
+    grelha->colunas = (int) ((largura + tamanho - 1) / tamanho);
+    grelha->linhas = (int) ((altura + tamanho - 1) / tamanho);
+    numCelulas = grelha->colunas * grelha->linhas;
+
+    grelha->inicioCelula = alocarArena(arenaTemporaria(), ((size_t) numCelulas + 1) * sizeof(int));
+    grelha->indices = alocarArena(arenaTemporaria(), (size_t) (barcos->total > 0 ? barcos->total : 1) * sizeof(int));
+    memset(grelha->inicioCelula, 0, ((size_t) numCelulas + 1) * sizeof(int));
+
+    // Conta os barcos de cada célula
+    for (int i = 0; i < barcos->total; i++) {
+        int cx = celulaDaCoordenada(barcos->posX[i], tamanho, grelha->colunas);
+        int cy = celulaDaCoordenada(barcos->posY[i], tamanho, grelha->linhas);
+        grelha->inicioCelula[cy * grelha->colunas + cx + 1]++;
+    }
+
+    // Soma acumulada: início de cada célula
+    for (int c = 0; c < numCelulas; c++)
+        grelha->inicioCelula[c + 1] += grelha->inicioCelula[c];
+
+    // Distribui os índices, usando inicioCelula como cursor de escrita
+    for (int i = 0; i < barcos->total; i++) {
+        int cx = celulaDaCoordenada(barcos->posX[i], tamanho, grelha->colunas);
+        int cy = celulaDaCoordenada(barcos->posY[i], tamanho, grelha->linhas);
+        grelha->indices[grelha->inicioCelula[cy * grelha->colunas + cx]++] = i;
+    }
+
+    // Repõe os inícios (cada cursor parou no início da célula seguinte)
+    for (int c = numCelulas; c > 0; c--)
+        grelha->inicioCelula[c] = grelha->inicioCelula[c - 1];
+    grelha->inicioCelula[0] = 0;
+
+    frame->grelha = grelha;
+}
+
+/**
+ * @brief Desliga a grelha espacial de um frame.
+ *
+ * A memória da grelha pertence à arena temporária, por isso só é recuperada quando esta
+ * for restaurada.
+ *
+ * @param frame Frame cuja grelha é libertada.
+ */
+void libertarGrelha(BaseDados *frame) {
+    frame->grelha = NULL;
+}
+
+/**
+ * @brief Verifica se o barco j conta como vizinho visível para a entidade 'indice'.
+ *
+ * Aplica as regras de temBarcosADistancia a um único candidato: exclui o próprio barco,
+ * os que estão fora da area e os submarinos invisíveis.
+ */
+static int eVizinhoVisivel(BaseDados *frame, int indice, int j, int x, int y, int n, int alternados) {
+    EntidadesIED *barcos = &frame->barcos;
+    int dx = barcos->posX[j] - x;
+    int dy = barcos->posY[j] - y;
+
+    // Ignora o próprio barco e os que estão fora da area definida
+    if (j == indice || dx < -n || dx > n || dy < -n || dy > n)
+        return 0;
+
+    // Se for submarino invisível é ignorado
+    if (frame->registo->navios[barcos->navio[j]].tipologia == 3) {
+        int visivel = (barcos->flags[j] & BARCO_VISIVEL) != 0;
+        if (j < alternados)
+            visivel = !visivel;
+        return visivel;
+    }
+
+    return 1;
+}
+
 /**
  * @brief Verifica se existem barcos próximos de um barco dado num frame.
  *
- * Percorre a lista de embarcações no frame e verifica se existe algum barco
- * a uma distância máxima de 'n' unidades (em ambos os eixos) do barco fornecido.
- * Submarinos invisíveis são ignorados durante esta verificação.
+ * Verifica se existe algum barco a uma distância máxima de 'n' unidades (em ambos os eixos)
+ * do barco fornecido. Submarinos invisíveis são ignorados durante esta verificação.
+ * Se o frame tiver uma grelha espacial construída, só são visitadas as células que
+ * intersetam a area; caso contrário são percorridos todos os barcos do frame.
+ *
+ * Durante o cálculo de um frame, os submarinos com índice inferior a 'alternados' já
+ * alternaram a visibilidade, pelo que a sua flag BARCO_VISIVEL é lida invertida.
  *
  * @param frame Ponteiro para o frame onde se encontram os barcos.
- * @param barco Ponteiro para a entidade a partir da qual se calcula a distância.
+ * @param indice Índice da entidade a partir da qual se calcula a distância.
  * @param n Distância máxima (em células) a considerar para proximidade.
+ * @param alternados Número de entidades iniciais cuja visibilidade já alternou (0 se nenhuma).
  * @return 1 se houver outro barco visível dentro da distância 'n'; 0 caso contrário.
  */
-int temBarcosADistancia(BaseDados *frame, EntidadeIED *barco, int n) {
+int temBarcosADistancia(BaseDados *frame, int indice, int n, int alternados) {
+    GrelhaEspacial *grelha;
     int x;
     int y;
-    EntidadeIED *atual;
+    int cx0, cx1, cy0, cy1;
 
     // Verificação dos argumentos
-    if (frame == NULL || barco == NULL || n < 1)
+    if (frame == NULL || indice < 0 || indice >= frame->barcos.total || n < 1)
         return 0;
 
     // Coordenadas do barco de referência
-    x = barco->posicao[0];
-    y = barco->posicao[1];
-
-    atual = frame->barcos;
-
-    // Percorre todos os barcos do frame
-    while (atual != NULL) {
-        // Ignora o próprio barco
-        if (atual != barco) {
-            int dx = atual->posicao[0] - x;
-            int dy = atual->posicao[1] - y;
-
-            // Verifica se está dentro da area definida
-            if (dx >= -n && dx <= n && dy >= -n && dy <= n) {
-                int tipo = atual->no_nautico->tipologia;
-
-                // Se for submarino invisível é ignorado
-                if (tipo == 3) {
-                    if (!atual->no_nautico->isVisible) {
-                        atual = atual->seguinte;
-                        continue;
-                    }
-                }
+    x = frame->barcos.posX[indice];
+    y = frame->barcos.posY[indice];
+
+    grelha = frame->grelha;
 
-                // Barco encontrado dentro da distância
+    // Sem grelha: percorre todos os barcos do frame
+    if (grelha == NULL) {
+        for (int j = 0; j < frame->barcos.total; j++) {
+            if (eVizinhoVisivel(frame, indice, j, x, y, n, alternados))
                 return 1;
+        }
+        return 0;
+    }
+
+    // Com grelha: percorre só as células que intersetam a area [x-n, x+n] x [y-n, y+n]
+    cx0 = celulaDaCoordenada(x - n, grelha->tamanhoCelula, grelha->colunas);
+    cx1 = celulaDaCoordenada(x + n, grelha->tamanhoCelula, grelha->colunas);
+    cy0 = celulaDaCoordenada(y - n, grelha->tamanhoCelula, grelha->linhas);
+    cy1 = celulaDaCoordenada(y + n, grelha->tamanhoCelula, grelha->linhas);
+
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            int c = cy * grelha->colunas + cx;
+            for (int k = grelha->inicioCelula[c]; k < grelha->inicioCelula[c + 1]; k++) {
+                if (eVizinhoVisivel(frame, indice, grelha->indices[k], x, y, n, alternados))
+                    return 1;
             }
         }
-        // Próximo
-        atual = atual->seguinte;
     }
 
     // Nenhum barco encontrado na area escolhida
@@ -223,232 +589,259 @@ int temBarcosADistancia(BaseDados *frame, EntidadeIED *barco, int n) {
  * - Todos os barcos estejam parados.
  *
  * Em cada frame simulado, são analisadas colisões entre embarcações. Estas são apresentadas
- * ao utilizador com os barcos envolvidos e a posição da colisão. Após a previsão, todos os
- * frames futuros são eliminados e a simulação é revertida ao frame inicial.
+ * ao utilizador, à medida que são encontradas, com os barcos envolvidos e a posição da colisão.
  *
- * @param frameAtual Ponteiro para o ponteiro do frame atual da simulação.
- * @param listaFrames Estrutura que contém referências ao início e fim da lista de frames.
+ * Os frames simulados não entram no histórico: são calculados alternadamente em dois frames
+ * temporários, reaproveitados a cada passo, pelo que a memória usada não depende do número
+ * de frames previstos. O frame atual não é alterado.
+ *
+ * Só se avança frame a frame enquanto existirem Cruzadores, Submarinos ou Rebocadores. A partir
+ * do momento em que todos os barcos têm movimento linear, as colisões restantes são calculadas
+ * diretamente por preverColisoesLineares, sem gerar frames.
+ *
+ * No modo em lote (SAIDA_LOTE) não são impressos o cabeçalho nem a mensagem final, apenas uma
+ * linha por colisão.
+ *
+ * @param frameAtual Frame atual da simulação, de onde parte a previsão.
  * @param latitudeMax Número máximo de linhas da grelha.
  * @param longitudeMax Número máximo de colunas da grelha.
+ * @param formato Formato em que as colisões são impressas.
+ * @return Número de colisões previstas.
  */
-void previsaoDeColisoes(BaseDados **frameAtual, ListaFrames *listaFrames, int latitudeMax, int longitudeMax) {
-    // Guardar o frame inicial para voltar atrás no final
-    BaseDados *frameInicial = *frameAtual;
+int previsaoDeColisoes(BaseDados *frameAtual, int latitudeMax, int longitudeMax, FormatoSaida formato) {
+    BaseDados *temporarios[2] = {NULL, NULL};  // Frames onde os passos são calculados, à vez
+    BaseDados *atual = frameAtual;             // Último frame previsto
+    int proximo = 0;                           // Frame temporário onde é calculado o passo seguinte
     int frameCount = 0;
-    BaseDados *tempFrame;
+    int numColisoes = 0;
+    Arena *temporaria = arenaTemporaria();
+    MarcaArena marca = marcarArena(temporaria);
+    unsigned int *ids = alocarArena(temporaria, ((size_t) frameAtual->barcos.total + 1) * sizeof(unsigned int));
 
-    printf("\n=== Previsão de Colisões ===\n");
+    if (formato == SAIDA_TEXTO)
+        printf("\n=== Previsão de Colisões ===\n");
 
     while (1) {
-        EntidadeIED *temp = (*frameAtual)->barcos;
+        EntidadesIED *barcos = &atual->barcos;
+        NoVessel *navios = atual->registo->navios;
         int barcosVisiveis = 0;
         int algumComVelocidade = 0;
         Colisao *colisoes;
 
         // Verifica se há barcos visíveis e se algum se está a mover
-        while (temp != NULL) {
-            int tipo = temp->no_nautico->tipologia;
-            int visivel = temp->no_nautico->isVisible;
+        for (int i = 0; i < barcos->total; i++) {
+            int tipo = navios[barcos->navio[i]].tipologia;
+            int visivel = (barcos->flags[i] & BARCO_VISIVEL) != 0;
 
             // Só considera visíveis os não-submarinos ou submarinos visíveis
             if (tipo != 3 || visivel) {
                 barcosVisiveis++;
-                if (temp->velocidade[0] != 0 || temp->velocidade[1] != 0)
+                if (barcos->velX[i] != 0 || barcos->velY[i] != 0)
                     algumComVelocidade = 1;
             }
-
-            temp = temp->seguinte;
         }
 
         // Se não há barcos ou todos estão parados, parar a previsão
         if (barcosVisiveis == 0 || !algumComVelocidade)
             break;
 
-        // Avança 1 frame sem mostrar output
-        colisoes = avancarFrame(frameAtual, listaFrames, 1, latitudeMax, longitudeMax, 0);
+        // Sem barcos que mudam de velocidade ou visibilidade, o resto da previsão é calculado diretamente
+        if (!temMovimentoNaoLinear(atual)) {
+            frameCount += preverColisoesLineares(atual, latitudeMax, longitudeMax, formato, &numColisoes);
+            break;
+        }
 
-        // Imprimir colisões detetadas
+        // Avança 1 frame sem mostrar output, reaproveitando o frame temporário que já não é preciso
+        if (temporarios[proximo] == NULL)
+            temporarios[proximo] = criarFrame(atual, barcos->total);
+        else
+            temporarios[proximo] = reciclarFrame(temporarios[proximo], atual, barcos->total);
+        colisoes = calcularFrameSeguinte(atual, temporarios[proximo], latitudeMax, longitudeMax, 0);
+        atual = temporarios[proximo];
+        proximo = 1 - proximo;
+
+        // Imprimir colisões detetadas (os registos pertencem ao frame e são libertados com ele)
         while (colisoes != NULL) {
             BarcosEmColisao *b = colisoes->barcos;
-            Colisao *colisaoTmp = colisoes;
-            BarcosEmColisao *btmp = colisaoTmp->barcos;
+            int numBarcos = 0;
 
-            printf("Frame %d\n    Colisão prevista entre barcos: ", (*frameAtual)->frame_atual_num);
             while (b != NULL) {
-                printf("%c", b->id);
-                if (b->seguinte != NULL) printf(", ");
+                ids[numBarcos++] = b->id;
                 b = b->seguinte;
             }
-            printf("\n    Posicao prevista da colisao: (%d,%d) \n", colisoes->x, colisoes->y);
+            imprimirColisaoPrevista(atual->registo, atual->frame_atual_num, colisoes->x, colisoes->y, ids, numBarcos,
+                                    formato);
+            numColisoes++;
 
-            // Libertar memória desta colisão
             colisoes = colisoes->seguinte;
-            while (btmp != NULL) {
-                BarcosEmColisao *aux = btmp;
-                btmp = btmp->seguinte;
-                free(aux);
-            }
-            free(colisaoTmp);
         }
 
         frameCount++;
     }
 
-    // Recuar ao frame onde começou a previsão
-    while (*frameAtual != frameInicial)
-        *frameAtual = (*frameAtual)->prev;
-
-    // Libertar todos os frames criados após o frame inicial
-    tempFrame = (*frameAtual)->next;
-    while (tempFrame != NULL) {
-        BaseDados *aRemover = tempFrame;
-        EntidadeIED *barco = aRemover->barcos;
-        tempFrame = tempFrame->next;
-
-        // Libertar lista de barcos
-        while (barco != NULL) {
-            EntidadeIED *tmp = barco;
-            barco = barco->seguinte;
-            free(tmp);
-        }
-
-        free(aRemover);
-        listaFrames->total_frames--;
+    // Libertar os frames temporários
+    for (int i = 0; i < 2; i++) {
+        if (temporarios[i] != NULL)
+            libertarFrame(temporarios[i]);
     }
 
-    // Atualizar apontadores da lista
-    (*frameAtual)->next = NULL;
-    listaFrames->tail = *frameAtual;
+    restaurarArena(temporaria, marca);
 
     // Caso nenhuma colisão tenha ocorrido
-    if (frameCount == 0)
+    if (frameCount == 0 && formato == SAIDA_TEXTO)
         printf("Nenhuma colisão prevista.\n");
+    return numColisoes;
+}
+
+/**
+ * @brief Indica se um barco pode colidir (exclui o tipo 1 e os submarinos invisíveis).
+ */
+static int podeColidir(int tipo, unsigned char flags) {
+    return tipo != 1 && !(tipo == 3 && !(flags & BARCO_VISIVEL));
 }
 
 /**
  * @brief Deteta e remove barcos que colidiram no mesmo frame.
  *
- * Percorre a lista de barcos num frame e identifica posições partilhadas por mais de um barco
- * (excluindo certos tipos como tipo 1 e submarinos invisíveis). Para cada colisão:
- * - Cria um registo de colisão com os IDs dos barcos envolvidos.
- * - Remove os barcos da lista original.
- * - Devolve uma lista ligada com os dados das colisões.
+ * Agrupa os barcos do frame por posição numa tabela de dispersão (endereçamento aberto),
+ * numa única passagem. Cada posição com mais de um barco elegível (excluindo o tipo 1 e os
+ * submarinos invisíveis) dá origem a uma colisão:
+ * - Cria um registo de colisão com os IDs dos barcos envolvidos, por ordem no frame.
+ * - Remove todos os barcos colididos numa única compactação dos arrays, mantendo a ordem
+ *   dos restantes.
+ * - Devolve uma lista ligada com os dados das colisões, ordenadas pelo primeiro barco
+ *   (de qualquer tipo) presente em cada posição.
  *
- * @param lista Ponteiro para a lista ligada de entidades (barcos) no frame.
+ * A tabela auxiliar vive na arena temporária; os registos de colisão são alocados na
+ * arena do frame e libertados com ele.
+ *
+ * @param frame Ponteiro para o frame cujos barcos são verificados.
  * @param showOutput Se diferente de zero, imprime as colisões encontradas.
  * @return Lista ligada com as colisões detetadas (ou NULL se não houver colisões).
  */
-Colisao *removerBarcosEmColisao(EntidadeIED **lista, int showOutput) {
-    EntidadeIED *a = *lista;
+Colisao *removerBarcosEmColisao(BaseDados *frame, int showOutput) {
+    EntidadesIED *barcos = &frame->barcos;
+    NoVessel *navios = frame->registo->navios;
     Colisao *colisoes = NULL;
     Colisao *ultimaColisao = NULL;
+    CelulaOcupada *tabela;
+    int *celulaDoBarco;     // Entrada da tabela de cada barco
+    int *proximo;           // Próximo barco elegível na mesma célula
+    unsigned int mascara;
+    int tamanhoTabela = 1;
+    int restantes = 0;
+    Arena *temp = arenaTemporaria();
+    MarcaArena marca;
+
+    // Com menos de dois barcos não pode haver colisões
+    if (barcos->total < 2)
+        return NULL;
+
+    // Tabela com pelo menos o dobro das entradas necessárias (potência de 2)
+    while (tamanhoTabela < barcos->total * 2)
+        tamanhoTabela *= 2;
+    mascara = (unsigned int) tamanhoTabela - 1;
+
+    marca = marcarArena(temp);
+    tabela = alocarArena(temp, (size_t) tamanhoTabela * sizeof(CelulaOcupada));
+    celulaDoBarco = alocarArena(temp, (size_t) barcos->total * sizeof(int));
+    proximo = alocarArena(temp, (size_t) barcos->total * sizeof(int));
+    for (int c = 0; c < tamanhoTabela; c++)
+        tabela[c].primeiro = -1;
+
+    // Agrupa os barcos por posição
+    for (int i = 0; i < barcos->total; i++) {
+        int x = barcos->posX[i];
+        int y = barcos->posY[i];
+        unsigned int h = ((unsigned int) x * 73856093u) ^ ((unsigned int) y * 19349663u);
+        CelulaOcupada *celula;
+
+        // Procura linear a partir da posição de dispersão
+        h = (h ^ (h >> 16)) & mascara;
+        while (tabela[h].primeiro != -1 && (tabela[h].x != x || tabela[h].y != y))
+            h = (h + 1) & mascara;
+
+        celula = &tabela[h];
+        if (celula->primeiro == -1) {
+            celula->x = x;
+            celula->y = y;
+            celula->primeiro = i;
+            celula->elegiveis = 0;
+            celula->cabeca = -1;
+            celula->cauda = -1;
+        }
+        celulaDoBarco[i] = (int) h;
 
-    // Percorre todos os barcos da lista
-    while (a != NULL) {
-        int x = a->posicao[0];
-        int y = a->posicao[1];
+        // Encadeia os barcos que podem colidir
+        if (podeColidir(navios[barcos->navio[i]].tipologia, barcos->flags[i])) {
+            proximo[i] = -1;
+            if (celula->cabeca == -1)
+                celula->cabeca = i;
+            else
+                proximo[celula->cauda] = i;
+            celula->cauda = i;
+            celula->elegiveis++;
+        }
+    }
 
-        // Contadores e lista temporária para barcos em colisão
-        int count = 0;
-        EntidadeIED *aux = *lista;
-        BarcosEmColisao *listaBarcos = NULL;
+    // Cria uma colisão por cada posição com mais de um barco elegível
+    for (int i = 0; i < barcos->total; i++) {
+        CelulaOcupada *celula = &tabela[celulaDoBarco[i]];
         BarcosEmColisao *ultimoBarco = NULL;
+        Colisao *nova;
+
+        // Cada posição é tratada uma só vez, quando se encontra o seu primeiro barco
+        if (celula->primeiro != i || celula->elegiveis < 2)
+            continue;
+
+        CONTAR(CONTADOR_COLISOES, 1);
+        nova = alocarNoFrame(frame, sizeof(Colisao), MEMORIA_COLISOES);
+        nova->x = celula->x;
+        nova->y = celula->y;
+        nova->barcos = NULL;
+        nova->seguinte = NULL;
+
+        for (int b = celula->cabeca; b != -1; b = proximo[b]) {
+            BarcosEmColisao *barco = alocarNoFrame(frame, sizeof(BarcosEmColisao), MEMORIA_BARCOS_COLISAO);
+            barco->id = navios[barcos->navio[b]].id;
+            barco->seguinte = NULL;
+
+            if (nova->barcos == NULL)
+                nova->barcos = barco;
+            else
+                ultimoBarco->seguinte = barco;
+            ultimoBarco = barco;
 
-        // Percorre todos os barcos para encontrar outros na mesma posição
-        while (aux != NULL) {
-            int tipo = aux->no_nautico->tipologia;
-            int visivel = aux->no_nautico->isVisible;
-
-            // Só considera barcos não invisíveis e exclui tipo 1
-            if (aux->posicao[0] == x && aux->posicao[1] == y &&
-                tipo != 1 && !(tipo == 3 && visivel == 0)) {
-
-                // Criar novo nó para a lista de barcos colididos
-                BarcosEmColisao *b = malloc(sizeof(BarcosEmColisao));
-                if (!b) {
-                    perror("Erro ao alocar BarcosEmColisao");
-                    exit(1);
-                }
-                b->id = aux->no_nautico->nome;
-                b->seguinte = NULL;
-
-                if (listaBarcos == NULL)
-                    listaBarcos = b;
-                else
-                    ultimoBarco->seguinte = b;
-
-                ultimoBarco = b;
-                count++;
+            if (showOutput) {
+                printf("\033[1;31mBarco %s colidiu em (%d,%d)\033[0m\n",
+                       indicativoNavio(frame->registo, barco->id), celula->x, celula->y);
             }
-            aux = aux->seguinte;
         }
 
-        // Se mais de um barco está na mesma posição, há colisão
-        if (count > 1) {
-            EntidadeIED *curr;
-            EntidadeIED *prev;
-
-            // Criar estrutura Colisao e adicionar à lista
-            Colisao *nova = malloc(sizeof(Colisao));
-            if (!nova) {
-                perror("Erro ao alocar Colisao");
-                exit(1);
-            }
-
-            nova->x = x;
-            nova->y = y;
-            nova->barcos = listaBarcos;
-            nova->seguinte = NULL;
-
-            if (colisoes == NULL)
-                colisoes = nova;
-            else
-                ultimaColisao->seguinte = nova;
-
-            ultimaColisao = nova;
-
-            // Remover barcos colididos da lista original
-            curr = *lista;
-            prev = NULL;
-            while (curr != NULL) {
-                EntidadeIED *seguinte = curr->seguinte;
-                int tipo = curr->no_nautico->tipologia;
-                int visivel = curr->no_nautico->isVisible;
-
-                if (curr->posicao[0] == x && curr->posicao[1] == y &&
-                    tipo != 1 && !(tipo == 3 && visivel == 0)) {
-
-                    if (showOutput) {
-                        printf("\033[1;31mBarco %c colidiu em (%d,%d)\033[0m\n",
-                               curr->no_nautico->nome, x, y);
-                    }
-
-                    // Remoção do nó da lista ligada
-                    if (prev == NULL)
-                        *lista = seguinte;
-                    else
-                        prev->seguinte = seguinte;
-
-                    free(curr);
-                } else {
-                    prev = curr;
-                }
-
-                curr = seguinte;
-            }
+        if (colisoes == NULL)
+            colisoes = nova;
+        else
+            ultimaColisao->seguinte = nova;
+        ultimaColisao = nova;
+    }
 
-            // Reinicia o scan desde o início (a lista foi modificada)
-            a = *lista;
-        } else {
-            // Nenhuma colisão: libertar listaBarcos temporária
-            while (listaBarcos != NULL) {
-                BarcosEmColisao *tmp = listaBarcos;
-                listaBarcos = listaBarcos->seguinte;
-                free(tmp);
-            }
-            a = a->seguinte;
-        }
+    // Remove os barcos colididos numa única compactação dos arrays
+    for (int i = 0; i < barcos->total; i++) {
+        if (tabela[celulaDoBarco[i]].elegiveis > 1 &&
+            podeColidir(navios[barcos->navio[i]].tipologia, barcos->flags[i]))
+            continue;
+
+        barcos->posX[restantes] = barcos->posX[i];
+        barcos->posY[restantes] = barcos->posY[i];
+        barcos->velX[restantes] = barcos->velX[i];
+        barcos->velY[restantes] = barcos->velY[i];
+        barcos->navio[restantes] = barcos->navio[i];
+        barcos->flags[restantes] = barcos->flags[i];
+        restantes++;
     }
+    barcos->total = restantes;
+
+    restaurarArena(temp, marca);
 
     return colisoes;
 }
@@ -458,32 +851,42 @@ Colisao *removerBarcosEmColisao(EntidadeIED **lista, int showOutput) {
  *
  * Esta função recua o ponteiro do frame atual um número especificado de passos (frames anteriores),
  * desde que existam frames anteriores disponíveis. Após recuar, todos os frames futuros são eliminados
- * da memória e o estado do novo frame atual é guardado no ficheiro "depois.txt".
+ * da memória e o estado do novo frame atual é guardado no ficheiro de saída. O frame é obtido
+ * com recuarHistorico, que o reconstrói se o histórico estiver codificado. O recuo fica no
+ * registo contínuo, se ativo (ver registarRecuoSaida).
  *
  * @param frameAtual Ponteiro para o ponteiro do frame atual da simulação.
  * @param listaFrames Ponteiro para a estrutura que contém os limites da lista de frames.
  * @param steps Número de frames a recuar.
  * @param showOutput Flag que indica se deve ser impresso feedback ao utilizador.
  */
-void rewindFrames(BaseDados **frameAtual, ListaFrames *listaFrames, int steps) {
+void rewindFrames(BaseDados **frameAtual, ListaFrames *listaFrames, int steps, int showOutput) {
+    int alvo;
+    int primeiro;
+
     // Verifica se o ponteiro para o frame atual é válido
     if (frameAtual == NULL || *frameAtual == NULL) {
-        printf("Frame atual inválido.\n");
+        if (showOutput) printf("Frame atual inválido.\n");
         return;
     }
 
-    // Tenta recuar 'steps' vezes para frames anteriores
-    for (int i = 0; i < steps; i++) {
-        // Se não houver frame anterior, interrompe
-        if ((*frameAtual)->prev == NULL) {
-            printf("Não existem frames anteriores ao Frame 0.\n");
-            break;
-        }
+    // Não é possível recuar para antes do frame 0
+    alvo = (*frameAtual)->frame_atual_num - (steps > 0 ? steps : 0);
+    if (alvo < 0) {
+        if (showOutput) printf("Não existem frames anteriores ao Frame 0.\n");
+        alvo = 0;
+    }
 
-        // Atualiza o frame atual para o anterior
-        *frameAtual = (*frameAtual)->prev;
+    // Com o histórico em anel, os frames mais antigos (além do frame 0) já não existem
+    primeiro = primeiroFrameRecuperavel(listaFrames);
+    if (alvo > 0 && alvo < primeiro) {
+        if (showOutput)
+            printf("Histórico limitado: não existem frames anteriores ao Frame %d (além do Frame 0).\n", primeiro);
+        alvo = primeiro;
     }
 
-    // Remove da memória todos os frames que vinham depois do novo frame atual
-    apagarFramesFuturos(frameAtual, listaFrames);
+    // Volta ao frame pretendido e remove do histórico todos os que vinham depois dele
+    if (alvo != (*frameAtual)->frame_atual_num)
+        registarRecuoSaida(alvo);
+    *frameAtual = recuarHistorico(listaFrames, alvo);
 }
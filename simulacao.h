@@ -9,25 +9,40 @@
 Colisao *avancarFrame(BaseDados **frameAtual, ListaFrames *listaFrames,
                       int numFrames, int latitudeMax, int longitudeMax, int showOutput);
 
+/**
+ * @brief Calcula um novo frame a partir do anterior. Retorna as colisões desse frame.
+ */
+Colisao *calcularFrameSeguinte(BaseDados *anterior, BaseDados *novo,
+                               int latitudeMax, int longitudeMax, int showOutput);
+
 /**
  * @brief Reverte o estado da simulação para frames anteriores.
  */
-void rewindFrames(BaseDados **frameAtual, ListaFrames *listaFrames, int steps);
+void rewindFrames(BaseDados **frameAtual, ListaFrames *listaFrames, int steps, int showOutput);
 
 /**
  * @brief Deteta e remove barcos em colisão. Retorna lista de colisões.
  */
-Colisao *removerBarcosEmColisao(EntidadeIED **lista, int showOutput);
+Colisao *removerBarcosEmColisao(BaseDados *frame, int showOutput);
 
 /**
- * @brief Corre previsão automática de colisões até ao fim da simulação.
+ * @brief Corre previsão automática de colisões até ao fim da simulação. Retorna o número de colisões previstas.
  */
-void previsaoDeColisoes(BaseDados **frameAtual, ListaFrames *listaFrames,
-                        int latitudeMax, int longitudeMax);
+int previsaoDeColisoes(BaseDados *frameAtual, int latitudeMax, int longitudeMax, FormatoSaida formato);
 
 /**
  * @brief Verifica se há barcos a uma determinada distância.
  */
-int temBarcosADistancia(BaseDados *frame, EntidadeIED *barco, int n);
+int temBarcosADistancia(BaseDados *frame, int indice, int n, int alternados);
+
+/**
+ * @brief Constrói a grelha espacial das entidades de um frame.
+ */
+void construirGrelha(BaseDados *frame, int latitudeMax, int longitudeMax);
+
+/**
+ * @brief Liberta a grelha espacial de um frame.
+ */
+void libertarGrelha(BaseDados *frame);
 
 #endif
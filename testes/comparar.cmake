@@ -0,0 +1,57 @@
+# Compara duas execuções em lote do simulador: o ficheiro de saída e as linhas do stdout
+# (sem as linhas "avancar", que dependem de como o avanço foi dividido).
+#
+# Variáveis (-D):
+#   PROGRAMA        Executável do simulador
+#   CENARIO         Ficheiro inicial da primeira execução
+#   REFERENCIA      Ficheiro inicial da segunda execução (por omissão, CENARIO)
+#   DIMENSOES       Dimensões da grelha (ex: 40x40)
+#   LOTE            Script da primeira execução
+#   PASSO_A_PASSO   Se verdadeiro, a segunda execução troca cada "avancar N" por N vezes "avancar 1"
+#   SO_STDOUT       Se verdadeiro, os ficheiros de saída não são comparados (cenários diferentes)
+#   SAIDA           Diretório para os ficheiros temporários
+
+if (NOT DEFINED REFERENCIA)
+    set(REFERENCIA ${CENARIO})
+endif ()
+
+file(STRINGS ${LOTE} comandos)
+set(loteReferencia "")
+foreach (comando IN LISTS comandos)
+    if (PASSO_A_PASSO AND comando MATCHES "^avancar ([0-9]+)$")
+        foreach (i RANGE 1 ${CMAKE_MATCH_1})
+            string(APPEND loteReferencia "avancar 1\n")
+        endforeach ()
+    else ()
+        string(APPEND loteReferencia "${comando}\n")
+    endif ()
+endforeach ()
+file(MAKE_DIRECTORY ${SAIDA})
+file(WRITE ${SAIDA}/lote_referencia.txt "${loteReferencia}")
+
+execute_process(COMMAND ${PROGRAMA} ${CENARIO} ${DIMENSOES} 0 ${SAIDA}/depois.txt --lote=${LOTE}
+        OUTPUT_VARIABLE stdout RESULT_VARIABLE resultado)
+execute_process(COMMAND ${PROGRAMA} ${REFERENCIA} ${DIMENSOES} 0 ${SAIDA}/depois_referencia.txt
+                --lote=${SAIDA}/lote_referencia.txt
+        OUTPUT_VARIABLE stdoutReferencia RESULT_VARIABLE resultadoReferencia)
+if (NOT resultado EQUAL 0 OR NOT resultadoReferencia EQUAL 0)
+    message(FATAL_ERROR "Execução falhou (${resultado}, ${resultadoReferencia})")
+endif ()
+
+string(REGEX REPLACE "avancar [0-9]+\n" "" stdout "${stdout}")
+string(REGEX REPLACE "avancar [0-9]+\n" "" stdoutReferencia "${stdoutReferencia}")
+if (NOT stdout STREQUAL stdoutReferencia)
+    message(FATAL_ERROR "Previsões diferentes:\n${stdout}\n--- referência ---\n${stdoutReferencia}")
+endif ()
+if (stdout STREQUAL "")
+    message(FATAL_ERROR "Nenhuma linha para comparar")
+endif ()
+
+if (SO_STDOUT)
+    return()
+endif ()
+file(READ ${SAIDA}/depois.txt depois)
+file(READ ${SAIDA}/depois_referencia.txt depoisReferencia)
+if (NOT depois STREQUAL depoisReferencia)
+    message(FATAL_ERROR "Ficheiros de saída diferentes:\n${depois}\n--- referência ---\n${depoisReferencia}")
+endif ()
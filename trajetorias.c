@@ -0,0 +1,302 @@
+#include "modulo.h"
+
+// ================================================ TRAJETORIAS ========================================================
+
+/**
+ * @brief Garante que o índice cobre todos os ids do registo; os ids novos ficam sem segmentos.
+ *
+ * @param indice Índice de trajetórias.
+ * @param registo Registo de navios.
+ */
+static void cobrirIds(IndiceTrajetorias *indice, const RegistoNavios *registo) {
+    unsigned int antiga = indice->capacidadeIds;
+    unsigned int nova = antiga ? antiga : 16;
+    int *primeiro, *ultimo;
+
+    if (registo->totalIds <= antiga)
+        return;
+
+    while (nova < registo->totalIds)
+        nova *= 2;
+
+    primeiro = realloc(indice->primeiro, (size_t) nova * sizeof(int));
+    if (!primeiro) {
+        perror("Erro ao alocar trajetorias");
+        exit(1);
+    }
+    indice->primeiro = primeiro;
+
+    ultimo = realloc(indice->ultimo, (size_t) nova * sizeof(int));
+    if (!ultimo) {
+        perror("Erro ao alocar trajetorias");
+        exit(1);
+    }
+    indice->ultimo = ultimo;
+
+    registarMemoria(MEMORIA_TRAJETORIAS, 2 * (long long) (nova - antiga) * (long long) sizeof(int));
+    for (unsigned int id = antiga; id < nova; id++) {
+        indice->primeiro[id] = -1;
+        indice->ultimo[id] = -1;
+    }
+    indice->capacidadeIds = nova;
+}
+
+/**
+ * @brief Começa um segmento novo para um barco, num frame e posição.
+ *
+ * @param indice Índice de trajetórias.
+ * @param id Id do barco.
+ * @param frame Número do frame.
+ * @param x Posição x do barco nesse frame.
+ * @param y Posição y do barco nesse frame.
+ */
+static void novoSegmento(IndiceTrajetorias *indice, unsigned int id, int frame, int x, int y) {
+    SegmentoTrajetoria *segmento;
+    int s = indice->livre;
+
+    if (s != -1) {
+        indice->livre = indice->segmentos[s].anterior;
+    } else {
+        if (indice->numSegmentos == indice->capacidadeSegmentos) {
+            int nova = indice->capacidadeSegmentos ? indice->capacidadeSegmentos * 2 : 64;
+            SegmentoTrajetoria *novos = realloc(indice->segmentos, (size_t) nova * sizeof(SegmentoTrajetoria));
+
+            if (!novos) {
+                perror("Erro ao alocar trajetorias");
+                exit(1);
+            }
+            registarMemoria(MEMORIA_TRAJETORIAS, (long long) (nova - indice->capacidadeSegmentos) *
+                                                 (long long) sizeof(SegmentoTrajetoria));
+            indice->segmentos = novos;
+            indice->capacidadeSegmentos = nova;
+        }
+        s = indice->numSegmentos++;
+    }
+
+    segmento = &indice->segmentos[s];
+    segmento->inicio = frame;
+    segmento->fim = frame;
+    segmento->xInicio = segmento->xFim = x;
+    segmento->yInicio = segmento->yFim = y;
+    segmento->anterior = indice->ultimo[id];
+
+    if (indice->primeiro[id] == -1)
+        indice->primeiro[id] = s;
+    indice->ultimo[id] = s;
+}
+
+/**
+ * @brief Regista um frame acabado de acrescentar ao histórico (ou o frame inicial).
+ *
+ * Os barcos que estavam no último frame registado continuam o seu segmento; os outros começam
+ * um segmento novo. Os barcos que já não estão no frame ficam com o segmento terminado no
+ * último frame em que foram vistos (ver registarSaidaTrajetoria, para os frames que não passam
+ * pelo histórico). Se um id aparecer mais de uma vez no frame, conta a primeira entidade para o
+ * início do segmento e a última para o fim, como ao percorrer os frames.
+ *
+ * @param indice Índice de trajetórias.
+ * @param frame Frame a registar (com número maior que o do último registado, exceto o frame inicial).
+ */
+void registarFrameTrajetorias(IndiceTrajetorias *indice, BaseDados *frame) {
+    EntidadesIED *barcos = &frame->barcos;
+    NoVessel *navios = frame->registo->navios;
+    int f = frame->frame_atual_num;
+
+    cobrirIds(indice, frame->registo);
+
+    for (int i = 0; i < barcos->total; i++) {
+        unsigned int id = navios[barcos->navio[i]].id;
+        int s = indice->ultimo[id];
+        SegmentoTrajetoria *segmento = s != -1 ? &indice->segmentos[s] : NULL;
+
+        if (segmento != NULL && (segmento->fim == f || segmento->fim == indice->ultimoFrame)) {
+            segmento->fim = f;
+            segmento->xFim = barcos->posX[i];
+            segmento->yFim = barcos->posY[i];
+        } else {
+            novoSegmento(indice, id, f, barcos->posX[i], barcos->posY[i]);
+        }
+    }
+
+    indice->ultimoFrame = f;
+}
+
+/**
+ * @brief Regista o último frame em que um barco esteve no radar, durante um avanço direto.
+ *
+ * Os frames calculados por avancarDireto não passam pelo histórico, por isso os barcos que
+ * saem ou colidem pelo caminho são registados aqui, no momento em que desaparecem.
+ *
+ * @param indice Índice de trajetórias.
+ * @param id Id do barco.
+ * @param frame Último frame em que o barco está no radar.
+ * @param x Posição x do barco nesse frame.
+ * @param y Posição y do barco nesse frame.
+ */
+void registarSaidaTrajetoria(IndiceTrajetorias *indice, unsigned int id, int frame, int x, int y) {
+    SegmentoTrajetoria *segmento;
+
+    if (id >= indice->capacidadeIds || indice->ultimo[id] == -1)
+        return;
+
+    segmento = &indice->segmentos[indice->ultimo[id]];
+    segmento->fim = frame;
+    segmento->xFim = x;
+    segmento->yFim = y;
+}
+
+/**
+ * @brief Atualiza o índice depois de o utilizador colocar ou alterar um barco no frame atual.
+ *
+ * @param indice Índice de trajetórias.
+ * @param frame Frame atual (o último registado).
+ * @param entidade Índice da entidade colocada ou alterada.
+ */
+void atualizarTrajetoria(IndiceTrajetorias *indice, BaseDados *frame, int entidade) {
+    EntidadesIED *barcos = &frame->barcos;
+    unsigned int id = frame->registo->navios[barcos->navio[entidade]].id;
+    int f = frame->frame_atual_num;
+    SegmentoTrajetoria *segmento;
+
+    cobrirIds(indice, frame->registo);
+
+    // Barco novo neste frame
+    if (indice->ultimo[id] == -1 || indice->segmentos[indice->ultimo[id]].fim != f) {
+        novoSegmento(indice, id, f, barcos->posX[entidade], barcos->posY[entidade]);
+        return;
+    }
+
+    segmento = &indice->segmentos[indice->ultimo[id]];
+    segmento->xFim = barcos->posX[entidade];
+    segmento->yFim = barcos->posY[entidade];
+    if (segmento->inicio == f) {
+        segmento->xInicio = segmento->xFim;
+        segmento->yInicio = segmento->yFim;
+    }
+}
+
+/**
+ * @brief Corta as trajetórias no frame para onde se recuou.
+ *
+ * Os segmentos que começam depois do frame são descartados e os que o atravessam passam a
+ * terminar nele, com a posição que o barco tem nesse frame.
+ *
+ * @param indice Índice de trajetórias.
+ * @param frame Novo frame atual.
+ */
+void truncarTrajetorias(IndiceTrajetorias *indice, BaseDados *frame) {
+    EntidadesIED *barcos = &frame->barcos;
+    NoVessel *navios = frame->registo->navios;
+    int f = frame->frame_atual_num;
+
+    for (unsigned int id = 0; id < indice->capacidadeIds; id++) {
+        while (indice->ultimo[id] != -1 && indice->segmentos[indice->ultimo[id]].inicio > f) {
+            int s = indice->ultimo[id];
+
+            indice->ultimo[id] = indice->segmentos[s].anterior;
+            indice->segmentos[s].anterior = indice->livre;
+            indice->livre = s;
+        }
+        if (indice->ultimo[id] == -1)
+            indice->primeiro[id] = -1;
+        else if (indice->segmentos[indice->ultimo[id]].fim > f)
+            indice->segmentos[indice->ultimo[id]].fim = f;
+    }
+
+    // Os barcos cujo segmento termina no frame estão nele: a última entidade de cada id dá a posição
+    for (int i = 0; i < barcos->total; i++) {
+        unsigned int id = navios[barcos->navio[i]].id;
+
+        if (id < indice->capacidadeIds && indice->ultimo[id] != -1) {
+            SegmentoTrajetoria *segmento = &indice->segmentos[indice->ultimo[id]];
+
+            if (segmento->fim == f) {
+                segmento->xFim = barcos->posX[i];
+                segmento->yFim = barcos->posY[i];
+            }
+        }
+    }
+
+    indice->ultimoFrame = f;
+}
+
+/**
+ * @brief Obtém o primeiro e o último frame em que um barco esteve no radar, e as posições nesses frames.
+ *
+ * @param indice Índice de trajetórias.
+ * @param id Id do barco.
+ * @param stats Estrutura onde são escritos os frames e as posições (os restantes campos não mudam).
+ * @return 1 se o barco esteve no radar em algum frame, 0 caso contrário.
+ */
+int consultarTrajetoria(const IndiceTrajetorias *indice, unsigned int id, EstatisticasBarco *stats) {
+    const SegmentoTrajetoria *primeiro, *ultimo;
+
+    if (id >= indice->capacidadeIds || indice->ultimo[id] == -1)
+        return 0;
+
+    primeiro = &indice->segmentos[indice->primeiro[id]];
+    ultimo = &indice->segmentos[indice->ultimo[id]];
+    stats->primeiroFrame = primeiro->inicio;
+    stats->posInicialX = primeiro->xInicio;
+    stats->posInicialY = primeiro->yInicio;
+    stats->ultimoFrame = ultimo->fim;
+    stats->posAtualX = ultimo->xFim;
+    stats->posAtualY = ultimo->yFim;
+    return 1;
+}
+
+/**
+ * @brief Substitui o índice por uma cópia de outro (por exemplo, lido de um ficheiro de estado).
+ *
+ * @param indice Índice a substituir (a sua memória é libertada).
+ * @param guardado Índice copiado; os seus arrays não têm de ter sido alocados com malloc.
+ */
+void restaurarTrajetorias(IndiceTrajetorias *indice, const IndiceTrajetorias *guardado) {
+    size_t bytesIds = (size_t) guardado->capacidadeIds * sizeof(int);
+    size_t bytesSegmentos = (size_t) guardado->numSegmentos * sizeof(SegmentoTrajetoria);
+
+    libertarTrajetorias(indice);
+
+    if (guardado->capacidadeIds > 0) {
+        indice->primeiro = malloc(bytesIds);
+        indice->ultimo = malloc(bytesIds);
+        if (!indice->primeiro || !indice->ultimo) {
+            perror("Erro ao alocar trajetorias");
+            exit(1);
+        }
+        memcpy(indice->primeiro, guardado->primeiro, bytesIds);
+        memcpy(indice->ultimo, guardado->ultimo, bytesIds);
+    }
+
+    if (guardado->numSegmentos > 0) {
+        indice->segmentos = malloc(bytesSegmentos);
+        if (!indice->segmentos) {
+            perror("Erro ao alocar trajetorias");
+            exit(1);
+        }
+        memcpy(indice->segmentos, guardado->segmentos, bytesSegmentos);
+    }
+
+    indice->capacidadeIds = guardado->capacidadeIds;
+    indice->numSegmentos = guardado->numSegmentos;
+    indice->capacidadeSegmentos = guardado->numSegmentos;
+    indice->livre = guardado->livre;
+    indice->ultimoFrame = guardado->ultimoFrame;
+    registarMemoria(MEMORIA_TRAJETORIAS, (long long) (2 * bytesIds + bytesSegmentos));
+}
+
+/**
+ * @brief Liberta a memória do índice de trajetórias.
+ *
+ * @param indice Índice de trajetórias.
+ */
+void libertarTrajetorias(IndiceTrajetorias *indice) {
+    registarMemoria(MEMORIA_TRAJETORIAS, -(2 * (long long) indice->capacidadeIds * (long long) sizeof(int) +
+                                           (long long) indice->capacidadeSegmentos *
+                                           (long long) sizeof(SegmentoTrajetoria)));
+    free(indice->segmentos);
+    free(indice->primeiro);
+    free(indice->ultimo);
+    memset(indice, 0, sizeof(IndiceTrajetorias));
+    indice->livre = -1;
+}
@@ -0,0 +1,41 @@
+#ifndef TRAJETORIAS_H
+#define TRAJETORIAS_H
+
+// ================================================ TRAJETORIAS ========================================================
+
+/**
+ * @brief Regista no índice um frame acrescentado ao histórico.
+ */
+void registarFrameTrajetorias(IndiceTrajetorias *indice, BaseDados *frame);
+
+/**
+ * @brief Regista o último frame em que um barco esteve no radar durante um avanço direto.
+ */
+void registarSaidaTrajetoria(IndiceTrajetorias *indice, unsigned int id, int frame, int x, int y);
+
+/**
+ * @brief Atualiza o índice com um barco colocado ou alterado no frame atual.
+ */
+void atualizarTrajetoria(IndiceTrajetorias *indice, BaseDados *frame, int entidade);
+
+/**
+ * @brief Corta as trajetórias no frame para onde se recuou.
+ */
+void truncarTrajetorias(IndiceTrajetorias *indice, BaseDados *frame);
+
+/**
+ * @brief Primeiro e último frame de um barco e as posições nesses frames. Retorna 0 se nunca apareceu.
+ */
+int consultarTrajetoria(const IndiceTrajetorias *indice, unsigned int id, EstatisticasBarco *stats);
+
+/**
+ * @brief Substitui o índice por uma cópia de outro.
+ */
+void restaurarTrajetorias(IndiceTrajetorias *indice, const IndiceTrajetorias *guardado);
+
+/**
+ * @brief Liberta a memória do índice de trajetórias.
+ */
+void libertarTrajetorias(IndiceTrajetorias *indice);
+
+#endif //TRAJETORIAS_H